@@ -0,0 +1,62 @@
+/* Persistent sidecar cache of the HDF5 chunk index used by the fast reader.
+ * Copyright (c) 2025-2026 Alejandro Aguilar Sierra (asierra@unam.mx)
+ * Laboratorio Nacional de Observación de la Tierra, UNAM
+ *
+ * This file is part of HPSATVIEWS.
+ * Licensed under the GNU General Public License v3.0 (see LICENSE file).
+ */
+#ifndef HPSATVIEWS_CHUNK_INDEX_CACHE_H_
+#define HPSATVIEWS_CHUNK_INDEX_CACHE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Everything the chunked reader needs to fetch and decode a variable without
+ * opening it through HDF5: grid and chunk shape, the file offset, compressed
+ * size and filter mask of each chunk (row-major over the chunk grid), and the
+ * fill value for unallocated chunks.
+ */
+typedef struct {
+  size_t nx, ny;         /* grid (x = fastest-varying dimension) */
+  size_t chy, chx;       /* chunk shape */
+  size_t elem_size;      /* bytes per element */
+  size_t nchunks;        /* ceil(ny/chy) * ceil(nx/chx) */
+  uint64_t base_addr;    /* userblock size; chunk addresses are relative to it */
+  uint8_t fillval[8];    /* raw bytes of the fill value (elem_size of them) */
+  uint64_t *rawaddr;     /* file offset of each chunk, relative to base_addr */
+  uint64_t *rawsize;     /* compressed bytes; 0 = unallocated (all-fill) */
+  uint32_t *fmask;       /* HDF5 filter mask (bit set = filter skipped) */
+} ChunkLayout;
+
+/**
+ * True when the cache is enabled, i.e. HPSV_CHUNK_CACHE_DIR names a directory
+ * (created on first store if missing). Off by default.
+ */
+bool chunk_cache_enabled(void);
+
+/**
+ * Looks up the index of `varname` in `filename`. The entry is valid only if the
+ * file still has the same resolved path, inode, size and mtime as when it was
+ * stored. On a hit fills `lay` (arrays heap-allocated; release with
+ * chunk_layout_free) and returns 0; any miss or mismatch returns non-zero.
+ */
+int chunk_cache_load(const char *filename, const char *varname,
+                     ChunkLayout *lay);
+
+/**
+ * Stores the index of `varname` in `filename`. Written to a temporary file and
+ * renamed into place, so concurrent readers never see a partial entry. Failures
+ * are logged at debug level and otherwise ignored: the cache is an optimization.
+ */
+int chunk_cache_store(const char *filename, const char *varname,
+                      const ChunkLayout *lay);
+
+/** Removes the entry for `varname` in `filename`, e.g. after it proved stale. */
+void chunk_cache_invalidate(const char *filename, const char *varname);
+
+/** Frees the arrays of `lay` and zeroes it. */
+void chunk_layout_free(ChunkLayout *lay);
+
+#endif /* HPSATVIEWS_CHUNK_INDEX_CACHE_H_ */
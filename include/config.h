@@ -17,7 +17,7 @@ typedef struct {
     bool is_l2_product;         // true if CMIP L2 product (inferred from filename)
     
     // Operation mode
-    const char *command;        // "rgb", "gray", "pseudocolor"
+    const char *command;        // "rgb", "gray", "pseudocolor", "batch"
     const char *strategy;       // composite recipe: "truecolor", "ash", "ch13", etc.
     
     // Radiometric enhancements
@@ -34,6 +34,7 @@ typedef struct {
     bool invert_values;         // Invert scale (IR channels)
     bool use_cuda;              // --cuda: GPU kernels (requires build with CUDA=1)
     bool build_cog;             // --cog: full Cloud Optimized GeoTIFF (with overviews); default is a fast tiled GeoTIFF without them
+    bool float_output;          // --float (gray): Float32 GeoTIFF of the physical values instead of a rendered image
     
     // Compositing options
     int scale;                  // Integer scale factor (up- or down-sampling)
@@ -70,6 +71,13 @@ typedef struct ArgParser ArgParser;
 // Populates a zeroed ProcessConfig from a parsed ArgParser. Returns false on error.
 bool config_from_argparser(ArgParser *parser, ProcessConfig *cfg);
 
+// Builds one product of `hpsv batch` from the shared options in `base` and an
+// item "mode[@clip][=short[:Long description]]". `spec` is split in place and
+// must outlive `item`; -o is expanded with the item's {PROD}. Free with
+// config_destroy(). Returns false on error.
+bool config_batch_item(ArgParser *parser, const ProcessConfig *base, char *spec,
+                       ProcessConfig *item);
+
 // Validates logical consistency of the configuration. Returns false on error.
 bool config_validate(const ProcessConfig *cfg);
 
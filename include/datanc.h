@@ -27,14 +27,32 @@ typedef enum {
     OP_DIV
 } Operation;
 
+/// Earth-disk row spans of a grid: row j can only hold data in columns
+/// [x[j][0], x[j][1]); every pixel outside is exactly NonData (space, on a full
+/// disk). Lets kernels visit the disk and bulk-fill the rest. They come from the
+/// fixed-grid geometry when a channel or the navigation is read (reader_nc.c),
+/// a few pixels wider than the limb, and follow the grid through the box filter.
+typedef struct {
+  unsigned int height;
+  size_t npix; ///< pixels inside the spans
+  unsigned int x[][2];
+} DiskSpans;
+
 /// A 2D grid structure for floating-point data.
 typedef struct {
   unsigned int width, height;
   size_t size;
   float *data_in;
   float fmin, fmax;
+  DiskSpans *spans; ///< NULL = unknown, visit every pixel. Owned like data_in.
 } DataF;
 
+/// A rectangle of pixels in a native grid (x = column, y = row).
+typedef struct {
+  unsigned int x0, y0;
+  unsigned int width, height;
+} PixelWindow;
+
 /// A 2D grid structure for 8-bit signed integer data.
 typedef struct {
   unsigned int width, height;
@@ -125,10 +143,11 @@ DataF dataf_crop(const DataF *data, unsigned int x_start, unsigned int y_start,
 /// Nearest-neighbor decimation by integer factor.
 DataF downsample_simple(DataF datanc_big, int factor);
 
-/// Box-filter (averaging) downsampling by integer factor.
+/// Box-filter (averaging) downsampling by integer factor. Spans are carried over.
 DataF downsample_boxfilter(DataF datanc_big, int factor);
 
-/// Bilinear interpolation upsampling by integer factor.
+/// Bilinear interpolation upsampling by integer factor. The weighted NonData
+/// neighbours are not exactly NonData, so the result carries no spans.
 DataF upsample_bilinear(DataF datanc_big, int factor);
 
 /// Allocates a 2D byte grid.
@@ -146,6 +165,24 @@ DataF dataf_op_scalar(const DataF* a, float scalar, Operation op, bool scalar_fi
 /// Negates all values in a DataF grid in-place.
 void dataf_invert(DataF* a);
 
+/// Frees the spans of `data`; for kernels that write outside them.
+void dataf_drop_spans(DataF *data);
+
+/// Deep copy of `spans`, or NULL.
+DiskSpans *disk_spans_copy(const DiskSpans *spans);
+
+/// Columns [*x0, *x1) of row y that can hold data; the whole row without spans.
+static inline void dataf_row_span(const DataF *data, unsigned int y,
+                                  unsigned int *x0, unsigned int *x1) {
+  if (data->spans) {
+    *x0 = data->spans->x[y][0];
+    *x1 = data->spans->x[y][1];
+  } else {
+    *x0 = 0;
+    *x1 = data->width;
+  }
+}
+
 /// Frees DataNC resources.
 void datanc_destroy(DataNC *datanc);
 
@@ -13,6 +13,7 @@ static const char *HPSATVIEWS_HELP =
 "  rgb                Multichannel composites (True Color, AirMass, etc.).\n"
 "  pseudocolor        Single channel image with color palette (CPT).\n"
 "  gray               Grayscale image.\n"
+"  batch              Several rgb products of one scene, loaded once.\n"
 "\n"
 "Common Output and Geometry Options:\n"
 "  -o, --out <f>       Output file. Accepts patterns (see below).\n"
@@ -94,6 +95,31 @@ static const char *HPSATVIEWS_HELP_RGB =
 "Ex: \"C13-C14; C13; -1.0*C15 + 300\".\n";
 
 
+/* =========================
+ * Command help: batch
+ * ========================= */
+static const char *HPSATVIEWS_HELP_BATCH =
+"Usage: hpsv batch <anchor> <product> [<product>...] [options]\n"
+"\n"
+"Renders several rgb products of one scene. The channels all of them need are\n"
+"read once and navigated once; every composite is then made and written from\n"
+"them, as separate 'hpsv rgb' runs would.\n"
+"\n"
+"Each <product> is  mode[@clip][=short[:Long description]]\n"
+"  mode    Any rgb mode (daynite, truecolor, airmass, ash, ...).\n"
+"  @clip   Clip for this product only: key name or coordinates.\n"
+"          Without it, -c applies (or none).\n"
+"  =name   Same as --name for this product ({PROD} and 'product').\n"
+"\n"
+"Every rgb option except --mode and --name applies to all products. With more\n"
+"than one product, -o must contain {PROD}; give the same mode twice a\n"
+"different =name. All products share the grid of the coarsest channel loaded\n"
+"(the finest with -f), so truecolor next to IR modes comes out at 2 km.\n"
+"\n"
+"Example:\n"
+"  hpsv batch file.nc daynite airmass@mexico \"ash=ash:Volcanic Ash\" -o \"{PROD}.png\"\n";
+
+
 /* =========================
  * Command help: pseudocolor
  * ========================= */
@@ -116,6 +142,7 @@ static const char *HPSATVIEWS_HELP_GRAY =
 "Generates a grayscale image.\n"
 "\n"
 "Options:\n"
-"  -i, --invert    Invert scale (White <-> Black).\n";
+"  -i, --invert    Invert scale (White <-> Black).\n"
+"  --float         Float32 GeoTIFF of the physical values (no rendering).\n";
 
 #endif /* HPSATVIEWS_HELP_EN_H */
@@ -14,6 +14,7 @@ static const char *HPSATVIEWS_HELP =
 "  rgb                Composiciones multicanal (Color verdadero, AirMass, etc.).\n"
 "  pseudocolor        Imagen con paleta de colores (CPT).\n"
 "  gray               Imagen en escala de grises.\n"
+"  batch              Varios productos rgb de una escena, cargada una vez.\n"
 "\n"
 "Opciones comunes de salida y geometría:\n"
 "  -o, --out <f>       Archivo de salida. Acepta patrones (ver abajo).\n"
@@ -95,6 +96,30 @@ static const char *HPSATVIEWS_HELP_RGB =
 "las opciones --expr y --minmax pero es preciso separarlos con punto y coma (;).\n"
 "Ej: \"C13-C14; C13; -1.0*C15 + 300\".\n";
 
+/* =========================
+ * Help comando: batch
+ * ========================= */
+static const char *HPSATVIEWS_HELP_BATCH =
+"Uso: hpsv batch <ancla> <producto> [<producto>...] [opciones]\n"
+"\n"
+"Genera varios productos rgb de una escena. Los canales que necesitan todos se\n"
+"leen y se navegan una sola vez; con ellos se compone y se escribe cada\n"
+"producto, igual que en corridas separadas de 'hpsv rgb'.\n"
+"\n"
+"Cada <producto> es  modo[@recorte][=corto[:Descripción larga]]\n"
+"  modo      Cualquier modo rgb (daynite, truecolor, airmass, ash, ...).\n"
+"  @recorte  Recorte solo para este producto: clave o coordenadas.\n"
+"            Sin él se usa -c (o ninguno).\n"
+"  =nombre   Igual que --name para este producto ({PROD} y 'product').\n"
+"\n"
+"Todas las opciones de rgb salvo --mode y --name aplican a todos los productos.\n"
+"Con más de un producto, -o debe incluir {PROD}; si un modo se repite, dale a\n"
+"cada uno otro =nombre. Todos comparten la malla del canal más grueso cargado\n"
+"(el más fino con -f): truecolor junto a modos IR sale a 2 km.\n"
+"\n"
+"Ejemplo:\n"
+"  hpsv batch archivo.nc daynite airmass@mexico \"ash=ash:Ceniza volcánica\" -o \"{PROD}.png\"\n";
+
 /* =========================
  * Help comando: pseudocolor / gray
  * ========================= */
@@ -109,6 +134,7 @@ static const char *HPSATVIEWS_HELP_GRAY =
 "Uso: hpsv gray <ancla> [opciones]\n"
 "\n"
 "Opciones:\n"
-"  -i, --invert        Invierte escala (blanco es negro).\n";
+"  -i, --invert        Invierte escala (blanco es negro).\n"
+"  --float             GeoTIFF Float32 con los valores físicos (sin render).\n";
 
 #endif /* HPSATVIEWS_HELP_ES_H */
@@ -79,6 +79,10 @@ ImageData image_upsample_bilinear(const ImageData* src, int factor);
 /// Box-filter (averaging) downsampling by integer factor.
 ImageData image_downsample_boxfilter(const ImageData* src, int factor);
 
+/// Like image_downsample_boxfilter(), but the size rounds up (as GDAL sizes
+/// overviews) and the edge boxes average only the pixels they cover.
+ImageData image_downsample_boxfilter_cover(const ImageData* src, int factor);
+
 /// Generates a single-channel validity mask from a DataF.
 ImageData image_create_alpha_mask_from_dataf(const void* data);
 
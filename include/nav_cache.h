@@ -0,0 +1,44 @@
+/* Persistent, memory-mapped cache of the lat/lon navigation grids.
+ * Copyright (c) 2025-2026 Alejandro Aguilar Sierra (asierra@unam.mx)
+ * Laboratorio Nacional de Observación de la Tierra, UNAM
+ *
+ * This file is part of HPSATVIEWS.
+ * Licensed under the GNU General Public License v3.0 (see LICENSE file).
+ */
+#ifndef HPSATVIEWS_NAV_CACHE_H_
+#define HPSATVIEWS_NAV_CACHE_H_
+
+#include "datanc.h"
+#include "nav_plan.h"
+
+#include <stdbool.h>
+
+/**
+ * True when the cache is enabled, i.e. HPSV_NAV_CACHE_DIR names a directory
+ * (created on first store if missing). Off by default.
+ */
+bool nav_cache_enabled(void);
+
+/**
+ * Looks up the grids for the geometry of `plan`: grid size, projection
+ * parameters from goes_imager_projection and every scan angle x_rad[]/y_rad[]
+ * must match the stored entry exactly. On a hit maps the entry and points
+ * navla/navlo into it (no copy; copy-on-write if someone writes to them) and
+ * returns 0. The grids are released as usual with dataf_destroy().
+ */
+int nav_cache_map(const NavPlan *plan, DataF *navla, DataF *navlo);
+
+/**
+ * Stores the grids computed for `plan`. Written to a temporary file and renamed
+ * into place; failures are logged at debug level and otherwise ignored.
+ */
+int nav_cache_store(const NavPlan *plan, const DataF *navla, const DataF *navlo);
+
+/**
+ * If `data` is a grid handed out by nav_cache_map(), drops it (unmapping the
+ * entry once both grids are gone) and returns true; otherwise returns false and
+ * the caller frees it normally. Called from dataf_destroy().
+ */
+bool nav_cache_release(float *data);
+
+#endif /* HPSATVIEWS_NAV_CACHE_H_ */
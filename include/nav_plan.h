@@ -16,6 +16,7 @@
 #define HPSATVIEWS_NAV_PLAN_H_
 
 #include <stddef.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -39,6 +40,17 @@ int nav_build_plan(const char *filename, NavPlan *plan);
 /* Libera los arreglos del plan y lo deja en cero. Seguro con plan==NULL. */
 void nav_plan_destroy(NavPlan *plan);
 
+/* Plan de la ventana de width x height píxeles en (x0, y0) de la rejilla de
+ * `plan` (la de una lectura por ventana), con su propia copia de x_rad/y_rad.
+ * Devuelve 0 en éxito; -1 si la ventana se sale de la rejilla o no hay memoria,
+ * y entonces deja `out` en cero. */
+int nav_plan_window(const NavPlan *plan, size_t x0, size_t y0, size_t width,
+                    size_t height, NavPlan *out);
+
+/* Hash FNV-1a de toda la geometría del plan (tamaño, proyección, x_rad/y_rad):
+ * la llave del caché de navegación y del de spans del disco. */
+uint64_t nav_plan_hash(const NavPlan *plan);
+
 #ifdef __cplusplus
 }
 #endif
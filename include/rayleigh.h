@@ -10,13 +10,85 @@
 
 #include "datanc.h"
 #include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Coarse viewing geometry (HPSV_COARSE_GEOMETRY=<step>): SZA, VZA and RAA are
+ * solved only every `step` pixels (plus the last row and column) and
+ * bilinearly interpolated by the kernels that read them. Cells across the
+ * limb, or whose corners spread too far apart (near the limb and the subsolar
+ * and sub-satellite points), keep all their pixels exact in a side block.
+ */
+#define RAYLEIGH_CELL_LERP (-1) ///< interpolate between the cell corners
+#define RAYLEIGH_CELL_OFF (-2)  ///< whole cell off the disk: NonData
+
+typedef struct {
+    unsigned int width, height; ///< full-resolution grid it stands for
+    unsigned int step;          ///< lattice pitch in pixels
+    unsigned int lw, lh;        ///< lattice points per row / column (>= 2)
+    float inv_step, inv_last_x, inv_last_y; ///< 1/cell size; the last cell is narrower
+    float *ang;                 ///< lw*lh points, sza/vza/raa interleaved
+    int32_t *cell_block;        ///< (lw-1)*(lh-1) cells: exact block index or RAYLEIGH_CELL_*
+    float *blocks;              ///< (step+1)^2 pixels of sza/vza/raa per exact cell
+} RayleighLattice;
 
 typedef struct {
     DataF sza; ///< Solar Zenith Angle
     DataF vza; ///< View Zenith Angle
     DataF raa; ///< Relative Azimuth Angle
+    RayleighLattice *coarse; ///< non-NULL: no full grids, sample with rayleigh_nav_at()
 } RayleighNav;
 
+/// Width and height of the geometry, full grids or lattice.
+static inline unsigned int rayleigh_nav_width(const RayleighNav *nav) {
+    return nav->coarse ? nav->coarse->width : nav->sza.width;
+}
+static inline unsigned int rayleigh_nav_height(const RayleighNav *nav) {
+    return nav->coarse ? nav->coarse->height : nav->sza.height;
+}
+
+/// SZA, VZA and RAA (degrees) of pixel (x, y) into g[0..2]: read from the full
+/// grids or interpolated from the coarse lattice. NonData off the disk.
+static inline void rayleigh_nav_at(const RayleighNav *nav, unsigned int x, unsigned int y,
+                                   float g[3]) {
+    const RayleighLattice *l = nav->coarse;
+    if (!l) {
+        size_t i = (size_t)y * nav->sza.width + x;
+        g[0] = nav->sza.data_in[i];
+        g[1] = nav->vza.data_in[i];
+        g[2] = nav->raa.data_in[i];
+        return;
+    }
+    // x + 0.5 keeps the product clear of integers: exact cell without a division.
+    unsigned int cx = (unsigned int)(((float)x + 0.5f) * l->inv_step);
+    unsigned int cy = (unsigned int)(((float)y + 0.5f) * l->inv_step);
+    if (cx > l->lw - 2) cx = l->lw - 2;
+    if (cy > l->lh - 2) cy = l->lh - 2;
+    unsigned int dx = x - cx * l->step, dy = y - cy * l->step;
+    int32_t b = l->cell_block[(size_t)cy * (l->lw - 1) + cx];
+    if (b == RAYLEIGH_CELL_OFF) {
+        g[0] = g[1] = g[2] = NonData;
+        return;
+    }
+    if (b >= 0) {
+        const size_t side = l->step + 1;
+        const float *p = l->blocks + (((size_t)b * side + dy) * side + dx) * 3;
+        g[0] = p[0];
+        g[1] = p[1];
+        g[2] = p[2];
+        return;
+    }
+    float u = (float)dx * (cx == l->lw - 2 ? l->inv_last_x : l->inv_step);
+    float v = (float)dy * (cy == l->lh - 2 ? l->inv_last_y : l->inv_step);
+    const float *a00 = l->ang + ((size_t)cy * l->lw + cx) * 3;
+    const float *a01 = a00 + (size_t)l->lw * 3;
+    for (int k = 0; k < 3; k++) {
+        float top = a00[k] + u * (a00[k + 3] - a00[k]);
+        float bot = a01[k] + u * (a01[k + 3] - a01[k]);
+        g[k] = top + v * (bot - top);
+    }
+}
+
 
 /// Analytic Rayleigh correction using physical scattering formula.
 void analytic_rayleigh_correction(DataF *band, const RayleighNav *nav, float lambda_um);
@@ -25,7 +97,10 @@ void analytic_rayleigh_correction(DataF *band, const RayleighNav *nav, float lam
 bool rayleigh_load_navigation(const char *filename, RayleighNav *nav, 
 				unsigned int target_width, unsigned int target_height);
 
-/// Loads viewing geometry reusing pre-computed lat/lon grids.
+/// Loads viewing geometry reusing pre-computed lat/lon grids. With
+/// HPSV_COARSE_GEOMETRY=<step> (and lat/lon already at the target size) it
+/// builds a RayleighLattice instead of the full grids and logs its largest
+/// angular error against the exact geometry, checked at every cell centre.
 bool rayleigh_load_navigation_from_latlon(const char *filename,
                                           const DataF *navla, const DataF *navlo,
                                           RayleighNav *nav,
@@ -42,12 +117,25 @@ typedef struct {
     float az_min, az_max, az_step; ///< Relative Azimuth range
 } RayleighLUT;
 
-/// Frees geometry grids inside a RayleighNav.
+/// Frees geometry grids (or the coarse lattice) inside a RayleighNav.
 void rayleigh_free_navigation(RayleighNav *nav);
 
 /// LUT-based Rayleigh correction.
 void luts_rayleigh_correction(DataF *img, const RayleighNav *nav, const uint8_t channel, const DataF *redband);
 
+/// Most bands luts_rayleigh_correction_bands() corrects in one pass (C01-C03).
+#define RAYLEIGH_MAX_BANDS 3
+
+/**
+ * LUT-based Rayleigh correction of n bands in one pass: the secants, the
+ * azimuth fold and the LUT cell of each pixel are solved once and interpolated
+ * in every band's table. Same result as luts_rayleigh_correction() band by band,
+ * in order; redbands[b] (or NULL) is read before any band of the pixel is
+ * corrected. HPSV_NO_SHARED_RAYLEIGH=1 corrects the bands one at a time.
+ */
+void luts_rayleigh_correction_bands(DataF *const *imgs, const uint8_t *channels,
+                                    const DataF *const *redbands, int n, const RayleighNav *nav);
+
 /// Loads the embedded Rayleigh LUT for an ABI channel (table is NULL on failure).
 /// Exposed so the CUDA path can reuse the exact same LUT parsing.
 RayleighLUT rayleigh_lut_load_from_memory(const uint8_t channel);
@@ -9,10 +9,44 @@
 #define HPSATVIEWS_READER_NC_H_
 
 #include "datanc.h"
+#include "nav_plan.h"
 
 /// Loads GOES ABI L1b or L2 data and metadata from a NetCDF file.
 int load_nc_sf(const char *filename, DataNC *datanc);
 
+/// Like load_nc_sf() but reads only the pixels of `win` (clamped to the grid):
+/// fdata is win->width x win->height and the geotransform origin is moved to the
+/// window's corner. Only the chunks that intersect the window are decompressed.
+/// A NULL window reads the whole grid.
+int load_nc_sf_window(const char *filename, const PixelWindow *win, DataNC *datanc);
+
+/// Like load_nc_sf_window() but float data is averaged over factor x factor
+/// blocks while it is decoded, as downsample_boxfilter() would do afterwards:
+/// fdata is (width/factor) x (height/factor) and the geotransform and
+/// native_resolution_km are scaled by factor. The full-resolution grid is never
+/// held (except on the nc_get_vara fallback). Byte data is read unreduced, with
+/// the resolution left as is.
+int load_nc_sf_reduced(const char *filename, const PixelWindow *win, int factor, DataNC *datanc);
+
+/// One file to load with load_nc_sf_batch().
+typedef struct {
+    const char *filename;
+    const PixelWindow *window;  ///< NULL = whole grid
+    int factor;                 ///< box filter while decoding (load_nc_sf_reduced); 1 = none
+    DataNC *out;
+    int status;                 ///< set by the batch: 0 = loaded
+    double seconds;             ///< set by the batch: wall time of this load
+} NCLoadJob;
+
+/// Loads several files with load_nc_sf_reduced(), overlapping the serial
+/// netCDF/HDF5 phase of one with the parallel decode of another.
+/// HPSV_SERIAL_LOAD=1 loads them one at a time. Returns the number of failed jobs.
+int load_nc_sf_batch(NCLoadJob *jobs, int n);
+
+/// Reads only the metadata of a file (identification, grid size, resolution,
+/// projection and geotransform); fdata/bdata are left without pixels.
+int load_nc_header(const char *filename, DataNC *datanc);
+
 /// Loads a single float variable from a NetCDF file.
 int load_nc_float(const char *filename, DataF *datanc, const char *variable);
 
@@ -21,6 +55,12 @@ int load_nc_float(const char *filename, DataF *datanc, const char *variable);
 /// shared with the CUDA path via nav_build_plan() (include/nav_plan.h).
 int compute_navigation_nc(const char *GOES_L1b_filename, DataF *navla, DataF *navlo);
 
+/// Lat/lon grids for the pixel window `win` of the plan's grid only; equal to
+/// cropping the full grids of compute_navigation_nc() (fmin/fmax included) at a
+/// fraction of the cost. Returns -1 if the window falls outside the grid.
+int compute_navigation_window(const NavPlan *plan, const PixelWindow *win,
+                              DataF *navla, DataF *navlo);
+
 /// Builds navigation grids for an already-reprojected geographic (equirectangular) grid.
 int create_navigation_from_reprojected_bounds(DataF *navla, DataF *navlo, size_t width, size_t height, float lon_min, float lon_max, float lat_min, float lat_max);
 
@@ -54,4 +94,30 @@ int reader_solar_ephemeris_from_file(const char *filename, SolarEphemeris *out);
 /// goes_imager_projection variable. Returns 0 on success.
 int reader_read_satellite_params(const char *filename, float *sat_lon, float *sat_height_m);
 
+/// Pixel-independent part of the viewing geometry: solar ephemeris and
+/// geostationary satellite position.
+typedef struct {
+    SolarEphemeris sun;
+    float sat_lon, sat_height_m; ///< as read from goes_imager_projection
+    double x_sat, y_sat;         ///< geocentric satellite position (m), z = 0
+} ViewEphemeris;
+
+/// Reads the scan time and satellite parameters of a GOES file into a
+/// ViewEphemeris. Returns 0 on success.
+int reader_view_ephemeris_from_file(const char *filename, ViewEphemeris *out);
+
+/// SZA, VZA and RAA (degrees) of one pixel, bit-identical to the grids of
+/// compute_solar_angles_nc(), compute_satellite_angles_nc() and
+/// compute_relative_azimuth(); NonData when la/lo are. sin/cos of the pixel's
+/// latitude and longitude are solved once for both the sun and the satellite.
+void compute_view_geometry_at(float la, float lo, const ViewEphemeris *v, float *sza, float *vza,
+                              float *raa);
+
+/// SZA, VZA and RAA grids in one pass over the disk, from the hoisted solar
+/// ephemeris: the same values as compute_solar_angles_nc(),
+/// compute_satellite_angles_nc() and compute_relative_azimuth(), without their
+/// SAA/VAA grids and extra passes. Returns 0 on success.
+int compute_view_geometry_nc(const char *filename, const DataF *navla, const DataF *navlo,
+                             DataF *sza, DataF *vza, DataF *raa);
+
 #endif /* HPSATVIEWS_READER_NC_H_ */
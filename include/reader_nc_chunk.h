@@ -19,16 +19,72 @@
  * of HDF5's single-threaded filter pipeline.
  *
  * Only handles the common GOES layout: a 2-D chunked dataset filtered with
- * shuffle + deflate (gzip), little-endian, element size == elem_size. Anything
- * else (other filters, byte order, rank) returns non-zero so the caller can
- * fall back to nc_get_var().
+ * shuffle + deflate (gzip), little-endian, element size == elem_size (1, 2, 4
+ * or 8 bytes). Anything else (other filters, byte order, rank) returns non-zero
+ * so the caller can fall back to nc_get_var().
  *
  * @param out       Destination buffer of nx*ny elements of elem_size bytes (row-major).
  * @param nx, ny    Grid width/height (x = fastest-varying dimension).
- * @param elem_size Bytes per element (2 for int16/uint16).
+ * @param elem_size Bytes per element: 1 (int8/uint8), 2 (int16/uint16), 4 (float32) or 8 (float64).
  * @return 0 on success; non-zero if unsupported (caller must fall back).
  */
 int read_var_chunked_deflate(const char *filename, const char *varname,
                              void *out, size_t nx, size_t ny, size_t elem_size);
 
+/**
+ * Same as read_var_chunked_deflate() but only for the pixel window
+ * [x0, x0+w) x [y0, y0+h) of the nx*ny grid: only the chunks that intersect it
+ * are fetched and decompressed, and `out` holds w*h elements (row-major).
+ * A window that does not fit in the grid returns non-zero.
+ */
+int read_var_chunked_deflate_window(const char *filename, const char *varname,
+                                    void *out, size_t nx, size_t ny,
+                                    size_t elem_size, size_t x0, size_t y0,
+                                    size_t w, size_t h);
+
+/**
+ * Per-element conversion applied while each decoded chunk is scattered into the
+ * destination, e.g. raw counts to calibrated floats. `convert` receives `n`
+ * contiguous raw elements (elem_size bytes each, native order) and writes `n`
+ * elements of out_elem_size bytes to `dst`, lowering *vmin / raising *vmax with
+ * the values it produces. It runs concurrently on many chunks: `arg` must be
+ * read-only and vmin/vmax are per-thread.
+ */
+typedef struct {
+  size_t out_elem_size;
+  void (*convert)(const void *src, void *dst, size_t n, const void *arg,
+                  float *vmin, float *vmax);
+  const void *arg;
+} ChunkConverter;
+
+/**
+ * read_var_chunked_deflate_window() with conversion fused into the decode: `out`
+ * holds w*h converted elements, and on success *vmin / *vmax (if not NULL) the
+ * range reported by the converter (1e30 / -1e30 if it reported none). With a
+ * NULL `conv` the raw elements are copied, as in the other entry points.
+ */
+int read_var_chunked_deflate_convert(const char *filename, const char *varname,
+                                     void *out, size_t nx, size_t ny,
+                                     size_t elem_size, size_t x0, size_t y0,
+                                     size_t w, size_t h,
+                                     const ChunkConverter *conv, float *vmin,
+                                     float *vmax);
+
+/**
+ * read_var_chunked_deflate_convert() followed by a factor x factor box filter,
+ * fused into the decode: `out` holds (w/factor) x (h/factor) floats, each the
+ * mean of one block of converted values, exactly as downsample_boxfilter()
+ * would compute them from the full window (trailing rows/columns that do not
+ * fill a block are dropped). *vmin / *vmax are the range of the full-resolution
+ * values. Needs a converter to float; the full-resolution window is never held,
+ * only a band of a few chunk rows. factor 1 is the plain converted read.
+ */
+int read_var_chunked_deflate_boxfilter(const char *filename,
+                                       const char *varname, float *out,
+                                       size_t nx, size_t ny, size_t elem_size,
+                                       size_t x0, size_t y0, size_t w, size_t h,
+                                       size_t factor,
+                                       const ChunkConverter *conv, float *vmin,
+                                       float *vmax);
+
 #endif /* HPSATVIEWS_READER_NC_CHUNK_H_ */
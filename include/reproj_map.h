@@ -0,0 +1,91 @@
+/* Precomputed fixed-grid -> geographic reprojection maps, reusable on disk.
+ * Copyright (c) 2025-2026 Alejandro Aguilar Sierra (asierra@unam.mx)
+ * Laboratorio Nacional de Observación de la Tierra, UNAM
+ *
+ * This file is part of HPSATVIEWS.
+ * Licensed under the GNU General Public License v3.0 (see LICENSE file).
+ */
+#ifndef HPSATVIEWS_REPROJ_MAP_H_
+#define HPSATVIEWS_REPROJ_MAP_H_
+
+#include "image.h"
+#include "reprojection.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/// Output pixel with no source pixel (beyond the horizon or off the sector).
+#define REPROJ_MAP_NONE UINT32_MAX
+
+/**
+ * Where every output pixel of a ReprojPlan reads from. Nearest-neighbour maps
+ * (bpp 1) hold the source pixel index; bilinear maps hold the source column and
+ * row in double, exactly as the analytic loop computes them, so applying a map
+ * gives the same bytes as reproject_image_analytical().
+ */
+typedef struct {
+  unsigned int width, height; ///< output grid
+  unsigned int src_w, src_h;  ///< source (fixed-grid) dims
+  bool bilinear;
+  uint32_t *index; ///< nearest: width*height source indices, REPROJ_MAP_NONE off source
+  double *coord;   ///< bilinear: col,row per output pixel, col < 0 off source
+} ReprojMap;
+
+/**
+ * True when HPSV_REPROJ_MAP_DIR names a directory (created on first store if
+ * missing). Off by default.
+ */
+bool reproj_map_enabled(void);
+
+/**
+ * Map for `plan` (bilinear or nearest): the one already in use by this process
+ * if the plan matches, else the stored entry mapped from HPSV_REPROJ_MAP_DIR,
+ * else computed with reproject_fill_map() and stored there. The map stays
+ * owned by the module until the next call with another plan; NULL on failure.
+ */
+const ReprojMap *reproj_map_get(const ReprojPlan *plan, bool bilinear);
+
+/**
+ * Fills map->index or map->coord (already sized for the plan) with the inverse
+ * scan-angle solution of every output pixel. Lives in reprojection.c next to
+ * the analytic loop it shares the per-pixel math with. Returns 0 if any output
+ * pixel lands on the source.
+ */
+int reproject_fill_map(const ReprojPlan *plan, ReprojMap *map);
+
+/**
+ * Gathers src_image through `map`. nodata_pixel (src_image->bpp bytes, or NULL
+ * for zeros) fills the pixels without source, as in reproject_image_analytical().
+ */
+ImageData reproj_map_apply(const ReprojMap *map, const ImageData *src_image,
+                           const unsigned char *nodata_pixel);
+
+/// Bilinear sample of an interleaved uint8 image at (col, row), rounded.
+static inline void reproj_bilinear(const uint8_t *src, unsigned int src_w, unsigned int bpp,
+                                   double col, double row, uint8_t *out) {
+  int c0 = (int)col;
+  int r0 = (int)row;
+  double dc = col - c0;
+  double dr = row - r0;
+  int c1 = c0 + 1;
+  int r1 = r0 + 1;
+
+  double w00 = (1.0 - dc) * (1.0 - dr);
+  double w10 = dc * (1.0 - dr);
+  double w01 = (1.0 - dc) * dr;
+  double w11 = dc * dr;
+
+  size_t i00 = ((size_t)r0 * src_w + (size_t)c0) * bpp;
+  size_t i10 = ((size_t)r0 * src_w + (size_t)c1) * bpp;
+  size_t i01 = ((size_t)r1 * src_w + (size_t)c0) * bpp;
+  size_t i11 = ((size_t)r1 * src_w + (size_t)c1) * bpp;
+
+  for (unsigned int ch = 0; ch < bpp; ch++) {
+    double val = w00 * src[i00 + ch] + w10 * src[i10 + ch] + w01 * src[i01 + ch] +
+                 w11 * src[i11 + ch];
+    int ival = (int)(val + 0.5);
+    out[ch] = (uint8_t)(ival < 0 ? 0 : (ival > 255 ? 255 : ival));
+  }
+}
+
+#endif /* HPSATVIEWS_REPROJ_MAP_H_ */
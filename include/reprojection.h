@@ -10,19 +10,64 @@
 
 #include "datanc.h"
 #include "image.h"
+#include "nav_plan.h"
 
 /// Finds the nearest-neighbor pixel for a geographic coordinate in a navigation grid.
 void reprojection_find_pixel_for_coord(const DataF* navla, const DataF* navlo,
                                        float target_lat, float target_lon,
                                        int* out_ix, int* out_iy);
 
-/// Computes the pixel bounding box covering a geographic domain by dense edge sampling.
-int reprojection_find_bounding_box(const DataF* navla, const DataF* navlo,
+/**
+ * Pixel bounding box of a geographic domain, from dense samples of its edges.
+ * With a plan (the geometry of the navla/navlo grid, or of the grid to crop
+ * when there are no grids) the samples are projected to scan angles and found
+ * in plan->x_rad/y_rad by bisection, then snapped to the pixel the grid search
+ * would pick. Without one, or when the domain crosses the limb or the border
+ * of the sector, or with HPSV_NO_ANALYTIC_CLIP=1, each sample is searched for
+ * in the navigation grids (reprojection_find_pixel_for_coord, O(N)).
+ *
+ * @param plan May be NULL; navla/navlo may be empty if the plan decides.
+ * @return Samples located; 0 (and an empty box) if the domain was not found.
+ */
+int reprojection_find_bounding_box(const NavPlan* plan, const DataF* navla, const DataF* navlo,
                                    float clip_lon_min, float clip_lat_max,
                                    float clip_lon_max, float clip_lat_min,
                                    int* out_x_start, int* out_y_start,
                                    int* out_width, int* out_height);
 
+/**
+ * Pixel window to read for a fixed-grid clip: the bounding box of the clip
+ * domain (reprojection_find_bounding_box) grown by `margin` pixels per side,
+ * with its corners snapped outwards to multiples of `align`, and clamped to the
+ * grid of navla/navlo.
+ *
+ * @param clip_coords [lon_min, lat_max, lon_max, lat_min].
+ * @return true if the domain hits the grid; false leaves `win` untouched.
+ */
+bool reprojection_clip_window(const DataF* navla, const DataF* navlo,
+                              const float clip_coords[4], int margin, int align,
+                              PixelWindow* win);
+
+/**
+ * Same window as reprojection_clip_window() but without navigation grids: the
+ * box comes from the plan (see reprojection_find_bounding_box).
+ *
+ * @return false, leaving `win` untouched, if the domain crosses the limb or
+ *         the border of the sector (the grid search decides those).
+ */
+bool reprojection_clip_window_plan(const NavPlan* plan, const float clip_coords[4],
+                                   int margin, int align, PixelWindow* win);
+
+/**
+ * Pixel window of a clip in `filename` plus the navigation of that window only
+ * (reprojection_clip_window_plan + compute_navigation_window). Falls back to the
+ * full navigation and reprojection_clip_window() when the analytic window does
+ * not apply, or always with HPSV_NO_ANALYTIC_CLIP=1.
+ */
+bool reprojection_clip_navigation(const char* filename, const float clip_coords[4],
+                                  int margin, int align, PixelWindow* win,
+                                  DataF* navla, DataF* navlo);
+
 /**
  * Reprojects an image from GOES-R fixed-grid to geographic (lat/lon) projection
  * using the analytical inverse scan-angle equations from GOES-R PUG Vol. 4.
@@ -37,6 +82,19 @@ ImageData reproject_image_analytical(const ImageData* src_image, const DataNC* d
                                      const float* clip_coords,
                                      const unsigned char* nodata_pixel);
 
+/**
+ * Float counterpart of reproject_image_analytical(): reprojects physical values
+ * (reflectance, brightness temperature) instead of the rendered bytes, on the
+ * same ReprojPlan. Bilinear, falling back to the nearest pixel next to NonData;
+ * pixels without source are NonData. fmin/fmax cover the valid output.
+ *
+ * @param src The float grid of data_nc (its dims must match the plan's source).
+ * @return width == 0 on failure.
+ */
+DataF reproject_dataf(const DataF* src, const DataNC* data_nc,
+                      float lat_min, float lat_max, float lon_min, float lon_max,
+                      float native_resolution_km, const float* clip_coords);
+
 /* Precomputed reprojection geometry: everything the per-output-pixel inverse
  * scan-angle math needs, computed once. Shared by the CPU loop and the CUDA
  * gather kernel so both use the exact same projection setup. */
@@ -49,10 +107,67 @@ typedef struct {
     double safe_gt[6];
 } ReprojPlan;
 
-/// Builds the reprojection plan (output size, target extent, projection params).
-/// Returns a plan with width==0 if the inputs are invalid.
+/// An output tile, pixels [x0..x1] x [y0..y1] inclusive.
+typedef struct {
+    unsigned int x0, y0, x1, y1;
+} ReprojTile;
+
+/// Side of the square output tiles walked by the reprojection gathers.
+#define REPROJ_TILE 64
+
+/**
+ * Output tiles of a width x height grid in Morton (Z) order, so that tiles
+ * handed out one after another by a dynamic schedule stay close in the source
+ * image too. HPSV_NO_TILED_REPROJ=1 returns one tile per output row instead,
+ * the old row-major walk. The caller frees *tiles; returns the count, 0 on
+ * allocation failure.
+ */
+size_t reproject_tiles(unsigned int width, unsigned int height, ReprojTile** tiles);
+
+/// Source MB read by a gather of `valid` output pixels (1 px nearest, 2x2 bilinear).
+double reproj_gathered_mb(long valid, unsigned int bpp);
+
+/// Largest output side of the in-memory reprojection; bigger grids are downscaled.
+#define REPROJ_MAX_DIM 10000
+/// Largest output side of the streamed reprojection (a sanity bound only).
+#define REPROJ_STREAM_MAX_DIM 131072
+/// Output rows per strip of reproject_image_strips(): a multiple of REPROJ_TILE
+/// and of the 512-row blocks of the streamed GeoTIFF.
+#define REPROJ_STRIP_ROWS 512
+
+/// Builds the reprojection plan (output size, target extent, projection params),
+/// clamped to REPROJ_MAX_DIM per side. Returns a plan with width==0 if the inputs
+/// are invalid.
 ReprojPlan reproject_build_plan(const ImageData* src_image, const DataNC* data_nc,
                                 float lat_min, float lat_max, float lon_min, float lon_max,
                                 float native_resolution_km, const float* clip_coords);
 
+/// Same plan at the native resolution: clamped only to REPROJ_STREAM_MAX_DIM.
+ReprojPlan reproject_build_plan_full(const ImageData* src_image, const DataNC* data_nc,
+                                     float lat_min, float lat_max, float lon_min, float lon_max,
+                                     float native_resolution_km, const float* clip_coords);
+
+/**
+ * True when the output of `full` (from reproject_build_plan_full) should be
+ * streamed: it does not fit in REPROJ_MAX_DIM, or HPSV_STREAM_REPROJ=1 asks for
+ * streaming regardless of size.
+ */
+bool reproject_stream_wanted(const ReprojPlan* full);
+
+/// Consumer of one strip: output rows y0 .. y0 + strip->height - 1. Nonzero aborts.
+typedef int (*ReprojStripFn)(void* ctx, const ImageData* strip, unsigned int y0);
+
+/**
+ * Reprojects src_image over `plan` in horizontal strips of REPROJ_STRIP_ROWS
+ * rows, top to bottom, handing each one to `emit` as soon as it is done. Only
+ * one strip is ever allocated, so memory is bounded by width * strip rows and
+ * not by the output size. Same pixels as reproject_image_analytical() on the
+ * same plan (HPSV_REPROJ_APPROX applies too; stored maps do not).
+ *
+ * @return 0, or -1 on failure / the first nonzero value returned by `emit`.
+ */
+int reproject_image_strips(const ImageData* src_image, const ReprojPlan* plan,
+                           const unsigned char* nodata_pixel,
+                           ReprojStripFn emit, void* ctx);
+
 #endif /* HPSATVIEWS_REPROJECTION_H_ */
\ No newline at end of file
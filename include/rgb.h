@@ -14,6 +14,7 @@
 #include "image.h"
 #include "config.h"
 #include "metadata.h"
+#include "rgb_recipe.h"
 
 /// Forward declarations
 typedef struct ArgParser ArgParser;
@@ -70,6 +71,7 @@ typedef struct {
     DataF nav_lat;
     DataF nav_lon;
     bool has_navigation;
+    PixelWindow load_window;       ///< Window of the reference grid read for a clip (width 0 = whole grid)
 
     float final_lon_min, final_lon_max;
     float final_lat_min, final_lat_max;
@@ -108,6 +110,11 @@ typedef struct {
     /// por eso tests/test_cuda.sh compara ambos caminos píxel a píxel.
     bool final_image_touched;
 
+    /// true en los productos de un batch (run_rgb_batch): channel_set, channels
+    /// y nav_lat/nav_lon son de la escena compartida. Los composers no deben
+    /// modificarlos y rgb_context_destroy() no los libera.
+    bool shared_scene;
+
     bool error_occurred;
     char error_msg[512];
 } RgbContext;
@@ -122,6 +129,7 @@ typedef struct {
     RgbComposer composer_func;
     const char *description;
     bool needs_navigation;
+    const RgbRecipe *recipe;         ///< Band-algebra recipe; composer_func is NULL then
 } RgbStrategy;
 
 /// Initializes an RgbContext to default values.
@@ -141,6 +149,19 @@ bool rgb_parse_options(ArgParser *parser, RgbContext *ctx);
  */
 int run_rgb(const ProcessConfig *cfg, MetadataContext *meta);
 
+/**
+ * Runs several RGB products of one scene: the union of their channels is
+ * loaded and navigated once, then each item is composed and written as
+ * run_rgb() would, on the grid of the coarsest channel loaded.
+ *
+ * @param items  One configuration per product (same input_file and --full-res).
+ * @param count  Number of items.
+ * @param metas  One metadata accumulator per item.
+ * @param status Filled with 0 for each product written, nonzero otherwise.
+ * @return Number of products that failed.
+ */
+int run_rgb_batch(const ProcessConfig *items, int count, MetadataContext **metas, int *status);
+
 /// Combines three float grids into an 8-bit RGB image with per-channel linear stretch.
 ImageData create_multiband_rgb(const DataF* r_ch, const DataF* g_ch, const DataF* b_ch,
                                float r_min, float r_max, float g_min, float g_max,
@@ -0,0 +1,42 @@
+/* Band-algebra RGB recipes rendered straight to 8-bit in one fused pass.
+ * Copyright (c) 2025-2026 Alejandro Aguilar Sierra (asierra@unam.mx)
+ * Laboratorio Nacional de Observación de la Tierra, UNAM
+ *
+ * This file is part of HPSATVIEWS.
+ * Licensed under the GNU General Public License v3.0 (see LICENSE file).
+ */
+#ifndef HPSATVIEWS_RGB_RECIPE_H_
+#define HPSATVIEWS_RGB_RECIPE_H_
+
+#include "datanc.h"
+#include "image.h"
+#include "parse_expr.h"
+
+/// One output channel: a band expression in the --expr syntax ("C15-C13",
+/// "273.15-C08"), the range stretched to 0..255 and a gamma.
+typedef struct {
+    const char *expr;
+    float min, max;
+    float gamma;     ///< EUMETSAT/CIRA convention: out = norm^(1/gamma); 1 = linear
+} RgbRecipeChannel;
+
+/// An RGB composite described as data (R, G, B), e.g. the EUMETSAT ash or
+/// airmass recipes. New ones only need a table entry (see STRATEGIES in rgb.c).
+typedef struct {
+    RgbRecipeChannel ch[3];
+} RgbRecipe;
+
+/// Parses the three expressions of a recipe. Returns 0 on success.
+int rgb_recipe_compile(const RgbRecipe *recipe, LinearCombo combo[3]);
+
+/**
+ * Evaluates combo[c] at every pixel of `channels` (indices 1-16) and stretches
+ * it over range[c] with gamma[c] into an 8-bit RGB image, without the float
+ * grid per channel that evaluate_linear_combo() + create_multiband_rgb() go
+ * through. Gives the same bytes as that path, gamma included: a term that is
+ * NonData makes its channel 0. Returns an empty image on error.
+ */
+ImageData rgb_recipe_render(const LinearCombo combo[3], const float range[3][2],
+                            const float gamma[3], const DataNC *channels);
+
+#endif /* HPSATVIEWS_RGB_RECIPE_H_ */
@@ -10,6 +10,7 @@
 
 #include "datanc.h"
 #include "image.h"
+#include "rayleigh.h"
 #include <stdbool.h>
 
 /// Computes the synthetic green channel using the CIMSS formula.
@@ -20,8 +21,9 @@ ImageData create_multiband_rgb(const DataF* r_ch, const DataF* g_ch, const DataF
                                float r_min, float r_max, float g_min, float g_max,
                                float b_min, float b_max);
 
-/// Applies solar zenith angle correction in-place.
-void apply_solar_zenith_correction(DataF *data, const DataF *sza);
+/// Applies solar zenith angle correction in-place, with the SZA of the
+/// Rayleigh geometry (full grid or coarse lattice).
+void apply_solar_zenith_correction(DataF *data, const RayleighNav *nav);
 
 /// Applies a piecewise linear contrast stretch in-place to match Geo2grid/Satpy output.
 void apply_piecewise_stretch(DataF *band);
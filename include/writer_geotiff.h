@@ -26,7 +26,9 @@ typedef struct {
 /* `cog` selects the output flavour: false = fast tiled GeoTIFF without overviews
  * (default; ideal for an intermediate that gets cropped downstream); true = full
  * Cloud Optimized GeoTIFF with the overview pyramid (the GeoTIFF is the final
- * product). Both are ZSTD-compressed and written multi-threaded. */
+ * product). Both are written multi-threaded: the default one by the native
+ * tiled writer (DEFLATE tiles, GDAL only for the tags; HPSV_NO_NATIVE_TIFF=1
+ * goes through GDAL), the COG through GDAL's COG driver (ZSTD). */
 
 /// Writes a 3-band RGB image to GeoTIFF.
 int write_geotiff_rgb(const char* filename,
@@ -57,4 +59,47 @@ int write_geotiff_indexed(const char* filename,
                           const char* product,
                           bool cog);
 
+/**
+ * Writes a float grid as a single-band Float32 GeoTIFF of physical values
+ * (tiled, ZSTD with the floating-point predictor). NonData pixels keep their
+ * value, declared as the band's nodata.
+ */
+int write_geotiff_float(const char* filename,
+                        const DataF* data,
+                        const DataNC* meta,
+                        int offset_x,
+                        int offset_y,
+                        const char* product,
+                        bool cog);
+
+/**
+ * GeoTIFF written strip by strip, for outputs too large to hold in memory
+ * (the streamed reprojection). Tiled 512x512 and ZSTD-compressed like the COG
+ * writer; `cog` copies it to a full COG with overviews on close.
+ */
+typedef struct GeoTiffStream GeoTiffStream;
+
+/// Creates the file for a width x height image of `bands` bytes per pixel
+/// (2 and 4 carry alpha). With one band, palette/cm tag it as indexed; with 3
+/// or 4, a palette means the strips come indexed (bpp 1 or 2) and are expanded
+/// through it, as image_expand_palette() does.
+GeoTiffStream* geotiff_stream_open(const char* filename,
+                                   int width,
+                                   int height,
+                                   int bands,
+                                   const DataNC* meta,
+                                   const ColorArray* palette,
+                                   const ColormapMeta* cm,
+                                   const char* product,
+                                   bool cog);
+
+/// Writes rows y0 .. y0 + strip->height - 1 (interleaved, strip->bpp == bands).
+int geotiff_stream_write(GeoTiffStream* stream, const ImageData* strip, int y0);
+
+/// Same as geotiff_stream_write(), shaped as a ReprojStripFn (ctx = the stream).
+int geotiff_stream_strip(void* stream, const ImageData* strip, unsigned int y0);
+
+/// Finishes the file and frees the stream. Returns 0 on success.
+int geotiff_stream_close(GeoTiffStream* stream);
+
 #endif /* HPSATVIEWS_WRITER_GEOTIFF_H_ */
@@ -0,0 +1,50 @@
+#!/bin/bash
+# GeoTIFF writer benchmark: the native tiled writer (default) against the GDAL
+# path it replaces (HPSV_NO_NATIVE_TIFF=1: MEM dataset + GDALCreateCopy through
+# the COG driver).
+#
+# The native writer lets GDAL write only the header and tags, then builds the
+# 512x512 tiles straight from the interleaved image, applies predictor 2 and
+# deflates them with libdeflate on all cores. Each -v run reports the writer's
+# [PERF] lines; the file sizes are printed after each pair of runs (ZSTD for the
+# GDAL path, deflate for the native one).
+#
+# Usage:
+#   reproduction/bench_geotiff.sh <full_disk_C13.nc> [<full_disk_C01.nc>]
+#
+# The C13 file drives a gray product (1 band) on its native grid; the optional
+# C01 file a true color composite (3 bands; C02 and C03 are looked up next to
+# it, as usual). Both are written without -G so that the writer sees the full
+# fixed grid.
+#
+# Run from the repo root after `make`. OMP_NUM_THREADS caps the threads.
+set -e
+C13="${1:?Usage: $0 <full_disk_C13.nc> [<full_disk_C01.nc>]}"
+C01="$2"
+OUT_DIR="$(mktemp -d)"
+trap 'rm -rf "$OUT_DIR"' EXIT
+
+echo "== CPU threads: $(nproc) (OMP_NUM_THREADS=${OMP_NUM_THREADS:-all}) =="
+
+# bench <label> <hpsv args...>: two runs per writer, then the output sizes.
+bench() {
+    local label="$1"; shift
+    echo ""
+    echo "### $label ###"
+    for writer in native gdal; do
+        local env=""
+        [ "$writer" = gdal ] && env="HPSV_NO_NATIVE_TIFF=1"
+        echo "-- $writer --"
+        for i in 1 2; do
+            env $env ./bin/hpsv "$@" -o "$OUT_DIR/$writer.tif" -v 2>&1 \
+              | grep -E "GeoTIFF (MEM dataset|written)" || true
+        done
+    done
+    ls -l "$OUT_DIR"/native.tif "$OUT_DIR"/gdal.tif | awk '{print $5, $NF}'
+}
+
+bench "gray C13 (1 band)" gray "$C13" -i
+[ -n "$C01" ] && bench "true color (3 bands)" rgb "$C01" --mode truecolor
+
+echo ""
+echo "The GDAL path is the MEM dataset plus GeoTIFF written; the native path is one line."
@@ -0,0 +1,69 @@
+#!/bin/bash
+# Reprojection gather benchmark: Morton-ordered 64x64 output tiles (default)
+# against the old row-major walk (HPSV_NO_TILED_REPROJ=1).
+#
+# Near the disk limb consecutive output pixels map to source rows far apart,
+# so a row-major walk over a full-disk 0.5 km source misses in cache and TLB on
+# every gather. Each -v run reports the loop's effective gather bandwidth
+# ("MB/s gathered": source bytes touched, one pixel for gray, the 2x2
+# neighbourhood for RGB, over the loop time). Three loops are measured:
+#   - analytic: solves the inverse projection per pixel, then gathers;
+#   - map:      pure gather from a stored reprojection map
+#               (HPSV_REPROJ_MAP_DIR, first run builds it, later runs reuse it);
+#   - streamed: the analytic loop strip by strip into a GeoTIFF, the path a
+#               .tif output larger than REPROJ_MAX_DIM (10000 px) per side
+#               takes. Its bandwidth leaves out the strip writes. It never
+#               uses maps, which hold the whole output.
+# A 0.5 km full disk in geographic is larger than REPROJ_MAX_DIM, so the
+# in-memory loops write PNG (clamped to REPROJ_MAX_DIM) and only the streamed
+# one writes GeoTIFF.
+#
+# Usage:
+#   reproduction/bench_reproject.sh <full_disk_C02.nc> [<full_disk_C01.nc>]
+#
+# The C02 file drives a gray product at 0.5 km (nearest neighbour, 1 byte/px);
+# the optional C01 file a true color composite with --full-res (bilinear,
+# 3 bytes/px; C02 and C03 are looked up next to it, as usual).
+#
+# Run from the repo root after `make`. OMP_NUM_THREADS caps the threads.
+set -e
+C02="${1:?Usage: $0 <full_disk_C02.nc> [<full_disk_C01.nc>]}"
+C01="$2"
+OUT="$(mktemp --suffix=.png)"
+OUT_TIF="$(mktemp --suffix=.tif)"
+MAP_DIR="$(mktemp -d)"
+trap 'rm -rf "$OUT" "$OUT_TIF" "$MAP_DIR"' EXIT
+
+echo "== CPU threads: $(nproc) (OMP_NUM_THREADS=${OMP_NUM_THREADS:-all}) =="
+
+# bench <label> <hpsv args...>: analytic, map and streamed loops, tiled and
+# row-major.
+bench() {
+    local label="$1"; shift
+    echo ""
+    echo "### $label ###"
+    for walk in tiled row-major; do
+        local env=""
+        [ "$walk" = row-major ] && env="HPSV_NO_TILED_REPROJ=1"
+        echo "-- $walk --"
+        for i in 1 2; do
+            env $env ./bin/hpsv "$@" -o "$OUT" -v 2>&1 | grep -E "Analytic reprojection finished" || true
+        done
+        # Build the map once, then time the pure gather twice.
+        env $env HPSV_REPROJ_MAP_DIR="$MAP_DIR" ./bin/hpsv "$@" -o "$OUT" >/dev/null 2>&1
+        for i in 1 2; do
+            env $env HPSV_REPROJ_MAP_DIR="$MAP_DIR" ./bin/hpsv "$@" -o "$OUT" -v 2>&1 \
+              | grep -E "Reprojection map gather" || true
+        done
+        for i in 1 2; do
+            env $env HPSV_STREAM_REPROJ=1 ./bin/hpsv "$@" -o "$OUT_TIF" -v 2>&1 \
+              | grep -E "Streamed reprojection finished" || true
+        done
+    done
+}
+
+bench "gray C02 0.5 km (nearest)" gray "$C02" -G
+[ -n "$C01" ] && bench "true color --full-res (bilinear)" rgb "$C01" --mode truecolor --full-res -G
+
+echo ""
+echo "Compare the MB/s gathered of each loop between walks; the outputs are identical."
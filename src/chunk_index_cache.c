@@ -0,0 +1,235 @@
+/* Persistent sidecar cache of the HDF5 chunk index used by the fast reader.
+ * Copyright (c) 2025-2026 Alejandro Aguilar Sierra (asierra@unam.mx)
+ * Laboratorio Nacional de Observación de la Tierra, UNAM
+ *
+ * This file is part of HPSATVIEWS.
+ * Licensed under the GNU General Public License v3.0 (see LICENSE file).
+ *
+ * Walking the chunk index is the one part of read_var_chunked_deflate() that
+ * cannot leave HDF5's global lock, and it is repeated every time the same scene
+ * is rendered again (another clip, another product). The index of a GOES file
+ * never changes once written, so it is saved here the first time and reloaded
+ * on later reads, which then go straight to pread + libdeflate.
+ *
+ * One small binary file per (file, variable) under HPSV_CHUNK_CACHE_DIR, named
+ * by a hash of the resolved path and the variable name. The entry repeats the
+ * path and variable in full and records inode, size and mtime, so a hash
+ * collision or a rewritten file reads as a miss. The layout is native-endian:
+ * the cache is meant for the host that wrote it, not for exchange.
+ */
+
+#include "chunk_index_cache.h"
+#include "logger.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#define CIX_MAGIC "HPSVCIX1"
+
+typedef struct {
+  char magic[8];
+  uint32_t header_size; /* sizeof(CixHeader): guards against layout drift */
+  uint32_t elem_size;
+  uint64_t file_size, file_ino;
+  int64_t mtime_sec, mtime_nsec;
+  uint64_t nx, ny, chy, chx, nchunks, base_addr;
+  uint8_t fillval[8];
+  uint32_t path_len, var_len;
+} CixHeader;
+
+/* Identity of the source file at this moment. */
+typedef struct {
+  char path[PATH_MAX];
+  uint64_t size, ino;
+  int64_t mtime_sec, mtime_nsec;
+} FileKey;
+
+bool chunk_cache_enabled(void) {
+  const char *dir = getenv("HPSV_CHUNK_CACHE_DIR");
+  return dir && dir[0] != '\0';
+}
+
+static int file_key(const char *filename, FileKey *key) {
+  struct stat st;
+  if (!realpath(filename, key->path)) return 1;
+  if (stat(key->path, &st) != 0) return 1;
+  key->size = (uint64_t)st.st_size;
+  key->ino = (uint64_t)st.st_ino;
+  key->mtime_sec = (int64_t)st.st_mtim.tv_sec;
+  key->mtime_nsec = (int64_t)st.st_mtim.tv_nsec;
+  return 0;
+}
+
+/* FNV-1a 64 over "path\nvarname": only picks the file name, the entry itself
+ * carries the full key. */
+static int entry_path(const FileKey *key, const char *varname, char *out,
+                      size_t out_len) {
+  uint64_t h = 1469598103934665603ULL;
+  for (const char *p = key->path; *p; p++) {
+    h ^= (uint8_t)*p;
+    h *= 1099511628211ULL;
+  }
+  h ^= (uint8_t)'\n';
+  h *= 1099511628211ULL;
+  for (const char *p = varname; *p; p++) {
+    h ^= (uint8_t)*p;
+    h *= 1099511628211ULL;
+  }
+  int n = snprintf(out, out_len, "%s/%016llx.cix",
+                   getenv("HPSV_CHUNK_CACHE_DIR"), (unsigned long long)h);
+  return (n < 0 || (size_t)n >= out_len) ? 1 : 0;
+}
+
+void chunk_layout_free(ChunkLayout *lay) {
+  if (!lay) return;
+  free(lay->rawaddr);
+  free(lay->rawsize);
+  free(lay->fmask);
+  memset(lay, 0, sizeof(*lay));
+}
+
+int chunk_cache_load(const char *filename, const char *varname,
+                     ChunkLayout *lay) {
+  if (!chunk_cache_enabled()) return 1;
+  FileKey key;
+  char cpath[PATH_MAX + 32];
+  if (file_key(filename, &key) != 0 ||
+      entry_path(&key, varname, cpath, sizeof(cpath)) != 0)
+    return 1;
+
+  FILE *fp = fopen(cpath, "rb");
+  if (!fp) return 1; /* plain miss */
+
+  int rc = 1;
+  char *spath = NULL, *svar = NULL;
+  memset(lay, 0, sizeof(*lay));
+
+  CixHeader h;
+  if (fread(&h, sizeof(h), 1, fp) != 1) goto done;
+  if (memcmp(h.magic, CIX_MAGIC, 8) != 0 || h.header_size != sizeof(h))
+    goto done;
+  if (h.file_size != key.size || h.file_ino != key.ino ||
+      h.mtime_sec != key.mtime_sec || h.mtime_nsec != key.mtime_nsec)
+    goto done; /* source rewritten since the entry was stored */
+  if (h.path_len != strlen(key.path) || h.var_len != strlen(varname))
+    goto done;
+  if (h.elem_size == 0 || h.elem_size > 8 || h.chy == 0 || h.chx == 0)
+    goto done;
+  if (h.nchunks != ((h.ny + h.chy - 1) / h.chy) * ((h.nx + h.chx - 1) / h.chx))
+    goto done;
+
+  spath = malloc(h.path_len + 1);
+  svar = malloc(h.var_len + 1);
+  if (!spath || !svar) goto done;
+  if (fread(spath, 1, h.path_len, fp) != h.path_len ||
+      fread(svar, 1, h.var_len, fp) != h.var_len)
+    goto done;
+  if (memcmp(spath, key.path, h.path_len) != 0 ||
+      memcmp(svar, varname, h.var_len) != 0)
+    goto done; /* hash collision */
+
+  size_t n = (size_t)h.nchunks;
+  lay->rawaddr = malloc(n * sizeof(uint64_t));
+  lay->rawsize = malloc(n * sizeof(uint64_t));
+  lay->fmask = malloc(n * sizeof(uint32_t));
+  if (!lay->rawaddr || !lay->rawsize || !lay->fmask) goto done;
+  if (fread(lay->rawaddr, sizeof(uint64_t), n, fp) != n ||
+      fread(lay->rawsize, sizeof(uint64_t), n, fp) != n ||
+      fread(lay->fmask, sizeof(uint32_t), n, fp) != n)
+    goto done;
+
+  lay->nx = (size_t)h.nx;
+  lay->ny = (size_t)h.ny;
+  lay->chy = (size_t)h.chy;
+  lay->chx = (size_t)h.chx;
+  lay->elem_size = h.elem_size;
+  lay->nchunks = n;
+  lay->base_addr = h.base_addr;
+  memcpy(lay->fillval, h.fillval, sizeof(lay->fillval));
+  rc = 0;
+
+done:
+  fclose(fp);
+  free(spath);
+  free(svar);
+  if (rc != 0) {
+    chunk_layout_free(lay);
+    LOG_DEBUG("Chunk index cache: ignoring unusable entry %s", cpath);
+  }
+  return rc;
+}
+
+int chunk_cache_store(const char *filename, const char *varname,
+                      const ChunkLayout *lay) {
+  if (!chunk_cache_enabled()) return 1;
+  FileKey key;
+  char cpath[PATH_MAX + 32], tmp[PATH_MAX + 64];
+  if (file_key(filename, &key) != 0 ||
+      entry_path(&key, varname, cpath, sizeof(cpath)) != 0)
+    return 1;
+
+  const char *dir = getenv("HPSV_CHUNK_CACHE_DIR");
+  if (mkdir(dir, 0775) != 0 && errno != EEXIST) {
+    LOG_DEBUG("Chunk index cache: cannot create %s: %s", dir, strerror(errno));
+    return 1;
+  }
+
+  CixHeader h;
+  memset(&h, 0, sizeof(h));
+  memcpy(h.magic, CIX_MAGIC, 8);
+  h.header_size = sizeof(h);
+  h.elem_size = (uint32_t)lay->elem_size;
+  h.file_size = key.size;
+  h.file_ino = key.ino;
+  h.mtime_sec = key.mtime_sec;
+  h.mtime_nsec = key.mtime_nsec;
+  h.nx = lay->nx;
+  h.ny = lay->ny;
+  h.chy = lay->chy;
+  h.chx = lay->chx;
+  h.nchunks = lay->nchunks;
+  h.base_addr = lay->base_addr;
+  memcpy(h.fillval, lay->fillval, sizeof(h.fillval));
+  h.path_len = (uint32_t)strlen(key.path);
+  h.var_len = (uint32_t)strlen(varname);
+
+  /* Unique temporary name per process, then an atomic rename: two renders of
+   * the same scene may race to store the same entry. */
+  snprintf(tmp, sizeof(tmp), "%s.%ld.tmp", cpath, (long)getpid());
+  FILE *fp = fopen(tmp, "wb");
+  if (!fp) {
+    LOG_DEBUG("Chunk index cache: cannot write %s: %s", tmp, strerror(errno));
+    return 1;
+  }
+  size_t n = lay->nchunks;
+  bool ok = fwrite(&h, sizeof(h), 1, fp) == 1 &&
+            fwrite(key.path, 1, h.path_len, fp) == h.path_len &&
+            fwrite(varname, 1, h.var_len, fp) == h.var_len &&
+            fwrite(lay->rawaddr, sizeof(uint64_t), n, fp) == n &&
+            fwrite(lay->rawsize, sizeof(uint64_t), n, fp) == n &&
+            fwrite(lay->fmask, sizeof(uint32_t), n, fp) == n;
+  ok = (fclose(fp) == 0) && ok;
+  if (!ok || rename(tmp, cpath) != 0) {
+    LOG_DEBUG("Chunk index cache: failed to store %s", cpath);
+    unlink(tmp);
+    return 1;
+  }
+  LOG_DEBUG("Chunk index cache: stored %s (%zu chunks)", cpath, n);
+  return 0;
+}
+
+void chunk_cache_invalidate(const char *filename, const char *varname) {
+  if (!chunk_cache_enabled()) return;
+  FileKey key;
+  char cpath[PATH_MAX + 32];
+  if (file_key(filename, &key) != 0 ||
+      entry_path(&key, varname, cpath, sizeof(cpath)) != 0)
+    return;
+  unlink(cpath);
+}
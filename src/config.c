@@ -122,20 +122,15 @@ static char* expand_filename_pattern(const char* pattern, const char* input_file
 }
 
 /**
- * Parses the --clip option, which accepts:
+ * Parses a clip value (--clip, or the @clip of a batch item), which accepts:
  * 1. Four coordinates: "lon_min,lat_max,lon_max,lat_min"
  * 2. A region key from the CSV: "mexico", "conus", etc.
  *
- * @param parser Parsed ArgParser instance.
+ * @param clip_value Clip text as given.
  * @param cfg    ProcessConfig to populate with clip bounds.
  * @return true if a valid clip region was found and applied.
  */
-static bool config_parse_clip(ArgParser* parser, ProcessConfig* cfg) {
-    if (!ap_found(parser, "clip")) {
-        return false;
-    }
-    
-    const char* clip_value = ap_get_str_value(parser, "clip");
+static bool config_parse_clip_value(const char* clip_value, ProcessConfig* cfg) {
     if (!clip_value || strlen(clip_value) == 0) {
         return false;
     }
@@ -175,6 +170,13 @@ static bool config_parse_clip(ArgParser* parser, ProcessConfig* cfg) {
     return true;
 }
 
+static bool config_parse_clip(ArgParser* parser, ProcessConfig* cfg) {
+    if (!ap_found(parser, "clip")) {
+        return false;
+    }
+    return config_parse_clip_value(ap_get_str_value(parser, "clip"), cfg);
+}
+
 /**
  * Parses CLAHE parameters from --clahe or --clahe-params=x,y,limit.
  *
@@ -243,6 +245,39 @@ char* insert_geo_suffix(const char *path) {
     return result;
 }
 
+/// Splits a "short:Long description" product name into product_short/product_long.
+static void config_parse_name(const char *raw, ProcessConfig *cfg) {
+    if (!raw) return;
+    const char *colon = strchr(raw, ':');
+    if (colon) {
+        size_t short_len = (size_t)(colon - raw);
+        char *s = malloc(short_len + 1);
+        if (s) { strncpy(s, raw, short_len); s[short_len] = '\0'; }
+        cfg->product_short = s;
+        cfg->product_long  = strdup(colon + 1);
+    } else {
+        cfg->product_short = strdup(raw);
+        cfg->product_long  = strdup(raw);
+    }
+}
+
+/// If GeoTIFF is forced and the output path has a .png extension, switch it to .tif.
+static void config_force_tif_extension(ProcessConfig *cfg) {
+    if (!cfg->force_geotiff || !cfg->output_path_override) return;
+    const char *ext = strrchr(cfg->output_path_override, '.');
+    if (ext && (strcmp(ext, ".png") == 0 || strcmp(ext, ".PNG") == 0)) {
+        size_t base_len = ext - cfg->output_path_override;
+        char* new_path = malloc(base_len + 5); // ".tif\0"
+        if (new_path) {
+            strncpy(new_path, cfg->output_path_override, base_len);
+            strcpy(new_path + base_len, ".tif");
+            LOG_INFO("Extension changed from .png to .tif: %s", new_path);
+            free((void*)cfg->output_path_override);
+            cfg->output_path_override = new_path;
+        }
+    }
+}
+
 static char* config_parse_output(ArgParser* parser, const char* input_file, const char* product_label) {
     if (!ap_found(parser, "out")) {
         return NULL;
@@ -300,20 +335,7 @@ bool config_from_argparser(ArgParser* parser, ProcessConfig* cfg) {
     // Si no hay ':', ambas partes son iguales al valor completo.
     if (cfg->command && strcmp(cfg->command, "rgb") == 0) {
         if (ap_found(parser, "name")) {
-            const char *raw = ap_get_str_value(parser, "name");
-            if (raw) {
-                const char *colon = strchr(raw, ':');
-                if (colon) {
-                    size_t short_len = (size_t)(colon - raw);
-                    char *s = malloc(short_len + 1);
-                    if (s) { strncpy(s, raw, short_len); s[short_len] = '\0'; }
-                    cfg->product_short = s;
-                    cfg->product_long  = strdup(colon + 1);
-                } else {
-                    cfg->product_short = strdup(raw);
-                    cfg->product_long  = strdup(raw);
-                }
-            }
+            config_parse_name(ap_get_str_value(parser, "name"), cfg);
         }
     }
 
@@ -381,8 +403,12 @@ bool config_from_argparser(ArgParser* parser, ProcessConfig* cfg) {
     }
 #endif
     
+    // batch takes the rgb options; only --mode/--name go per product.
+    bool is_rgb = (cfg->command && (strcmp(cfg->command, "rgb") == 0 ||
+                                    strcmp(cfg->command, "batch") == 0));
+
     // Rayleigh atmospheric correction (RGB mode only).
-    if (cfg->command && strcmp(cfg->command, "rgb") == 0) {
+    if (is_rgb) {
         cfg->apply_rayleigh = ap_found(parser, "rayleigh");
         cfg->rayleigh_analytic = ap_found(parser, "ray-analytic");
         cfg->use_piecewise_stretch = ap_found(parser, "stretch");
@@ -414,13 +440,14 @@ bool config_from_argparser(ArgParser* parser, ProcessConfig* cfg) {
     }
     cfg->custom_minmax = ap_found(parser, "minmax") ? ap_get_str_value(parser, "minmax") : NULL;
 
-    bool is_rgb = (cfg->command && strcmp(cfg->command, "rgb") == 0);
     bool is_gray = (cfg->command && strcmp(cfg->command, "gray") == 0);
     // Alfa real por píxel: soportado en gray (PNG GRAY_ALPHA / GeoTIFF banda extra)
     // y en rgb (RGBA). En pseudocolor se ignora: el formato indexado no admite
     // alfa por píxel (ver tRNS de PNG y GCI_PaletteIndex de GDAL), así que ese
     // modo sigue señalando NonData con el color 'N' del .cpt.
     cfg->use_alpha = (is_rgb || is_gray) && ap_found(parser, "alpha");
+    // Valores físicos en Float32 en vez de la imagen renderizada (solo gray).
+    cfg->float_output = is_gray && ap_found(parser, "float");
     // Full resolution mode for low-res L2 products: common to gray/pseudocolor
     // (multi-channel --expr) and rgb (channel resampling reference).
     cfg->use_full_res = ap_found(parser, "full-res");
@@ -449,26 +476,12 @@ bool config_from_argparser(ArgParser* parser, ProcessConfig* cfg) {
     cfg->do_reprojection = ap_found(parser, "geographics") || cfg->save_both;
     
     // --- Salida ---
-    cfg->force_geotiff = ap_found(parser, "geotiff");
+    cfg->force_geotiff = ap_found(parser, "geotiff") || cfg->float_output;
     // {PROD} token uses the short product name, or strategy name if --name not set.
     const char *prod_for_pattern = cfg->product_short ? cfg->product_short : cfg->strategy;
     cfg->output_path_override = config_parse_output(parser, cfg->input_file, prod_for_pattern);
     
-    // If GeoTIFF is forced and the output path has a .png extension, switch it to .tif.
-    if (cfg->force_geotiff && cfg->output_path_override) {
-        const char *ext = strrchr(cfg->output_path_override, '.');
-        if (ext && (strcmp(ext, ".png") == 0 || strcmp(ext, ".PNG") == 0)) {
-            size_t base_len = ext - cfg->output_path_override;
-            char* new_path = malloc(base_len + 5); // ".tif\0"
-            if (new_path) {
-                strncpy(new_path, cfg->output_path_override, base_len);
-                strcpy(new_path + base_len, ".tif");
-                LOG_INFO("Extension changed from .png to .tif: %s", new_path);
-                free((void*)cfg->output_path_override);
-                cfg->output_path_override = new_path;
-            }
-        }
-    }
+    config_force_tif_extension(cfg);
     
     // Detectar si es producto L2 (CMIP en el nombre)
     cfg->is_l2_product = false;
@@ -525,6 +538,10 @@ bool config_validate(const ProcessConfig* cfg) {
         LOG_ERROR("scale must be an integer in range [-20, 20], value: %d", cfg->scale);
         return false;
     }
+    if (cfg->float_output && cfg->scale != 1) {
+        LOG_ERROR("--float writes the data at their own resolution; --scale is not supported.");
+        return false;
+    }
     
     // Validate clip region bounds.
     if (cfg->has_clip) {
@@ -612,6 +629,7 @@ void config_print_debug(const ProcessConfig* cfg) {
     
     LOG_DEBUG("--- Output ---");
     LOG_DEBUG("  force_geotiff: %s", cfg->force_geotiff ? "true" : "false");
+    LOG_DEBUG("  float_output: %s", cfg->float_output ? "true" : "false");
     LOG_DEBUG("  output_override: %s", 
              cfg->output_path_override ? cfg->output_path_override : "NULL");
     LOG_DEBUG("=====================");
@@ -636,3 +654,35 @@ void config_destroy(ProcessConfig* cfg) {
         cfg->product_long = NULL;
     }
 }
+
+bool config_batch_item(ArgParser* parser, const ProcessConfig* base, char* spec,
+                       ProcessConfig* item) {
+    *item = *base;
+    item->command = "rgb";
+    item->product_short = NULL;
+    item->product_long = NULL;
+    item->output_path_override = NULL;
+
+    // mode[@clip][=short[:Long description]]
+    char *name = strchr(spec, '=');
+    if (name) *name++ = '\0';
+    char *clip = strchr(spec, '@');
+    if (clip) *clip++ = '\0';
+    if (spec[0] == '\0') {
+        LOG_ERROR("Batch item without a mode.");
+        return false;
+    }
+    item->strategy = spec;
+    if (clip && !config_parse_clip_value(clip, item)) {
+        LOG_ERROR("Batch item '%s': invalid clip '%s'.", spec, clip);
+        return false;
+    }
+    if (name) {
+        config_parse_name(name, item);
+    }
+
+    const char *prod_for_pattern = item->product_short ? item->product_short : item->strategy;
+    item->output_path_override = config_parse_output(parser, item->input_file, prod_for_pattern);
+    config_force_tif_extension(item);
+    return true;
+}
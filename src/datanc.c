@@ -6,6 +6,7 @@
  * Licensed under the GNU General Public License v3.0 (see LICENSE file).
  */
 #include <float.h>
+#include <limits.h>
 #include <math.h>
 #include <omp.h>
 #include <stdint.h>
@@ -15,6 +16,7 @@
 
 #include "datanc.h"
 #include "logger.h"
+#include "nav_cache.h"
 
 float NonData = 1.0e+32;
 
@@ -28,6 +30,7 @@ DataF dataf_create(unsigned int width, unsigned int height) {
     data.size = width * height;
     data.fmin = 0.0f;
     data.fmax = 0.0f;
+    data.spans = NULL;
     // Allocate memory with error checking
     if (data.size > 0) {
         data.data_in = malloc(sizeof(float) * data.size);
@@ -46,10 +49,13 @@ DataF dataf_create(unsigned int width, unsigned int height) {
 // Destructor for DataF structure
 void dataf_destroy(DataF *data) {
     if (data != NULL) {
-        if (data->data_in != NULL) {
+        // Grids mapped from the navigation cache are unmapped, not freed.
+        if (data->data_in != NULL && !nav_cache_release(data->data_in)) {
             free(data->data_in);
-            data->data_in = NULL;
         }
+        data->data_in = NULL;
+        free(data->spans);
+        data->spans = NULL;
         // Reset all fields to safe values
         data->width = 0;
         data->height = 0;
@@ -73,6 +79,7 @@ DataF dataf_copy(const DataF *data) {
     // Copy scalar members
     copy.fmin = data->fmin;
     copy.fmax = data->fmax;
+    copy.spans = disk_spans_copy(data->spans);
 
     memcpy(copy.data_in, data->data_in, data->size * sizeof(float));
 
@@ -85,12 +92,68 @@ void dataf_fill(DataF *data, float value) {
         return; // Nothing to fill
     }
 
+    dataf_drop_spans(data);
 #pragma omp parallel for
     for (size_t i = 0; i < data->size; i++) {
         data->data_in[i] = value;
     }
 }
 
+static DiskSpans *disk_spans_alloc(unsigned int height) {
+    DiskSpans *s = malloc(sizeof(DiskSpans) + (size_t)height * sizeof(s->x[0]));
+    if (s) {
+        s->height = height;
+        s->npix = 0;
+    }
+    return s;
+}
+
+DiskSpans *disk_spans_copy(const DiskSpans *spans) {
+    if (!spans) return NULL;
+    DiskSpans *s = disk_spans_alloc(spans->height);
+    if (s) memcpy(s, spans, sizeof(DiskSpans) + (size_t)spans->height * sizeof(s->x[0]));
+    return s;
+}
+
+void dataf_drop_spans(DataF *data) {
+    if (!data) return;
+    free(data->spans);
+    data->spans = NULL;
+}
+
+// Spans of a box filter by `factor` (w x h out): an output pixel is exactly
+// NonData when its whole block is, i.e. when the block misses every source span.
+static DiskSpans *disk_spans_downsample(const DiskSpans *src, int factor, unsigned int w,
+                                        unsigned int h) {
+    if (!src || h == 0) return NULL;
+    DiskSpans *s = disk_spans_alloc(h);
+    if (!s) return NULL;
+    for (unsigned int j = 0; j < h; j++) {
+        unsigned int x0 = UINT_MAX, x1 = 0;
+        for (unsigned int r = j * factor; r < (j + 1) * factor && r < src->height; r++) {
+            if (src->x[r][0] == src->x[r][1]) continue;
+            if (src->x[r][0] < x0) x0 = src->x[r][0];
+            if (src->x[r][1] > x1) x1 = src->x[r][1];
+        }
+        if (x0 >= x1) {
+            x0 = x1 = 0;
+        } else {
+            x0 /= factor;
+            x1 = (x1 + factor - 1) / factor;
+            if (x1 > w) x1 = w;
+            if (x0 > x1) x0 = x1;
+        }
+        s->x[j][0] = x0;
+        s->x[j][1] = x1;
+        s->npix += x1 - x0;
+    }
+    if (s->npix == (size_t)w * h) {
+        free(s);
+        return NULL;
+    }
+    return s;
+}
+
 DataF dataf_crop(const DataF *data, unsigned int x_start, unsigned int y_start, unsigned int width,
                  unsigned int height) {
     if (data == NULL || data->data_in == NULL || data->size == 0) {
@@ -203,6 +266,7 @@ DataF downsample_boxfilter(DataF datanc_big, int factor) {
             datanc.data_in[j * datanc.width + i] = (float)(f / acum);
         }
     }
+    datanc.spans = disk_spans_downsample(datanc_big.spans, factor, datanc.width, datanc.height);
     double end = omp_get_wtime();
     LOG_TIMING(end - start, "Downsampling boxfilter (factor=%d)", factor);
     return datanc;
@@ -307,43 +371,72 @@ DataF dataf_op_dataf(const DataF *a, const DataF *b, Operation op) {
     if (result.data_in == NULL)
         return result;
 
+    // NonData in either operand gives NonData, so the result only has data
+    // where both spans overlap.
+    if (a->spans || b->spans) {
+        result.spans = disk_spans_copy(a->spans ? a->spans : b->spans);
+        if (result.spans && a->spans && b->spans) {
+            size_t npix = 0;
+            for (unsigned int y = 0; y < result.height; y++) {
+                unsigned int x0 = a->spans->x[y][0] > b->spans->x[y][0] ? a->spans->x[y][0]
+                                                                        : b->spans->x[y][0];
+                unsigned int x1 = a->spans->x[y][1] < b->spans->x[y][1] ? a->spans->x[y][1]
+                                                                        : b->spans->x[y][1];
+                if (x1 <= x0) x0 = x1 = 0;
+                result.spans->x[y][0] = x0;
+                result.spans->x[y][1] = x1;
+                npix += x1 - x0;
+            }
+            result.spans->npix = npix;
+        }
+    }
+
     float fmin = 1e20f, fmax = -1e20f;
+    const unsigned int w = a->width;
 
 #pragma omp parallel for reduction(min : fmin) reduction(max : fmax)
-    for (size_t i = 0; i < a->size; i++) {
-        float val_a = a->data_in[i];
-        float val_b = b->data_in[i];
-
-        if (val_a == NonData || val_b == NonData) {
-            result.data_in[i] = NonData;
-            continue;
-        }
+    for (unsigned int y = 0; y < a->height; y++) {
+        unsigned int x0, x1;
+        dataf_row_span(&result, y, &x0, &x1);
+        float *out = result.data_in + (size_t)y * w;
+        for (unsigned int x = 0; x < x0; x++) out[x] = NonData;
+        for (unsigned int x = x1; x < w; x++) out[x] = NonData;
+
+        for (size_t i = (size_t)y * w + x0; i < (size_t)y * w + x1; i++) {
+            float val_a = a->data_in[i];
+            float val_b = b->data_in[i];
+
+            if (val_a == NonData || val_b == NonData) {
+                result.data_in[i] = NonData;
+                continue;
+            }
 
-        float res_val;
-        switch (op) {
-        case OP_ADD:
-            res_val = val_a + val_b;
-            break;
-        case OP_SUB:
-            res_val = val_a - val_b;
-            break;
-        case OP_MUL:
-            res_val = val_a * val_b;
-            break;
-        case OP_DIV:
-            res_val = (fabsf(val_b) > 1e-9) ? (val_a / val_b) : NonData;
-            break;
-        default:
-            res_val = NonData;
-            break;
-        }
-        result.data_in[i] = res_val;
+            float res_val;
+            switch (op) {
+            case OP_ADD:
+                res_val = val_a + val_b;
+                break;
+            case OP_SUB:
+                res_val = val_a - val_b;
+                break;
+            case OP_MUL:
+                res_val = val_a * val_b;
+                break;
+            case OP_DIV:
+                res_val = (fabsf(val_b) > 1e-9) ? (val_a / val_b) : NonData;
+                break;
+            default:
+                res_val = NonData;
+                break;
+            }
+            result.data_in[i] = res_val;
 
-        if (res_val != NonData) {
-            if (res_val < fmin)
-                fmin = res_val;
-            if (res_val > fmax)
-                fmax = res_val;
+            if (res_val != NonData) {
+                if (res_val < fmin)
+                    fmin = res_val;
+                if (res_val > fmax)
+                    fmax = res_val;
+            }
         }
     }
 
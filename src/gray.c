@@ -13,7 +13,19 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
+// n pixels of the NonData value (alpha too if bpp == 2).
+static void fill_nodata(uint8_t *p, unsigned int n, unsigned int bpp, uint8_t r, uint8_t a) {
+  if (bpp == 1) {
+    memset(p, r, n);
+    return;
+  }
+  for (unsigned int x = 0; x < n; x++) {
+    p[2 * x] = r;
+    p[2 * x + 1] = a;
+  }
+}
 
 ImageData create_single_gray(DataF c01, bool invert_value, bool use_alpha,
                              float min_val, float max_val, const CPTData* cpt) {
@@ -33,12 +45,26 @@ ImageData create_single_gray(DataF c01, bool invert_value, bool use_alpha,
   float range = max_val - min_val;
   if (range == 0.0f) range = 1.0f;
 
+  // NonData pixel: transparent with alpha, the CPT's NaN colour if it has one.
+  uint8_t r_nodata = 0, a_nodata = 0;
+  if (!use_alpha && cpt && cpt->has_nan_color) {
+    r_nodata = last_color;
+    a_nodata = 255;
+  }
+
   #pragma omp parallel for
   for (unsigned int y = 0; y < imout.height; y++) {
-    for (unsigned int x = 0; x < imout.width; x++) {
+    // Off the disk (c01.spans) every pixel is NonData: fill, don't test.
+    unsigned int x0, x1;
+    dataf_row_span(&c01, y, &x0, &x1);
+    uint8_t *row = imout.data + (size_t)y * imout.width * imout.bpp;
+    fill_nodata(row, x0, imout.bpp, r_nodata, a_nodata);
+    fill_nodata(row + (size_t)x1 * imout.bpp, imout.width - x1, imout.bpp, r_nodata, a_nodata);
+
+    for (unsigned int x = x0; x < x1; x++) {
       int i = y * imout.width + x;
       int po = i * imout.bpp;
-      uint8_t r = 0, a = 0;
+      uint8_t r = r_nodata, a = a_nodata;
 
       if (c01.data_in[i] != NonData && !IS_NONDATA(c01.data_in[i])) {
         float val = c01.data_in[i];
@@ -53,17 +79,6 @@ ImageData create_single_gray(DataF c01, bool invert_value, bool use_alpha,
 
         r = (unsigned char)(last_color * normalized_val);
         a = 255;
-      } else {
-        if (use_alpha) {
-          r = 0;
-          a = 0;
-        } else if (cpt && cpt->has_nan_color) {
-          r = last_color;
-          a = 255;
-        } else {
-          r = 0;
-          a = 0;
-        }
       }
 
       imout.data[po] = r;
@@ -459,14 +459,10 @@ ImageData image_upsample_bilinear(const ImageData *src, int factor) {
     return result;
 }
 
-ImageData image_downsample_boxfilter(const ImageData *src, int factor) {
-    if (src == NULL || src->data == NULL || factor < 1) {
-        return image_create(0, 0, 0);
-    }
-
-    unsigned int new_width = src->width / factor;
-    unsigned int new_height = src->height / factor;
-
+// Promedio de cajas de factor×factor sobre una salida de new_width×new_height;
+// las cajas que se salen de la imagen promedian solo los píxeles que cubren.
+static ImageData downsample_box(const ImageData *src, int factor,
+                                unsigned int new_width, unsigned int new_height) {
     if (new_width == 0 || new_height == 0) {
         LOG_ERROR("Downsampling factor is too large for this image.");
         return image_create(0, 0, 0);
@@ -514,6 +510,21 @@ ImageData image_downsample_boxfilter(const ImageData *src, int factor) {
     return result;
 }
 
+ImageData image_downsample_boxfilter(const ImageData *src, int factor) {
+    if (src == NULL || src->data == NULL || factor < 1) {
+        return image_create(0, 0, 0);
+    }
+    return downsample_box(src, factor, src->width / factor, src->height / factor);
+}
+
+ImageData image_downsample_boxfilter_cover(const ImageData *src, int factor) {
+    if (src == NULL || src->data == NULL || factor < 1) {
+        return image_create(0, 0, 0);
+    }
+    return downsample_box(src, factor, (src->width + factor - 1) / factor,
+                          (src->height + factor - 1) / factor);
+}
+
 ImageData image_create_alpha_mask_from_dataf(const void *data_ptr) {
     const DataF *data = (const DataF *)data_ptr;
     if (data == NULL || data->data_in == NULL) {
@@ -1,4 +1,4 @@
-/* Main entry point: dispatches gray, pseudocolor, and rgb commands.
+/* Main entry point: dispatches gray, pseudocolor, rgb, and batch commands.
  * Copyright (c) 2025-2026 Alejandro Aguilar Sierra (asierra@unam.mx)
  * Laboratorio Nacional de Observación de la Tierra, UNAM
  *
@@ -110,6 +110,69 @@ int cmd_rgb(char *cmd_name, ArgParser *cmd_parser) {
     return generic_cmd_handler("rgb", cmd_parser, run_rgb);
 }
 
+/// batch: several rgb products of one scene (run_rgb_batch). Every argument after
+/// the anchor is a product, "mode[@clip][=short[:Long description]]".
+int cmd_batch(char *cmd_name, ArgParser *cmd_parser) {
+    (void)cmd_name;
+    ProcessConfig cfg = {0};
+    cfg.command = "batch";
+
+    if (!config_from_argparser(cmd_parser, &cfg) || !config_validate(&cfg)) {
+        LOG_ERROR("Invalid configuration.");
+        config_destroy(&cfg);
+        return 1;
+    }
+
+    int count = ap_count_args(cmd_parser) - 1;
+    if (count < 1) {
+        LOG_ERROR("batch: list the products after the input file (mode[@clip][=name]).");
+        config_destroy(&cfg);
+        return 1;
+    }
+    if (count > 1 && cfg.output_path_override &&
+        !strstr(ap_get_str_value(cmd_parser, "out"), "{PROD}")) {
+        LOG_ERROR("batch: with several products, -o must contain {PROD}.");
+        config_destroy(&cfg);
+        return 1;
+    }
+
+    ProcessConfig *items = calloc((size_t)count, sizeof(*items));
+    char **specs = calloc((size_t)count, sizeof(*specs));
+    MetadataContext **metas = calloc((size_t)count, sizeof(*metas));
+    int *status = calloc((size_t)count, sizeof(*status));
+    bool ok = items && specs && metas && status;
+    for (int i = 0; ok && i < count; i++) {
+        specs[i] = strdup(ap_get_arg_at_index(cmd_parser, i + 1));
+        ok = specs[i] && config_batch_item(cmd_parser, &cfg, specs[i], &items[i]) &&
+             config_validate(&items[i]) && (metas[i] = metadata_create()) != NULL;
+    }
+
+    int result = 1;
+    if (ok) {
+        int failed = run_rgb_batch(items, count, metas, status);
+        for (int i = 0; i < count; i++) {
+            if (status[i] == 0) {
+                save_sidecar_json(&items[i], metas[i], cmd_parser);
+            }
+        }
+        result = failed == 0 ? 0 : 1;
+    } else {
+        LOG_ERROR("Invalid batch product list.");
+    }
+
+    for (int i = 0; items && i < count; i++) {
+        config_destroy(&items[i]);
+        if (metas) metadata_destroy(metas[i]);
+        if (specs) free(specs[i]);
+    }
+    free(items);
+    free(specs);
+    free(metas);
+    free(status);
+    config_destroy(&cfg);
+    return result;
+}
+
 int cmd_pseudocolor(char *cmd_name, ArgParser *cmd_parser) {
     (void)cmd_name;
     return generic_cmd_handler("pseudocolor", cmd_parser, run_processing);
@@ -181,6 +244,19 @@ int main(int argc, char *argv[]) {
         ap_set_cmd_callback(rgb_cmd, cmd_rgb);
     }
 
+    ArgParser *batch_cmd = ap_new_cmd(parser, "batch");
+    if (batch_cmd) {
+        ap_set_helptext(batch_cmd, HPSATVIEWS_HELP_BATCH);
+        ap_add_flag(batch_cmd, "citylights l");
+        add_common_opts(batch_cmd);
+        ap_add_flag(batch_cmd, "rayleigh");
+        ap_add_flag(batch_cmd, "ray-analytic");
+        ap_add_flag(batch_cmd, "stretch");
+        ap_add_flag(batch_cmd, "sharpen");
+        ap_add_str_opt(batch_cmd, "cloud-temp T", "0");
+        ap_set_cmd_callback(batch_cmd, cmd_batch);
+    }
+
     ArgParser *pc_cmd = ap_new_cmd(parser, "pseudocolor pseudo");
     if (pc_cmd) {
         ap_set_helptext(pc_cmd, HPSATVIEWS_HELP_PSEUDOCOLOR);
@@ -195,6 +271,7 @@ int main(int argc, char *argv[]) {
         ap_set_helptext(sg_cmd, HPSATVIEWS_HELP_GRAY);
         add_common_opts(sg_cmd);
         ap_add_flag(sg_cmd, "invert i");
+        ap_add_flag(sg_cmd, "float");
         ap_set_cmd_callback(sg_cmd, cmd_gray);
     }
 
@@ -0,0 +1,252 @@
+/* Persistent, memory-mapped cache of the lat/lon navigation grids.
+ * Copyright (c) 2025-2026 Alejandro Aguilar Sierra (asierra@unam.mx)
+ * Laboratorio Nacional de Observación de la Tierra, UNAM
+ *
+ * This file is part of HPSATVIEWS.
+ * Licensed under the GNU General Public License v3.0 (see LICENSE file).
+ *
+ * The lat/lon grids of a GOES fixed grid depend only on its geometry: grid
+ * size, the goes_imager_projection parameters and the scan angles x[]/y[]. A
+ * 10-minute full-disk cadence recomputes the very same grids for every scene
+ * (two 471-megapixel grids at 0.5 km). With HPSV_NAV_CACHE_DIR set they are
+ * saved here once and later runs map the file instead of computing anything.
+ *
+ * One file per geometry, named by a hash of the NavPlan. The entry repeats the
+ * projection parameters and the full x_rad[]/y_rad[] arrays, compared exactly
+ * on every lookup, so a hash collision or a different sector reads as a miss.
+ * The grids follow at a page-aligned offset and are mapped MAP_PRIVATE: no copy
+ * is made, and a caller that writes into a grid only gets private pages.
+ * Native-endian, like the chunk index cache: meant for the host that wrote it.
+ */
+
+#include "nav_cache.h"
+#include "logger.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <omp.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#define NAV_MAGIC "HPSVNAV1"
+#define NAV_ALIGN 4096
+
+typedef struct {
+  char magic[8];
+  uint32_t header_size; /* sizeof(NavHeader): guards against layout drift */
+  uint32_t reserved;
+  uint64_t width, height;
+  double H, lambda_0, sm_maj, sm_min;
+  float la_min, la_max, lo_min, lo_max;
+  uint64_t grid_offset; /* lat grid, then lon grid, width*height floats each */
+} NavHeader;
+
+/* Mappings handed out by nav_cache_map(); dataf_destroy() gives each grid back
+ * through nav_cache_release(). A run maps at most a couple of geometries. */
+#define NAV_MAX_MAPS 8
+static struct {
+  void *base;
+  size_t len;
+  float *la, *lo; /* NULL once released */
+} maps[NAV_MAX_MAPS];
+static int live_maps; /* lets nav_cache_release() skip the lock when none */
+
+bool nav_cache_enabled(void) {
+  const char *dir = getenv("HPSV_NAV_CACHE_DIR");
+  return dir && dir[0] != '\0';
+}
+
+static uint64_t fnv1a(uint64_t h, const void *p, size_t n) {
+  const uint8_t *b = (const uint8_t *)p;
+  for (size_t i = 0; i < n; i++) {
+    h ^= b[i];
+    h *= 1099511628211ULL;
+  }
+  return h;
+}
+
+uint64_t nav_plan_hash(const NavPlan *plan) {
+  uint64_t h = 1469598103934665603ULL;
+  h = fnv1a(h, &plan->width, sizeof(plan->width));
+  h = fnv1a(h, &plan->height, sizeof(plan->height));
+  h = fnv1a(h, &plan->H, sizeof(plan->H));
+  h = fnv1a(h, &plan->lambda_0, sizeof(plan->lambda_0));
+  h = fnv1a(h, &plan->sm_maj, sizeof(plan->sm_maj));
+  h = fnv1a(h, &plan->sm_min, sizeof(plan->sm_min));
+  h = fnv1a(h, plan->x_rad, plan->width * sizeof(double));
+  h = fnv1a(h, plan->y_rad, plan->height * sizeof(double));
+  return h;
+}
+
+static int entry_path(const NavPlan *plan, char *out, size_t out_len) {
+  uint64_t h = nav_plan_hash(plan);
+  int n = snprintf(out, out_len, "%s/%016llx.nav", getenv("HPSV_NAV_CACHE_DIR"),
+                   (unsigned long long)h);
+  return (n < 0 || (size_t)n >= out_len) ? 1 : 0;
+}
+
+static uint64_t grid_offset(const NavPlan *plan) {
+  uint64_t off = sizeof(NavHeader) + (plan->width + plan->height) * sizeof(double);
+  return (off + NAV_ALIGN - 1) / NAV_ALIGN * NAV_ALIGN;
+}
+
+static bool header_matches(const NavHeader *h, const NavPlan *plan) {
+  return memcmp(h->magic, NAV_MAGIC, 8) == 0 && h->header_size == sizeof(*h) &&
+         h->width == plan->width && h->height == plan->height &&
+         h->H == plan->H && h->lambda_0 == plan->lambda_0 &&
+         h->sm_maj == plan->sm_maj && h->sm_min == plan->sm_min &&
+         h->grid_offset == grid_offset(plan);
+}
+
+int nav_cache_map(const NavPlan *plan, DataF *navla, DataF *navlo) {
+  if (!nav_cache_enabled() || !plan->x_rad || !plan->y_rad) return 1;
+  char path[PATH_MAX];
+  if (entry_path(plan, path, sizeof(path)) != 0) return 1;
+
+  double t0 = omp_get_wtime();
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) return 1; /* plain miss */
+  struct stat st;
+  const size_t npix = plan->width * plan->height;
+  const uint64_t expect = grid_offset(plan) + 2 * npix * sizeof(float);
+  if (fstat(fd, &st) != 0 || (uint64_t)st.st_size != expect) {
+    close(fd);
+    LOG_DEBUG("Navigation cache: ignoring unusable entry %s", path);
+    return 1;
+  }
+  void *base = mmap(NULL, (size_t)expect, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED) return 1;
+
+  const NavHeader *h = (const NavHeader *)base;
+  const double *xs = (const double *)((const uint8_t *)base + sizeof(NavHeader));
+  const double *ys = xs + plan->width;
+  if (!header_matches(h, plan) ||
+      memcmp(xs, plan->x_rad, plan->width * sizeof(double)) != 0 ||
+      memcmp(ys, plan->y_rad, plan->height * sizeof(double)) != 0) {
+    munmap(base, (size_t)expect);
+    LOG_DEBUG("Navigation cache: %s belongs to another geometry", path);
+    return 1;
+  }
+
+  float *la = (float *)((uint8_t *)base + h->grid_offset);
+  float *lo = la + npix;
+  int slot = -1;
+#pragma omp critical(nav_cache)
+  for (int i = 0; i < NAV_MAX_MAPS && slot < 0; i++) {
+    if (maps[i].base == NULL) {
+      maps[i].base = base;
+      maps[i].len = (size_t)expect;
+      maps[i].la = la;
+      maps[i].lo = lo;
+      slot = i;
+#pragma omp atomic update
+      live_maps++;
+    }
+  }
+  if (slot < 0) { /* too many live mappings: compute instead */
+    munmap(base, (size_t)expect);
+    return 1;
+  }
+
+  navla->width = navlo->width = (unsigned int)plan->width;
+  navla->height = navlo->height = (unsigned int)plan->height;
+  navla->size = navlo->size = npix;
+  navla->data_in = la;
+  navlo->data_in = lo;
+  navla->spans = navlo->spans = NULL;
+  navla->fmin = h->la_min;
+  navla->fmax = h->la_max;
+  navlo->fmin = h->lo_min;
+  navlo->fmax = h->lo_max;
+  LOG_TIMING(omp_get_wtime() - t0, "Navigation cache hit (%zux%zu, %s)", plan->width,
+             plan->height, path);
+  return 0;
+}
+
+int nav_cache_store(const NavPlan *plan, const DataF *navla, const DataF *navlo) {
+  if (!nav_cache_enabled() || !plan->x_rad || !plan->y_rad) return 1;
+  const size_t npix = plan->width * plan->height;
+  if (!navla->data_in || !navlo->data_in || navla->size != npix || navlo->size != npix)
+    return 1;
+  char path[PATH_MAX], tmp[PATH_MAX + 32];
+  if (entry_path(plan, path, sizeof(path)) != 0) return 1;
+
+  const char *dir = getenv("HPSV_NAV_CACHE_DIR");
+  if (mkdir(dir, 0775) != 0 && errno != EEXIST) {
+    LOG_DEBUG("Navigation cache: cannot create %s: %s", dir, strerror(errno));
+    return 1;
+  }
+
+  NavHeader h;
+  memset(&h, 0, sizeof(h));
+  memcpy(h.magic, NAV_MAGIC, 8);
+  h.header_size = sizeof(h);
+  h.width = plan->width;
+  h.height = plan->height;
+  h.H = plan->H;
+  h.lambda_0 = plan->lambda_0;
+  h.sm_maj = plan->sm_maj;
+  h.sm_min = plan->sm_min;
+  h.la_min = navla->fmin;
+  h.la_max = navla->fmax;
+  h.lo_min = navlo->fmin;
+  h.lo_max = navlo->fmax;
+  h.grid_offset = grid_offset(plan);
+
+  /* Unique temporary name per process, then an atomic rename: two renders of
+   * the same sector may race to store the same entry. */
+  snprintf(tmp, sizeof(tmp), "%s.%ld.tmp", path, (long)getpid());
+  FILE *fp = fopen(tmp, "wb");
+  if (!fp) {
+    LOG_DEBUG("Navigation cache: cannot write %s: %s", tmp, strerror(errno));
+    return 1;
+  }
+  size_t pad = (size_t)(h.grid_offset - sizeof(h) -
+                        (plan->width + plan->height) * sizeof(double));
+  static const uint8_t zeros[NAV_ALIGN];
+  bool ok = fwrite(&h, sizeof(h), 1, fp) == 1 &&
+            fwrite(plan->x_rad, sizeof(double), plan->width, fp) == plan->width &&
+            fwrite(plan->y_rad, sizeof(double), plan->height, fp) == plan->height &&
+            fwrite(zeros, 1, pad, fp) == pad &&
+            fwrite(navla->data_in, sizeof(float), npix, fp) == npix &&
+            fwrite(navlo->data_in, sizeof(float), npix, fp) == npix;
+  ok = (fclose(fp) == 0) && ok;
+  if (!ok || rename(tmp, path) != 0) {
+    LOG_DEBUG("Navigation cache: failed to store %s", path);
+    unlink(tmp);
+    return 1;
+  }
+  LOG_DEBUG("Navigation cache: stored %s (%zux%zu)", path, plan->width, plan->height);
+  return 0;
+}
+
+bool nav_cache_release(float *data) {
+  int live;
+#pragma omp atomic read
+  live = live_maps;
+  if (!data || live == 0) return false;
+  bool found = false;
+#pragma omp critical(nav_cache)
+  for (int i = 0; i < NAV_MAX_MAPS && !found; i++) {
+    if (maps[i].base == NULL) continue;
+    if (maps[i].la == data) maps[i].la = NULL;
+    else if (maps[i].lo == data) maps[i].lo = NULL;
+    else continue;
+    found = true;
+    if (!maps[i].la && !maps[i].lo) {
+      munmap(maps[i].base, maps[i].len);
+      maps[i].base = NULL;
+#pragma omp atomic update
+      live_maps--;
+    }
+  }
+  return found;
+}
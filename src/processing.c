@@ -15,6 +15,7 @@
 #include "writer_png.h"
 #include "writer_geotiff.h"
 #include "reprojection.h"
+#include "nav_plan.h"
 #include "image.h"
 #include "datanc.h"
 #include "clip_loader.h"
@@ -43,6 +44,159 @@ bool strinstr(const char *main_str, const char *sub) {
 // PIPELINE v2.0: ProcessConfig + MetadataContext
 // ============================================================================
 
+// A fixed-grid clip only shows the pixels inside its bounding box. When nothing
+// in the rendering depends on the rest of the disk — the gray range is given
+// (--minmax) or the data are bytes, and there is no histogram/CLAHE or
+// reprojection — only that window is read from the file. The navigation is
+// computed up front and returned already cropped to the window.
+// HPSV_NO_CLIP_WINDOW=1 forces the full read.
+static bool plan_clip_window(const ProcessConfig* cfg, bool minmax_provided,
+                             DataF* navla, DataF* navlo, PixelWindow* win) {
+    if (!cfg->has_clip || cfg->do_reprojection || cfg->save_both ||
+        cfg->apply_histogram || cfg->apply_clahe || getenv("HPSV_NO_CLIP_WINDOW"))
+        return false;
+
+    DataNC hdr;
+    if (load_nc_header(cfg->input_file, &hdr) != 0) return false;
+    free((void*)hdr.varname);
+    // autoscale needs the whole grid (--float writes the values, no scaling)
+    if (hdr.is_float && !minmax_provided && !cfg->float_output) return false;
+
+    // Per-pixel rendering only, no alignment needed; the margin keeps the
+    // final crop (clip_crop_box) inside the window.
+    bool ok = reprojection_clip_navigation(cfg->input_file, cfg->clip_coords, 4, 1,
+                                           win, navla, navlo);
+    if (ok) LOG_INFO("Clip window: %u,%u %ux%u px", win->x0, win->y0, win->width, win->height);
+    return ok;
+}
+
+// Fixed-grid crop of a clip in the grid c01 holds (the input file's, or the
+// window `win` of it that was read). The box comes from the file's geometry
+// (reprojection_find_bounding_box with a plan) and needs no navigation grids;
+// navla/navlo, when loaded, are searched only if the clip crosses the limb or
+// the plan does not describe c01's grid (an --expr on another channel's grid).
+static bool clip_crop_box(const ProcessConfig* cfg, const PixelWindow* win, const DataNC* c01,
+                          const DataF* navla, const DataF* navlo, PixelWindow* box) {
+    unsigned int w = c01->is_float ? c01->fdata.width : c01->bdata.width;
+    unsigned int h = c01->is_float ? c01->fdata.height : c01->bdata.height;
+    NavPlan plan;
+    if (nav_build_plan(cfg->input_file, &plan) == 0 && win) {
+        NavPlan full = plan;
+        nav_plan_window(&full, win->x0, win->y0, win->width, win->height, &plan);
+        nav_plan_destroy(&full);
+    }
+    bool use_plan = plan.width == w && plan.height == h;
+
+    int ix, iy, iw, ih;
+    reprojection_find_bounding_box(use_plan ? &plan : NULL, navla, navlo,
+                                   cfg->clip_coords[0], cfg->clip_coords[1],
+                                   cfg->clip_coords[2], cfg->clip_coords[3],
+                                   &ix, &iy, &iw, &ih);
+    nav_plan_destroy(&plan);
+    if (iw <= 0 || ih <= 0) return false;
+    *box = (PixelWindow){(unsigned)ix, (unsigned)iy, (unsigned)iw, (unsigned)ih};
+    return true;
+}
+
+// --float: writes the physical values of c01 (reflectance, BT, the result of
+// --expr) as Float32 GeoTIFF, fixed-grid and/or geographic like the rendered
+// outputs, skipping the whole rendering chain. Returns 0 on success.
+static int save_float_outputs(const ProcessConfig* cfg, DataNC* c01,
+                              const DataF* navla, const DataF* navlo, const PixelWindow* crop,
+                              const char* outfn, MetadataContext* meta) {
+    if (!c01->is_float || !c01->fdata.data_in) {
+        LOG_ERROR("--float requires a float variable; %s holds byte data.", cfg->input_file);
+        return 1;
+    }
+    if (fabsf(cfg->gamma[0] - 1.0f) > 1e-6f || cfg->apply_histogram || cfg->apply_clahe ||
+        cfg->invert_values || cfg->use_alpha)
+        LOG_WARN("--float writes physical values: rendering options are ignored.");
+    metadata_add_bool(meta, "float", true);
+
+    int status = 0;
+    unsigned int out_w = c01->fdata.width, out_h = c01->fdata.height;
+    if (cfg->save_both || !cfg->do_reprojection) {
+        DataF fg = c01->fdata;
+        bool fg_allocated = false;
+        int crop_x = 0, crop_y = 0;
+        if (cfg->has_clip) {
+            PixelWindow box = crop ? *crop : (PixelWindow){0};
+            crop_x = (int)box.x0;
+            crop_y = (int)box.y0;
+            fg = dataf_crop(&c01->fdata, box.x0, box.y0, box.width, box.height);
+            fg_allocated = true;
+        }
+        LOG_INFO("Saving fixed-grid (Float32): %s", outfn);
+        if (!fg.data_in ||
+            write_geotiff_float(outfn, &fg, c01, crop_x, crop_y, c01->product_name, cfg->build_cog) != 0)
+            status = 1;
+        out_w = fg.width;
+        out_h = fg.height;
+        if (fg_allocated) dataf_destroy(&fg);
+        if (!cfg->do_reprojection) {
+            double *gt = c01->geotransform;
+            double h = (c01->proj_info.valid) ? c01->proj_info.sat_height : 35786023.0;
+            double x_min = (gt[0] + crop_x * gt[1]) * h;
+            double y_top = (gt[3] + crop_y * gt[5]) * h;
+            double x_max = x_min + (out_w * gt[1] * h);
+            double y_bot = y_top + (out_h * gt[5] * h);
+            metadata_set_geometry(meta, (float)x_min, (float)fmin(y_top, y_bot),
+                                  (float)x_max, (float)fmax(y_top, y_bot));
+            const char* sat_crs = "geostationary";
+            if (c01->sat_id == SAT_GOES16) sat_crs = "goes16";
+            else if (c01->sat_id == SAT_GOES17) sat_crs = "goes17";
+            else if (c01->sat_id == SAT_GOES18) sat_crs = "goes18";
+            else if (c01->sat_id == SAT_GOES19) sat_crs = "goes19";
+            metadata_set_projection(meta, sat_crs);
+        }
+    }
+
+    char* geo_outfn = NULL;
+    if (status == 0 && cfg->do_reprojection) {
+        DataF geo = reproject_dataf(&c01->fdata, c01, navla->fmin, navla->fmax,
+                                    navlo->fmin, navlo->fmax, c01->native_resolution_km,
+                                    cfg->has_clip ? cfg->clip_coords : NULL);
+        float lon_min = cfg->has_clip ? cfg->clip_coords[0] : navlo->fmin;
+        float lat_max = cfg->has_clip ? cfg->clip_coords[1] : navla->fmax;
+        float lon_max = cfg->has_clip ? cfg->clip_coords[2] : navlo->fmax;
+        float lat_min = cfg->has_clip ? cfg->clip_coords[3] : navla->fmin;
+
+        if (cfg->save_both) {
+            geo_outfn = insert_geo_suffix(outfn);
+            outfn = geo_outfn;
+        }
+        if (!geo.data_in || !outfn) {
+            status = 1;
+        } else {
+            DataNC meta_out = *c01;
+            meta_out.proj_code = PROJ_LATLON;
+            meta_out.proj_info.valid = false;
+            meta_out.geotransform[0] = lon_min;
+            meta_out.geotransform[1] = (lon_max - lon_min) / (double)geo.width;
+            meta_out.geotransform[2] = 0.0;
+            meta_out.geotransform[3] = lat_max;
+            meta_out.geotransform[4] = 0.0;
+            meta_out.geotransform[5] = (lat_min - lat_max) / (double)geo.height;
+            LOG_INFO("Saving reprojected (Float32): %s", outfn);
+            status = write_geotiff_float(outfn, &geo, &meta_out, 0, 0, c01->product_name,
+                                         cfg->build_cog) != 0;
+            out_w = geo.width;
+            out_h = geo.height;
+            metadata_set_geometry(meta, lon_min, lat_min, lon_max, lat_max);
+            metadata_set_projection(meta, "EPSG:4326");
+        }
+        dataf_destroy(&geo);
+    }
+
+    if (status == 0) {
+        metadata_add(meta, "output_file", outfn);
+        metadata_add(meta, "output_width", (int)out_w);
+        metadata_add(meta, "output_height", (int)out_h);
+    }
+    free(geo_outfn);
+    return status;
+}
+
 int run_processing(const ProcessConfig* cfg, MetadataContext* meta) {
     if (!cfg || !meta) {
         LOG_ERROR("run_processing: NULL parameters");
@@ -61,6 +215,8 @@ int run_processing(const ProcessConfig* cfg, MetadataContext* meta) {
     char *palette_name = NULL;
     char *generated_filename = NULL;
     bool nav_loaded = false;
+    PixelWindow win = {0}, clip_box = {0};
+    bool clip_box_found = false;
     bool expr_mode = cfg->is_custom_mode;
     int num_required_channels = 0;
     char* required_channels[17] = {NULL};
@@ -178,16 +334,22 @@ int run_processing(const ProcessConfig* cfg, MetadataContext* meta) {
         }
         free(dir_dup);
         
-        // Load each channel's NetCDF data.
-        for (int i = 0; i < cset->count; i++) {
+        // Load each channel's NetCDF data (overlapped, see load_nc_sf_batch).
+        NCLoadJob jobs[16];
+        const char *job_name[16];
+        int njobs = 0;
+        for (int i = 0; i < cset->count && njobs < 16; i++) {
             int band_id = atoi(cset->channels[i].name + 1);
             if (band_id < 1 || band_id > 16) continue;
             
             LOG_INFO("Loading channel %s", cset->channels[i].name);
-            if (load_nc_sf(cset->channels[i].filename, &channels[band_id]) != 0) {
-                LOG_ERROR("Failed to load channel %s", cset->channels[i].name);
-                channelset_destroy(cset); goto cleanup;
-            }
+            jobs[njobs] = (NCLoadJob){cset->channels[i].filename, NULL, 1, &channels[band_id], 0, 0.0};
+            job_name[njobs++] = cset->channels[i].name;
+        }
+        if (load_nc_sf_batch(jobs, njobs) != 0) {
+            for (int j = 0; j < njobs; j++)
+                if (jobs[j].status != 0) LOG_ERROR("Failed to load channel %s", job_name[j]);
+            channelset_destroy(cset); goto cleanup;
         }
         
         // Identify the reference channel (target resolution).
@@ -248,13 +410,15 @@ int run_processing(const ProcessConfig* cfg, MetadataContext* meta) {
         c01.fdata = result_data;
         c01.is_float = true;
         result_data.data_in = NULL;
+        result_data.spans = NULL;
         channels[ref_channel_idx].fdata.data_in = NULL;
         
         channelset_destroy(cset);
         
     } else {
-        // Normal mode: single channel.
-        if (load_nc_sf(cfg->input_file, &c01) != 0) {
+        // Normal mode: single channel (only the clip window when it is safe).
+        nav_loaded = plan_clip_window(cfg, minmax_provided, &navla_full, &navlo_full, &win);
+        if (load_nc_sf_window(cfg->input_file, nav_loaded ? &win : NULL, &c01) != 0) {
             LOG_ERROR("Could not load: %s", cfg->input_file);
             goto cleanup;
         }
@@ -284,12 +448,21 @@ int run_processing(const ProcessConfig* cfg, MetadataContext* meta) {
     
     LOG_INFO("Output file: %s", outfn);
     
-    // Load navigation if needed for clip, GeoTIFF, or reprojection.
+    // Load navigation if needed for clip, GeoTIFF, or reprojection. A
+    // fixed-grid clip whose box comes from the geometry does not need it.
     bool is_geotiff = cfg->force_geotiff || (outfn && (strstr(outfn, ".tif") || strstr(outfn, ".tiff")));
-    
-    if (cfg->has_clip || is_geotiff || cfg->do_reprojection) {
+    bool fixed_grid_out = cfg->save_both || !cfg->do_reprojection;
+    if (cfg->has_clip && fixed_grid_out)
+        clip_box_found = clip_crop_box(cfg, nav_loaded ? &win : NULL, &c01,
+                                       &navla_full, &navlo_full, &clip_box);
+
+    if ((cfg->has_clip || is_geotiff || cfg->do_reprojection) && !nav_loaded &&
+        (cfg->do_reprojection || !clip_box_found)) {
         if (compute_navigation_nc(cfg->input_file, &navla_full, &navlo_full) == 0) {
             nav_loaded = true;
+            if (cfg->has_clip && fixed_grid_out && !clip_box_found)
+                clip_box_found = clip_crop_box(cfg, NULL, &c01, &navla_full, &navlo_full,
+                                               &clip_box);
         } else {
             LOG_WARN("Could not load navigation.");
             if (is_geotiff) {
@@ -299,6 +472,12 @@ int run_processing(const ProcessConfig* cfg, MetadataContext* meta) {
         }
     }
     
+    if (cfg->float_output) {
+        status = save_float_outputs(cfg, &c01, &navla_full, &navlo_full,
+                                    clip_box_found ? &clip_box : NULL, outfn, meta);
+        goto cleanup;
+    }
+
     // Apply gamma.
     if (fabsf(cfg->gamma[1] - cfg->gamma[0]) > 1e-6f || fabsf(cfg->gamma[2] - cfg->gamma[0]) > 1e-6f) {
         LOG_WARN("Single-channel mode: only gamma[0]=%.2f will be used (ignoring gamma[1]=%.2f, gamma[2]=%.2f)",
@@ -388,17 +567,12 @@ int run_processing(const ProcessConfig* cfg, MetadataContext* meta) {
         unsigned crop_x = 0, crop_y = 0;
 
         // Local crop for the fixed-grid output.
-        if (cfg->has_clip && nav_loaded) {
-            int ix, iy, iw, ih;
-            reprojection_find_bounding_box(&navla_full, &navlo_full, 
-                cfg->clip_coords[0], cfg->clip_coords[1], 
-                cfg->clip_coords[2], cfg->clip_coords[3], 
-                &ix, &iy, &iw, &ih);
-            
-            fg_base = image_crop(&final_image, ix, iy, iw, ih);
+        if (cfg->has_clip && (nav_loaded || clip_box_found)) {
+            fg_base = image_crop(&final_image, clip_box.x0, clip_box.y0,
+                                 clip_box.width, clip_box.height);
             fg_base_allocated = true;
-            crop_x = (unsigned)ix;
-            crop_y = (unsigned)iy;
+            crop_x = clip_box.x0;
+            crop_y = clip_box.y0;
         }
 
         // Local resampling (scale option).
@@ -440,7 +614,7 @@ int run_processing(const ProcessConfig* cfg, MetadataContext* meta) {
         }
 
         // Record fixed-grid geometry in metadata (only if this is the final step).
-        if (nav_loaded && !cfg->do_reprojection) {
+        if ((nav_loaded || clip_box_found) && !cfg->do_reprojection) {
             double *gt = c01.geotransform;
             double h = (c01.proj_info.valid) ? c01.proj_info.sat_height : 35786023.0;
             double x_min = (gt[0] + crop_x * gt[1]) * h;
@@ -490,35 +664,6 @@ int run_processing(const ProcessConfig* cfg, MetadataContext* meta) {
                      "areas outside the disk will be indistinguishable from real data.");
         }
 
-        // Reproject using the original, unaltered image.
-#ifdef HPSV_CUDA
-        ImageData geo_base = cfg->use_cuda
-            ? reproject_image_analytical_cuda(
-                  &final_image, &c01,
-                  navla_full.fmin, navla_full.fmax,
-                  navlo_full.fmin, navlo_full.fmax,
-                  c01.native_resolution_km,
-                  cfg->has_clip ? cfg->clip_coords : NULL,
-                  // gray/pseudocolor no dejan la imagen residente en device.
-                  nodata_pixel, NULL)
-            : reproject_image_analytical(
-                  &final_image, &c01,
-                  navla_full.fmin, navla_full.fmax,
-                  navlo_full.fmin, navlo_full.fmax,
-                  c01.native_resolution_km,
-                  cfg->has_clip ? cfg->clip_coords : NULL,
-                  nodata_pixel);
-#else
-        ImageData geo_base = reproject_image_analytical(
-            &final_image, &c01,
-            navla_full.fmin, navla_full.fmax,
-            navlo_full.fmin, navlo_full.fmax,
-            c01.native_resolution_km,
-            cfg->has_clip ? cfg->clip_coords : NULL,
-            nodata_pixel
-        );
-#endif
-
         float final_lon_min, final_lon_max, final_lat_min, final_lat_max;
         if (cfg->has_clip) {
             final_lon_min = cfg->clip_coords[0]; final_lat_max = cfg->clip_coords[1];
@@ -528,15 +673,6 @@ int run_processing(const ProcessConfig* cfg, MetadataContext* meta) {
             final_lat_min = navla_full.fmin; final_lat_max = navla_full.fmax;
         }
 
-        // Local resampling (scale option).
-        ImageData geo_final = geo_base;
-        bool geo_final_allocated = false;
-        if (cfg->scale != 1) {
-            if (cfg->scale < 0) geo_final = image_downsample_boxfilter(&geo_base, -cfg->scale);
-            else geo_final = image_upsample_bilinear(&geo_base, cfg->scale);
-            geo_final_allocated = true;
-        }
-
         // If running both flows (-B), append a _geo suffix to the filename.
         char *final_outfn = (char*)outfn;
         if (cfg->save_both) {
@@ -546,43 +682,124 @@ int run_processing(const ProcessConfig* cfg, MetadataContext* meta) {
             outfn = generated_filename;
         }
 
-        LOG_INFO("Saving reprojected: %s", outfn);
-
-        if (is_geotiff) {
+        // GeoTIFF at the native resolution, whatever its size: reprojected strip
+        // by strip straight into a tiled file, without ever holding the whole
+        // output. Beyond REPROJ_MAX_DIM the in-memory path can only downscale.
+        ReprojPlan full_plan = {0};
+        if (is_geotiff && cfg->scale == 1 && !cfg->use_cuda)
+            full_plan = reproject_build_plan_full(&final_image, &c01,
+                                                  navla_full.fmin, navla_full.fmax,
+                                                  navlo_full.fmin, navlo_full.fmax,
+                                                  c01.native_resolution_km,
+                                                  cfg->has_clip ? cfg->clip_coords : NULL);
+        if (reproject_stream_wanted(&full_plan)) {
             DataNC meta_out = c01;
             meta_out.proj_code = PROJ_LATLON;
             meta_out.proj_info.valid = false;
             meta_out.geotransform[0] = final_lon_min;
-            meta_out.geotransform[1] = (final_lon_max - final_lon_min) / (double)geo_final.width;
+            meta_out.geotransform[1] = (final_lon_max - final_lon_min) / (double)full_plan.width;
             meta_out.geotransform[2] = 0.0;
             meta_out.geotransform[3] = final_lat_max;
             meta_out.geotransform[4] = 0.0;
-            meta_out.geotransform[5] = (final_lat_min - final_lat_max) / (double)geo_final.height;
+            meta_out.geotransform[5] = (final_lat_min - final_lat_max) / (double)full_plan.height;
+
+            // Pseudocolor con alfa sale en RGBA; sin alfa, indexado con su tabla.
+            const bool indexed = is_pseudocolor && color_array;
+            int bands = (int)final_image.bpp;
+            if (indexed && cfg->use_alpha) bands = final_image.bpp == 2 ? 4 : 3;
+
+            LOG_INFO("Saving reprojected (streamed): %s", outfn);
+            GeoTiffStream *gts = geotiff_stream_open(outfn, (int)full_plan.width,
+                                                     (int)full_plan.height, bands, &meta_out,
+                                                     indexed ? color_array : NULL,
+                                                     indexed && !cfg->use_alpha ? &colormap_meta : NULL,
+                                                     meta_out.product_name, cfg->build_cog);
+            if (!gts) goto cleanup;
+            int rc = reproject_image_strips(&final_image, &full_plan, nodata_pixel,
+                                            geotiff_stream_strip, gts);
+            if (geotiff_stream_close(gts) != 0 || rc != 0) {
+                LOG_ERROR("Failure during streamed reprojection.");
+                goto cleanup;
+            }
+            final_w = full_plan.width;
+            final_h = full_plan.height;
+        } else {
+            // Reproject using the original, unaltered image.
+#ifdef HPSV_CUDA
+            ImageData geo_base = cfg->use_cuda
+                ? reproject_image_analytical_cuda(
+                      &final_image, &c01,
+                      navla_full.fmin, navla_full.fmax,
+                      navlo_full.fmin, navlo_full.fmax,
+                      c01.native_resolution_km,
+                      cfg->has_clip ? cfg->clip_coords : NULL,
+                      // gray/pseudocolor no dejan la imagen residente en device.
+                      nodata_pixel, NULL)
+                : reproject_image_analytical(
+                      &final_image, &c01,
+                      navla_full.fmin, navla_full.fmax,
+                      navlo_full.fmin, navlo_full.fmax,
+                      c01.native_resolution_km,
+                      cfg->has_clip ? cfg->clip_coords : NULL,
+                      nodata_pixel);
+#else
+            ImageData geo_base = reproject_image_analytical(
+                &final_image, &c01,
+                navla_full.fmin, navla_full.fmax,
+                navlo_full.fmin, navlo_full.fmax,
+                c01.native_resolution_km,
+                cfg->has_clip ? cfg->clip_coords : NULL,
+                nodata_pixel
+            );
+#endif
 
-            if (is_pseudocolor && color_array) {
-                if (cfg->use_alpha) {
-                    temp_image = image_expand_palette(&geo_final, color_array);
-                    write_geotiff_rgb(outfn, &temp_image, &meta_out, 0, 0, meta_out.product_name, cfg->build_cog);
-                    image_destroy(&temp_image);
+            // Local resampling (scale option).
+            ImageData geo_final = geo_base;
+            bool geo_final_allocated = false;
+            if (cfg->scale != 1) {
+                if (cfg->scale < 0) geo_final = image_downsample_boxfilter(&geo_base, -cfg->scale);
+                else geo_final = image_upsample_bilinear(&geo_base, cfg->scale);
+                geo_final_allocated = true;
+            }
+
+            LOG_INFO("Saving reprojected: %s", outfn);
+
+            if (is_geotiff) {
+                DataNC meta_out = c01;
+                meta_out.proj_code = PROJ_LATLON;
+                meta_out.proj_info.valid = false;
+                meta_out.geotransform[0] = final_lon_min;
+                meta_out.geotransform[1] = (final_lon_max - final_lon_min) / (double)geo_final.width;
+                meta_out.geotransform[2] = 0.0;
+                meta_out.geotransform[3] = final_lat_max;
+                meta_out.geotransform[4] = 0.0;
+                meta_out.geotransform[5] = (final_lat_min - final_lat_max) / (double)geo_final.height;
+
+                if (is_pseudocolor && color_array) {
+                    if (cfg->use_alpha) {
+                        temp_image = image_expand_palette(&geo_final, color_array);
+                        write_geotiff_rgb(outfn, &temp_image, &meta_out, 0, 0, meta_out.product_name, cfg->build_cog);
+                        image_destroy(&temp_image);
+                    } else {
+                        write_geotiff_indexed(outfn, &geo_final, color_array, &meta_out, 0, 0, &colormap_meta, meta_out.product_name, cfg->build_cog);
+                    }
                 } else {
-                    write_geotiff_indexed(outfn, &geo_final, color_array, &meta_out, 0, 0, &colormap_meta, meta_out.product_name, cfg->build_cog);
+                    write_geotiff_gray(outfn, &geo_final, &meta_out, 0, 0, meta_out.product_name, cfg->build_cog);
                 }
             } else {
-                write_geotiff_gray(outfn, &geo_final, &meta_out, 0, 0, meta_out.product_name, cfg->build_cog);
+                if (is_pseudocolor && color_array) writer_save_png_palette(outfn, &geo_final, color_array);
+                else writer_save_png(outfn, &geo_final);
             }
-        } else {
-            if (is_pseudocolor && color_array) writer_save_png_palette(outfn, &geo_final, color_array);
-            else writer_save_png(outfn, &geo_final);
+
+            final_w = geo_final.width;
+            final_h = geo_final.height;
+
+            if (geo_final_allocated) image_destroy(&geo_final);
+            image_destroy(&geo_base);
         }
 
         metadata_set_geometry(meta, final_lon_min, final_lat_min, final_lon_max, final_lat_max);
         metadata_set_projection(meta, "EPSG:4326");
-
-        final_w = geo_final.width;
-        final_h = geo_final.height;
-
-        if (geo_final_allocated) image_destroy(&geo_final);
-        image_destroy(&geo_base);
     }
 
     metadata_add(meta, "output_file", outfn);
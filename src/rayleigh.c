@@ -51,32 +51,198 @@ static void enforce_resolution(DataF *data, unsigned int target_w, unsigned int
     }
 }
 
+static void lattice_destroy(RayleighLattice *l) {
+    if (!l) return;
+    free(l->ang);
+    free(l->cell_block);
+    free(l->blocks);
+    free(l);
+}
+
 void rayleigh_free_navigation(RayleighNav *nav) {
     if (nav) {
         dataf_destroy(&nav->sza);
         dataf_destroy(&nav->vza);
         dataf_destroy(&nav->raa);
+        lattice_destroy(nav->coarse);
+        nav->coarse = NULL;
     }
 }
 
-bool rayleigh_load_navigation_from_latlon(const char *filename,
-                                          const DataF *navla, const DataF *navlo,
-                                          RayleighNav *nav,
-                                          unsigned int target_width, unsigned int target_height) {
-    nav->sza.data_in = NULL;
-    nav->vza.data_in = NULL;
-    nav->raa.data_in = NULL;
+/* ---- Coarse geometry (HPSV_COARSE_GEOMETRY=<step>) ----
+ * SZA, VZA and RAA are smooth over the disk: at 2 km the solar zenith moves
+ * about 0.02 deg per pixel. Solving them every `step` pixels and interpolating
+ * in the kernels replaces five full float grids (sza, saa, vza, vaa, raa) and
+ * their per-pixel trigonometry with a lattice of ~1/step^2 the points. Two
+ * places are not smooth: the limb, where lattice corners fall off the disk,
+ * and the subsolar and sub-satellite points, where the azimuths turn around
+ * and RAA folds. Cells there are solved pixel by pixel into a side block. */
+
+/// Cells whose corners differ by more than this (deg) in any angle go exact.
+#define COARSE_MAX_SPREAD 5.0f
+
+/// Lattice pitch in pixels; 0 = full grids (default).
+static unsigned int coarse_geometry_step(void) {
+    const char *env = getenv("HPSV_COARSE_GEOMETRY");
+    if (!env || !*env) return 0;
+    long step = strtol(env, NULL, 10);
+    if (step < 2) return 0;
+    return step > 256 ? 256 : (unsigned int)step;
+}
 
-    DataF la = *navla, lo = *navlo;  // shallow copy; data not freed here
+// Pixel coordinate of lattice point k on an axis of n pixels.
+static inline unsigned int lattice_pos(unsigned int k, unsigned int step, unsigned int n) {
+    size_t p = (size_t)k * step;
+    return p < n - 1 ? (unsigned int)p : n - 1;
+}
+
+// RAYLEIGH_CELL_LERP, RAYLEIGH_CELL_OFF, or 0 when the cell must be solved exactly.
+static int32_t classify_cell(const RayleighLattice *l, const DataF *navla, unsigned int cx,
+                             unsigned int cy) {
+    const float *c[4] = {l->ang + ((size_t)cy * l->lw + cx) * 3,
+                         l->ang + ((size_t)cy * l->lw + cx + 1) * 3,
+                         l->ang + ((size_t)(cy + 1) * l->lw + cx) * 3,
+                         l->ang + ((size_t)(cy + 1) * l->lw + cx + 1) * 3};
+    bool any_off = false;
+    for (int j = 0; j < 4; j++)
+        any_off |= IS_NONDATA(c[j][0]);
+    if (any_off) {
+        // Off the disk only if no pixel of the cell has navigation.
+        const unsigned int w = l->width, step = l->step;
+        unsigned int x0 = lattice_pos(cx, step, w), x1 = lattice_pos(cx + 1, step, w);
+        unsigned int y0 = lattice_pos(cy, step, l->height), y1 = lattice_pos(cy + 1, step, l->height);
+        for (unsigned int y = y0; y <= y1; y++)
+            for (unsigned int x = x0; x <= x1; x++)
+                if (!IS_NONDATA(navla->data_in[(size_t)y * w + x]))
+                    return 0;
+        return RAYLEIGH_CELL_OFF;
+    }
+    for (int k = 0; k < 3; k++) {
+        float lo = c[0][k], hi = c[0][k];
+        for (int j = 1; j < 4; j++) {
+            if (c[j][k] < lo) lo = c[j][k];
+            if (c[j][k] > hi) hi = c[j][k];
+        }
+        if (hi - lo > COARSE_MAX_SPREAD) return 0;
+    }
+    return RAYLEIGH_CELL_LERP;
+}
+
+static RayleighLattice *build_lattice(const char *filename, const DataF *navla,
+                                      const DataF *navlo, unsigned int step) {
+    ViewEphemeris eph;
+    if (reader_view_ephemeris_from_file(filename, &eph) != 0)
+        return NULL;
+
+    const unsigned int w = navla->width, h = navla->height;
+    RayleighLattice *l = calloc(1, sizeof(*l));
+    if (!l) return NULL;
+    l->width = w;
+    l->height = h;
+    l->step = step;
+    l->lw = (w - 2) / step + 2;
+    l->lh = (h - 2) / step + 2;
+    l->inv_step = 1.0f / (float)step;
+    l->inv_last_x = 1.0f / (float)(w - 1 - (l->lw - 2) * step);
+    l->inv_last_y = 1.0f / (float)(h - 1 - (l->lh - 2) * step);
+    const size_t ncells = (size_t)(l->lw - 1) * (l->lh - 1);
+    l->ang = malloc((size_t)l->lw * l->lh * 3 * sizeof(float));
+    l->cell_block = malloc(ncells * sizeof(int32_t));
+    if (!l->ang || !l->cell_block) {
+        lattice_destroy(l);
+        return NULL;
+    }
+
+    double start_time = omp_get_wtime();
+    #pragma omp parallel for
+    for (unsigned int ky = 0; ky < l->lh; ky++) {
+        size_t row = (size_t)lattice_pos(ky, step, h) * w;
+        for (unsigned int kx = 0; kx < l->lw; kx++) {
+            size_t i = row + lattice_pos(kx, step, w);
+            float *a = l->ang + ((size_t)ky * l->lw + kx) * 3;
+            compute_view_geometry_at(navla->data_in[i], navlo->data_in[i], &eph,
+                                     &a[0], &a[1], &a[2]);
+        }
+    }
 
+    // Classify the cells, number the exact ones, then solve their pixels.
+    #pragma omp parallel for
+    for (size_t c = 0; c < ncells; c++)
+        l->cell_block[c] = classify_cell(l, navla, c % (l->lw - 1), c / (l->lw - 1));
+    int32_t nblocks = 0;
+    for (size_t c = 0; c < ncells; c++)
+        if (l->cell_block[c] >= 0)
+            l->cell_block[c] = nblocks++;
+    const size_t side = step + 1;
+    if (nblocks > 0) {
+        l->blocks = malloc((size_t)nblocks * side * side * 3 * sizeof(float));
+        if (!l->blocks) {
+            lattice_destroy(l);
+            return NULL;
+        }
+    }
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t c = 0; c < ncells; c++) {
+        int32_t b = l->cell_block[c];
+        if (b < 0) continue;
+        unsigned int cx = c % (l->lw - 1), cy = c / (l->lw - 1);
+        unsigned int x0 = lattice_pos(cx, step, w), x1 = lattice_pos(cx + 1, step, w);
+        unsigned int y0 = lattice_pos(cy, step, h), y1 = lattice_pos(cy + 1, step, h);
+        for (unsigned int y = y0; y <= y1; y++) {
+            for (unsigned int x = x0; x <= x1; x++) {
+                size_t i = (size_t)y * w + x;
+                float *p = l->blocks + (((size_t)b * side + (y - y0)) * side + (x - x0)) * 3;
+                compute_view_geometry_at(navla->data_in[i], navlo->data_in[i], &eph,
+                                         &p[0], &p[1], &p[2]);
+            }
+        }
+    }
+    double elapsed = omp_get_wtime() - start_time;
+
+    // Largest interpolation error against the exact geometry, at the centre of
+    // every interpolated cell (where bilinear error peaks).
+    RayleighNav probe = {.coarse = l};
+    float err_sza = 0.0f, err_vza = 0.0f, err_raa = 0.0f;
+    #pragma omp parallel for reduction(max:err_sza, err_vza, err_raa)
+    for (size_t c = 0; c < ncells; c++) {
+        if (l->cell_block[c] != RAYLEIGH_CELL_LERP) continue;
+        unsigned int cx = c % (l->lw - 1), cy = c / (l->lw - 1);
+        unsigned int x0 = lattice_pos(cx, step, w), x1 = lattice_pos(cx + 1, step, w);
+        unsigned int y0 = lattice_pos(cy, step, h), y1 = lattice_pos(cy + 1, step, h);
+        unsigned int x = x0 + (x1 - x0) / 2, y = y0 + (y1 - y0) / 2;
+        size_t i = (size_t)y * w + x;
+        float e[3], g[3];
+        compute_view_geometry_at(navla->data_in[i], navlo->data_in[i], &eph,
+                                 &e[0], &e[1], &e[2]);
+        if (IS_NONDATA(e[0])) continue;
+        rayleigh_nav_at(&probe, x, y, g);
+        err_sza = fmaxf(err_sza, fabsf(g[0] - e[0]));
+        err_vza = fmaxf(err_vza, fabsf(g[1] - e[1]));
+        err_raa = fmaxf(err_raa, fabsf(g[2] - e[2]));
+    }
+
+    LOG_INFO("Coarse geometry every %u px: %ux%u lattice, %d of %zu cells exact "
+             "(%.1f MB instead of %.1f MB)", step, l->lw, l->lh, (int)nblocks, ncells,
+             ((double)l->lw * l->lh * 3 + (double)nblocks * side * side * 3) * sizeof(float) / 1e6,
+             (double)w * h * 5 * sizeof(float) / 1e6);
+    LOG_INFO("Coarse geometry max error vs exact (cell centres): SZA %.4f, VZA %.4f, RAA %.4f deg",
+             err_sza, err_vza, err_raa);
+    LOG_TIMING(elapsed, "Coarse viewing geometry");
+    return l;
+}
+
+// Solar angles, satellite angles and their relative azimuth as three passes
+// (HPSV_NO_FUSED_GEOMETRY), materializing SAA and VAA on the way.
+static bool load_geometry_three_pass(const char *filename, const DataF *la, const DataF *lo,
+                                     RayleighNav *nav) {
     DataF saa = {0};
-    if (compute_solar_angles_nc(filename, &la, &lo, &nav->sza, &saa) != 0) {
+    if (compute_solar_angles_nc(filename, la, lo, &nav->sza, &saa) != 0) {
         LOG_ERROR("Failed to compute solar angles.");
         return false;
     }
 
     DataF vaa = {0};
-    if (compute_satellite_angles_nc(filename, &la, &lo, &nav->vza, &vaa) != 0) {
+    if (compute_satellite_angles_nc(filename, la, lo, &nav->vza, &vaa) != 0) {
         LOG_ERROR("Failed to compute satellite angles.");
         dataf_destroy(&saa); dataf_destroy(&nav->sza);
         return false;
@@ -86,6 +252,40 @@ bool rayleigh_load_navigation_from_latlon(const char *filename,
     dataf_destroy(&saa);
     dataf_destroy(&vaa);
 
+    return true;
+}
+
+bool rayleigh_load_navigation_from_latlon(const char *filename,
+                                          const DataF *navla, const DataF *navlo,
+                                          RayleighNav *nav,
+                                          unsigned int target_width, unsigned int target_height) {
+    nav->sza.data_in = NULL;
+    nav->vza.data_in = NULL;
+    nav->raa.data_in = NULL;
+    nav->sza.spans = nav->vza.spans = nav->raa.spans = NULL;
+    nav->coarse = NULL;
+
+    // The lattice indexes the lat/lon grid itself: only without resampling.
+    unsigned int step = coarse_geometry_step();
+    if (step > 0 && navla->width >= 2 && navla->height >= 2 &&
+        (target_width == 0 || (navla->width == target_width && navla->height == target_height))) {
+        nav->coarse = build_lattice(filename, navla, navlo, step);
+        if (nav->coarse)
+            return true;
+        LOG_WARN("Coarse geometry failed; computing the full grids.");
+    }
+
+    DataF la = *navla, lo = *navlo;  // shallow copy; data not freed here
+
+    if (!getenv("HPSV_NO_FUSED_GEOMETRY")) {
+        if (compute_view_geometry_nc(filename, &la, &lo, &nav->sza, &nav->vza, &nav->raa) != 0) {
+            LOG_ERROR("Failed to compute viewing geometry.");
+            return false;
+        }
+    } else if (!load_geometry_three_pass(filename, &la, &lo, nav)) {
+        return false;
+    }
+
     if (!nav->sza.data_in || !nav->vza.data_in || !nav->raa.data_in) {
         rayleigh_free_navigation(nav);
         return false;
@@ -110,6 +310,8 @@ bool rayleigh_load_navigation(const char *filename, RayleighNav *nav,
     nav->sza.data_in = NULL;
     nav->vza.data_in = NULL;
     nav->raa.data_in = NULL;
+    nav->sza.spans = nav->vza.spans = nav->raa.spans = NULL;
+    nav->coarse = NULL;
 
     // Compute lat/lon navigation needed for angle calculations.
     DataF navla = {0}, navlo = {0};
@@ -172,19 +374,18 @@ void analytic_rayleigh_correction(DataF *band, const RayleighNav *nav, float lam
         return;
     }
 
-    const DataF *sza = &nav->sza;
-    const DataF *vza = &nav->vza;
-    const DataF *raa = &nav->raa;
-
-    if (!sza->data_in || !vza->data_in || !raa->data_in) {
+    if (!nav->coarse && (!nav->sza.data_in || !nav->vza.data_in || !nav->raa.data_in)) {
         LOG_ERROR("Incomplete navigation data in RayleighNav");
         return;
     }
 
-    if (sza->size != band->size)
-        LOG_WARN("Navigation size (%zu) does not match band size (%zu).", sza->size, band->size);
+    if (rayleigh_nav_width(nav) != band->width || rayleigh_nav_height(nav) != band->height) {
+        LOG_ERROR("Navigation size (%ux%u) does not match band size (%ux%u).",
+                  rayleigh_nav_width(nav), rayleigh_nav_height(nav), band->width, band->height);
+        return;
+    }
 
-    size_t n = band->size;
+    const unsigned int w = band->width;
 
     float tau_r = (float)calc_bucholtz_tau(lambda_um);
     
@@ -197,45 +398,48 @@ void analytic_rayleigh_correction(DataF *band, const RayleighNav *nav, float lam
     double sum_orig = 0, sum_corr = 0;
 
     #pragma omp parallel for reduction(+:valid_pixels, clamped_pixels, sum_orig, sum_corr)
-    for (size_t i = 0; i < n; i++) {
-        float val = band->data_in[i];
-
-        if (IS_NONDATA(val)) {
-            band->data_in[i] = NonData;
-            continue;
-        }
+    for (unsigned int y = 0; y < band->height; y++) {
+        for (unsigned int x = 0; x < w; x++) {
+            size_t i = (size_t)y * w + x;
+            float val = band->data_in[i];
+
+            if (IS_NONDATA(val)) {
+                band->data_in[i] = NonData;
+                continue;
+            }
 
-        float sza_val = sza->data_in[i];
-        float vza_val = vza->data_in[i];
+            float geom[3];
+            rayleigh_nav_at(nav, x, y, geom);
         
-        float theta_s = sza_val * (float)(M_PI / 180.0);
-        float theta_v = vza_val * (float)(M_PI / 180.0);
-        float phi_rel = raa->data_in[i] * (float)(M_PI / 180.0);
+            float theta_s = geom[0] * (float)(M_PI / 180.0);
+            float theta_v = geom[1] * (float)(M_PI / 180.0);
+            float phi_rel = geom[2] * (float)(M_PI / 180.0);
 
-        float mu_s = cosf(theta_s);
-        float mu_v = cosf(theta_v);
+            float mu_s = cosf(theta_s);
+            float mu_v = cosf(theta_v);
 
-        if (mu_s < 0.01f || mu_v < 0.01f) {
-            band->data_in[i] = val;
-            continue;
-        }
+            if (mu_s < 0.01f || mu_v < 0.01f) {
+                band->data_in[i] = val;
+                continue;
+            }
 
-        // Scattering angle cosine, Rayleigh phase function, and path-corrected reflectance.
-        float cos_scat = -mu_s * mu_v + sinf(theta_s) * sinf(theta_v) * cosf(phi_rel);
-        float P_ray = calc_bucholtz_phase(cos_scat);
-        float rho_ray = (tau_r * P_ray) / (4.0f * mu_s * mu_v);
-        float corrected = val - rho_ray;
+            // Scattering angle cosine, Rayleigh phase function, and path-corrected reflectance.
+            float cos_scat = -mu_s * mu_v + sinf(theta_s) * sinf(theta_v) * cosf(phi_rel);
+            float P_ray = calc_bucholtz_phase(cos_scat);
+            float rho_ray = (tau_r * P_ray) / (4.0f * mu_s * mu_v);
+            float corrected = val - rho_ray;
 
-        sum_orig += val;
-        valid_pixels++;
+            sum_orig += val;
+            valid_pixels++;
 
-        if (corrected < 0.0f) {
-            corrected = 0.0001f;
-            clamped_pixels++;
-        }
-        sum_corr += corrected;
+            if (corrected < 0.0f) {
+                corrected = 0.0001f;
+                clamped_pixels++;
+            }
+            sum_corr += corrected;
 
-        band->data_in[i] = corrected;
+            band->data_in[i] = corrected;
+        }
     }
 
     double end_time = omp_get_wtime();
@@ -252,10 +456,21 @@ void analytic_rayleigh_correction(DataF *band, const RayleighNav *nav, float lam
 /*********  LUT-based Rayleigh correction  **********/
 
 /**
- * Trilinear interpolation into a Rayleigh LUT.
+ * Trilinear cell of one viewing geometry: the four [sz][vz] row offsets and the
+ * two azimuth indices of the surrounding cube, plus the fractional weights.
+ * It depends only on the LUT axes, so bands whose tables share them reuse it.
+ */
+typedef struct {
+    int row[4];        ///< s0v0, s0v1, s1v0, s1v1 offsets into the flat table
+    int a0, a1;
+    float ds, dv, da;
+} RayleighCell;
+
+/**
+ * Locates a geometry in the LUT axes.
  * Inputs are solar zenith secant (s), view zenith secant (v), and relative azimuth in degrees (a).
  */
-static inline float get_rayleigh_value(const RayleighLUT *lut, float s, float v, float a) {
+static inline void rayleigh_cell(const RayleighLUT *lut, float s, float v, float a, RayleighCell *c) {
     // Clamp all three axes to the LUT range.
     if (s < lut->sz_min) s = lut->sz_min;
     if (s >= lut->sz_max) s = lut->sz_max;
@@ -285,27 +500,35 @@ static inline float get_rayleigh_value(const RayleighLUT *lut, float s, float v,
     int a1 = a0 + 1; if (a1 >= lut->n_az) a1 = lut->n_az - 1;
 
     // Fractional weights.
-    float ds = idx_s - s0;
-    float dv = idx_v - v0;
-    float da = idx_a - a0;
+    c->ds = idx_s - s0;
+    c->dv = idx_v - v0;
+    c->da = idx_a - a0;
 
     // Strides for the flat [SolarZenith][ViewZenith][Azimuth] layout.
     int stride_v = lut->n_az;
     int stride_s = lut->n_vz * lut->n_az;
+    c->row[0] = s0 * stride_s + v0 * stride_v;
+    c->row[1] = s0 * stride_s + v1 * stride_v;
+    c->row[2] = s1 * stride_s + v0 * stride_v;
+    c->row[3] = s1 * stride_s + v1 * stride_v;
+    c->a0 = a0;
+    c->a1 = a1;
+}
 
-    float *t = lut->table;
-
+/// Trilinear interpolation of one table over a cell from rayleigh_cell().
+static inline float rayleigh_cell_value(const float *t, const RayleighCell *c) {
     // Fetch the 8 surrounding cube corners.
-    float c000 = t[s0 * stride_s + v0 * stride_v + a0];
-    float c001 = t[s0 * stride_s + v0 * stride_v + a1];
-    float c010 = t[s0 * stride_s + v1 * stride_v + a0];
-    float c011 = t[s0 * stride_s + v1 * stride_v + a1];
-    float c100 = t[s1 * stride_s + v0 * stride_v + a0];
-    float c101 = t[s1 * stride_s + v0 * stride_v + a1];
-    float c110 = t[s1 * stride_s + v1 * stride_v + a0];
-    float c111 = t[s1 * stride_s + v1 * stride_v + a1];
+    float c000 = t[c->row[0] + c->a0];
+    float c001 = t[c->row[0] + c->a1];
+    float c010 = t[c->row[1] + c->a0];
+    float c011 = t[c->row[1] + c->a1];
+    float c100 = t[c->row[2] + c->a0];
+    float c101 = t[c->row[2] + c->a1];
+    float c110 = t[c->row[3] + c->a0];
+    float c111 = t[c->row[3] + c->a1];
 
     // 8-corner trilinear interpolation.
+    float da = c->da, dv = c->dv, ds = c->ds;
     float c00 = c000 * (1.0f - da) + c001 * da;
     float c01 = c010 * (1.0f - da) + c011 * da;
     float c10 = c100 * (1.0f - da) + c101 * da;
@@ -410,128 +633,226 @@ void rayleigh_lut_destroy(RayleighLUT *lut) {
 }
 
 
+static bool lut_axes_equal(const RayleighLUT *a, const RayleighLUT *b) {
+    return a->n_sz == b->n_sz && a->n_vz == b->n_vz && a->n_az == b->n_az &&
+           a->sz_min == b->sz_min && a->sz_max == b->sz_max && a->sz_step == b->sz_step &&
+           a->vz_min == b->vz_min && a->vz_max == b->vz_max && a->vz_step == b->vz_step &&
+           a->az_min == b->az_min && a->az_max == b->az_max && a->az_step == b->az_step;
+}
+
 void luts_rayleigh_correction(DataF *img, const RayleighNav *nav, const uint8_t channel, const DataF *redband) {
-    if (img->width != nav->sza.width || img->height != nav->sza.height) {
-        LOG_ERROR("Dimension mismatch in Rayleigh Analytic: Img %dx%d vs Nav %dx%d",
-                  img->width, img->height, nav->sza.width, nav->sza.height);
+    luts_rayleigh_correction_bands(&img, &channel, &redband, 1, nav);
+}
+
+void luts_rayleigh_correction_bands(DataF *const *imgs, const uint8_t *channels,
+                                    const DataF *const *redbands, int n, const RayleighNav *nav) {
+    if (n <= 0 || n > RAYLEIGH_MAX_BANDS) {
+        LOG_ERROR("Rayleigh LUT: %d bands requested (1..%d)", n, RAYLEIGH_MAX_BANDS);
+        return;
+    }
+    DataF *img[RAYLEIGH_MAX_BANDS];
+    const DataF *redband[RAYLEIGH_MAX_BANDS];
+    RayleighLUT lut[RAYLEIGH_MAX_BANDS];
+    const float *table[RAYLEIGH_MAX_BANDS];
+    for (int b = 0; b < n; b++) {
+        img[b] = imgs[b];
+        redband[b] = redbands ? redbands[b] : NULL;
+        if (img[b]->width != rayleigh_nav_width(nav) || img[b]->height != rayleigh_nav_height(nav)) {
+            LOG_ERROR("Dimension mismatch in Rayleigh Analytic: Img %dx%d vs Nav %dx%d",
+                      img[b]->width, img[b]->height, rayleigh_nav_width(nav),
+                      rayleigh_nav_height(nav));
+            return;
+        }
+        if (redband[b] && redband[b]->data_in && redband[b]->size != img[b]->size) {
+            LOG_WARN("Redband size mismatch (%zu vs %zu), disabling cloud relaxation",
+                     redband[b]->size, img[b]->size);
+            redband[b] = NULL;
+        }
+    }
+    if (n > 1 && getenv("HPSV_NO_SHARED_RAYLEIGH")) {
+        for (int b = 0; b < n; b++)
+            luts_rayleigh_correction(img[b], nav, channels[b], redband[b]);
         return;
     }
-    if (redband && redband->data_in && redband->size != img->size) {
-        LOG_WARN("Redband size mismatch (%zu vs %zu), disabling cloud relaxation",
-                 redband->size, img->size);
-        redband = NULL;
+    for (int b = 0; b < n; b++) {
+        lut[b] = rayleigh_lut_load_from_memory(channels[b]);
+        table[b] = lut[b].table;
+    }
+    // The cell is located on the axes of the first table; one with other axes
+    // (none of the embedded ones) is corrected on its own.
+    for (int b = 1; b < n; b++) {
+        if (!lut_axes_equal(&lut[0], &lut[b])) {
+            for (int k = 0; k < n; k++)
+                rayleigh_lut_destroy(&lut[k]);
+            for (int k = 0; k < n; k++)
+                luts_rayleigh_correction(img[k], nav, channels[k], redband[k]);
+            return;
+        }
+    }
+    for (int b = 0; b < n; b++) {
+        if (!table[b]) {
+            for (int k = 0; k < n; k++)
+                rayleigh_lut_destroy(&lut[k]);
+            return;
+        }
     }
-    RayleighLUT lut = rayleigh_lut_load_from_memory(channel);
 
-    size_t n = img->size;
     double start_time = omp_get_wtime();
     
-    // Diagnostic statistics.
-    size_t night_pixels = 0;
-    size_t negative_pixels = 0;
-    size_t valid_pixels = 0;
-    double sum_original = 0.0;
-    double sum_rayleigh = 0.0;
-    double sum_corrected = 0.0;
-    float max_rayleigh = 0.0f;
-    float min_original = 1e9;
-    float max_original = -1e9;
+    // Diagnostic statistics, per band.
+    size_t night_pixels[RAYLEIGH_MAX_BANDS] = {0};
+    size_t negative_pixels[RAYLEIGH_MAX_BANDS] = {0};
+    size_t valid_pixels[RAYLEIGH_MAX_BANDS] = {0};
+    double sum_original[RAYLEIGH_MAX_BANDS] = {0};
+    double sum_rayleigh[RAYLEIGH_MAX_BANDS] = {0};
+    double sum_corrected[RAYLEIGH_MAX_BANDS] = {0};
+    float max_rayleigh[RAYLEIGH_MAX_BANDS] = {0};
+    float min_original[RAYLEIGH_MAX_BANDS] = {1e9, 1e9, 1e9};
+    float max_original[RAYLEIGH_MAX_BANDS] = {-1e9, -1e9, -1e9};
 
     // OpenMP parallelization; static schedule is optimal since per-pixel cost is uniform.
-    #pragma omp parallel for schedule(static) reduction(+:night_pixels,negative_pixels,valid_pixels,sum_original,sum_rayleigh,sum_corrected) reduction(max:max_rayleigh,max_original) reduction(min:min_original)
-    for (size_t i = 0; i < n; i++) {
-        float theta_s = nav->sza.data_in[i];
-        float original = img->data_in[i];
-
-        if (IS_NONDATA(original)) {
-            continue;
-        }
-        
-        if (original < min_original) min_original = original;
-        if (original > max_original) max_original = original;
-
-        // Skip nighttime/twilight pixels (SZA > 88°); mask to 0.
-        // 88° instead of 85° to allow correction in twilight zone.
-        if (theta_s > 88.0f || IS_NONDATA(theta_s) || theta_s < 0.0f) {
-            img->data_in[i] = 0.0f;
-            night_pixels++;
-            continue;
+    // Rows run over the spans of the bands only: NonData pixels are left as they are.
+    // The geometry (secants, azimuth fold, LUT cell) is solved once per pixel
+    // and serves every band; each band's redband is read before any band of
+    // the pixel is written, so C01 relaxes on the uncorrected C02 as before.
+    const unsigned int w = img[0]->width;
+    #pragma omp parallel for schedule(static) reduction(+:night_pixels[:n],negative_pixels[:n],valid_pixels[:n],sum_original[:n],sum_rayleigh[:n],sum_corrected[:n]) reduction(max:max_rayleigh[:n],max_original[:n]) reduction(min:min_original[:n])
+    for (unsigned int y = 0; y < img[0]->height; y++) {
+        unsigned int x0 = w, x1 = 0;
+        for (int b = 0; b < n; b++) {
+            unsigned int bx0, bx1;
+            dataf_row_span(img[b], y, &bx0, &bx1);
+            if (bx0 < bx1) {
+                if (bx0 < x0) x0 = bx0;
+                if (bx1 > x1) x1 = bx1;
+            }
         }
+        for (unsigned int x = x0; x < x1; x++) {
+            size_t i = (size_t)y * w + x;
+            float geom[3];
+            rayleigh_nav_at(nav, x, y, geom);
+            float theta_s = geom[0];
+            float original[RAYLEIGH_MAX_BANDS];
+            float rb[RAYLEIGH_MAX_BANDS];
+            bool any = false;
+            for (int b = 0; b < n; b++) {
+                original[b] = img[b]->data_in[i];
+                rb[b] = redband[b] && redband[b]->data_in ? redband[b]->data_in[i] : NonData;
+                if (IS_NONDATA(original[b]))
+                    continue;
+                any = true;
+                if (original[b] < min_original[b]) min_original[b] = original[b];
+                if (original[b] > max_original[b]) max_original[b] = original[b];
+            }
+            if (!any)
+                continue;
+
+            // Skip nighttime/twilight pixels (SZA > 88°); mask to 0.
+            // 88° instead of 85° to allow correction in twilight zone.
+            if (theta_s > 88.0f || IS_NONDATA(theta_s) || theta_s < 0.0f) {
+                for (int b = 0; b < n; b++) {
+                    if (IS_NONDATA(original[b]))
+                        continue;
+                    img[b]->data_in[i] = 0.0f;
+                    night_pixels[b]++;
+                }
+                continue;
+            }
 
-        // Clamp angles to LUT valid range (matching pyspectral convention).
-        // SZA max = arccos(1/24.75) = 87.68°;  VZA max = arccos(1/3.0) = 70.53°
-        float sza_clipped = theta_s;
-        if (sza_clipped > 87.68f) sza_clipped = 87.68f;
-        if (sza_clipped < 0.0f) sza_clipped = 0.0f;
-        
-        float vza_clipped = nav->vza.data_in[i];
-        if (vza_clipped > 70.53f) vza_clipped = 70.53f;
-        if (vza_clipped < 0.0f) vza_clipped = 0.0f;
-        
-        float theta_s_sec = 1.0f / cosf(sza_clipped * M_PI / 180.0f);
-        float vza_sec = 1.0f / cosf(vza_clipped * M_PI / 180.0f);
-        
-        float r_corr = get_rayleigh_value(&lut, theta_s_sec, vza_sec, nav->raa.data_in[i]);
+            // Clamp angles to LUT valid range (matching pyspectral convention).
+            // SZA max = arccos(1/24.75) = 87.68°;  VZA max = arccos(1/3.0) = 70.53°
+            float sza_clipped = theta_s;
+            if (sza_clipped > 87.68f) sza_clipped = 87.68f;
+            if (sza_clipped < 0.0f) sza_clipped = 0.0f;
         
-        // Taper correction linearly for SZA 70°-88° to avoid over-correction near the day/night terminator (matches satpy/pyspectral).
-        if (theta_s > 70.0f) {
-            float reduce_factor = 1.0f - (theta_s - 70.0f) / (88.0f - 70.0f);
-            if (reduce_factor < 0.0f) reduce_factor = 0.0f;
-            r_corr *= reduce_factor;
-        }
+            float vza_clipped = geom[1];
+            if (vza_clipped > 70.53f) vza_clipped = 70.53f;
+            if (vza_clipped < 0.0f) vza_clipped = 0.0f;
         
-        // Relax correction over bright clouds (matching pyspectral): reduce linearly once red-band reflectance >= 0.20.
-        if (redband && redband->data_in && !IS_NONDATA(redband->data_in[i])) {
-            float rb = redband->data_in[i];
-            if (rb >= 0.20f) {
-                r_corr *= 1.0f - (rb - 0.20f) / 0.80f;
-                if (r_corr < 0.0f) r_corr = 0.0f;
+            float theta_s_sec = 1.0f / cosf(sza_clipped * M_PI / 180.0f);
+            float vza_sec = 1.0f / cosf(vza_clipped * M_PI / 180.0f);
+
+            RayleighCell cell;
+            rayleigh_cell(&lut[0], theta_s_sec, vza_sec, geom[2], &cell);
+
+            // Taper correction linearly for SZA 70°-88° to avoid over-correction near the day/night terminator (matches satpy/pyspectral).
+            float reduce_factor = 1.0f;
+            if (theta_s > 70.0f) {
+                reduce_factor = 1.0f - (theta_s - 70.0f) / (88.0f - 70.0f);
+                if (reduce_factor < 0.0f) reduce_factor = 0.0f;
             }
-        }
-        
-        if (r_corr > max_rayleigh) max_rayleigh = r_corr;
 
-        // Apply correction: corrected_reflectance = TOA_reflectance - Rayleigh_path_radiance.
-        float val = original - r_corr;
+            for (int b = 0; b < n; b++) {
+                if (IS_NONDATA(original[b]))
+                    continue;
+                float r_corr = rayleigh_cell_value(table[b], &cell);
+                if (theta_s > 70.0f)
+                    r_corr *= reduce_factor;
 
-        if (val < 0.0f) {
-            val = 0.0f;
-            negative_pixels++;
-        }
+                // Relax correction over bright clouds (matching pyspectral): reduce linearly once red-band reflectance >= 0.20.
+                if (!IS_NONDATA(rb[b]) && rb[b] >= 0.20f) {
+                    r_corr *= 1.0f - (rb[b] - 0.20f) / 0.80f;
+                    if (r_corr < 0.0f) r_corr = 0.0f;
+                }
+
+                if (r_corr > max_rayleigh[b]) max_rayleigh[b] = r_corr;
 
-        sum_original += original;
-        sum_rayleigh += r_corr;
-        sum_corrected += val;
-        valid_pixels++;
+                // Apply correction: corrected_reflectance = TOA_reflectance - Rayleigh_path_radiance.
+                float val = original[b] - r_corr;
 
-        img->data_in[i] = val;
+                if (val < 0.0f) {
+                    val = 0.0f;
+                    negative_pixels[b]++;
+                }
+
+                sum_original[b] += original[b];
+                sum_rayleigh[b] += r_corr;
+                sum_corrected[b] += val;
+                valid_pixels[b]++;
+
+                img[b]->data_in[i] = val;
+            }
+        }
     }
 
     double end_time = omp_get_wtime();
-    LOG_TIMING(end_time - start_time, "Rayleigh LUT C%02d (%zu px)", channel, valid_pixels);
-    LOG_DEBUG("  night=%zu clamped=%zu mean=%.4f->%.4f corr_max=%.4f",
-             night_pixels, negative_pixels,
-             valid_pixels > 0 ? sum_original/valid_pixels : 0.0,
-             valid_pixels > 0 ? sum_corrected/valid_pixels : 0.0,
-             max_rayleigh);
+    for (int b = 0; b < n; b++) {
+        LOG_DEBUG("  C%02d: night=%zu clamped=%zu mean=%.4f->%.4f corr_max=%.4f", channels[b],
+                  night_pixels[b], negative_pixels[b],
+                  valid_pixels[b] > 0 ? sum_original[b] / valid_pixels[b] : 0.0,
+                  valid_pixels[b] > 0 ? sum_corrected[b] / valid_pixels[b] : 0.0,
+                  max_rayleigh[b]);
+    }
+    if (n == 1) {
+        LOG_TIMING(end_time - start_time, "Rayleigh LUT C%02d (%zu px)", channels[0], valid_pixels[0]);
+    } else {
+        LOG_TIMING(end_time - start_time, "Rayleigh LUT %d bands, shared geometry (%zu px)", n,
+                   valid_pixels[0]);
+    }
 
     // Recompute fmin/fmax over corrected data so downstream normalization is correct.
-    float new_min = 1e20f;
-    float new_max = -1e20f;
-    #pragma omp parallel for reduction(min:new_min) reduction(max:new_max)
-    for (size_t i = 0; i < n; i++) {
-        float val = img->data_in[i];
-        if (val > 0.0f && !IS_NONDATA(val)) {
-            if (val < new_min) new_min = val;
-            if (val > new_max) new_max = val;
+    for (int b = 0; b < n; b++) {
+        DataF *im = img[b];
+        float new_min = 1e20f;
+        float new_max = -1e20f;
+        #pragma omp parallel for reduction(min:new_min) reduction(max:new_max)
+        for (unsigned int y = 0; y < im->height; y++) {
+            unsigned int x0, x1;
+            dataf_row_span(im, y, &x0, &x1);
+            for (size_t i = (size_t)y * w + x0; i < (size_t)y * w + x1; i++) {
+                float val = im->data_in[i];
+                if (val > 0.0f && !IS_NONDATA(val)) {
+                    if (val < new_min) new_min = val;
+                    if (val > new_max) new_max = val;
+                }
+            }
         }
-    }
-    
-    if (new_max > new_min) {
-        img->fmin = new_min;
-        img->fmax = new_max;
-        LOG_DEBUG("  Post-Rayleigh range: [%.6f, %.6f]", new_min, new_max);
-    }
 
-    rayleigh_lut_destroy(&lut);
+        if (new_max > new_min) {
+            im->fmin = new_min;
+            im->fmax = new_max;
+            LOG_DEBUG("  Post-Rayleigh C%02d range: [%.6f, %.6f]", channels[b], new_min, new_max);
+        }
+        rayleigh_lut_destroy(&lut[b]);
+    }
 }
@@ -7,7 +7,9 @@
  */
 #include "datanc.h"
 #include "reader_nc.h"
+#include "fastmath.h"
 #include "nav_plan.h"
+#include "nav_cache.h"
 #include "reader_nc_chunk.h"
 #include "logger.h"
 #include <math.h>
@@ -69,6 +71,7 @@ typedef struct {
     float scale_factor;
     float add_offset;
     short fillvalue;
+    double fillvalue_fp;    /* _FillValue of NC_FLOAT/NC_DOUBLE variables; NaN if none */
     nc_type var_type;
     /* Constants for L1b calibration */
     float planck_fk1, planck_fk2, planck_bc1, planck_bc2;
@@ -166,6 +169,10 @@ static int datanc_read_metadata(int ncid, int varid, DataNC *datanc, NCScaleConf
     if (nc_get_att_float(ncid, varid, "add_offset", &cfg->add_offset)) cfg->add_offset = 0.0f;
     if (nc_get_att_short(ncid, varid, "_FillValue", &cfg->fillvalue)) cfg->fillvalue = -1;
     nc_inq_vartype(ncid, varid, &cfg->var_type);
+    cfg->fillvalue_fp = NAN;
+    if ((cfg->var_type == NC_FLOAT || cfg->var_type == NC_DOUBLE) &&
+        nc_get_att_double(ncid, varid, "_FillValue", &cfg->fillvalue_fp) != NC_NOERR)
+        cfg->fillvalue_fp = NAN;
 
     if (nc_inq_varid(ncid, "t", &time_varid) == NC_NOERR) {
         double tiempo = 0.0;
@@ -236,121 +243,442 @@ static int datanc_read_metadata(int ncid, int varid, DataNC *datanc, NCScaleConf
     return 0;
 }
 
-/// Phase 4 - Unpacking and parallelization: converts raw packed integers to calibrated floats.
-static int datanc_unpack_grid(int ncid, int varid, size_t total_size, DataNC *datanc, const NCScaleConfig *cfg) {
-    size_t tsize = (cfg->var_type == NC_BYTE || cfg->var_type == NC_UBYTE) ? 1 : 2;
-    void *datatmp = malloc(tsize * total_size);
-    if (!datatmp) return -1;
+/// Calibration of one raw count: scale/offset, then for L1b radiances either the
+/// reflectance factor kappa0 or the inverse Planck function (bands >= 7).
+/// With `lut` set, the result for every possible 16-bit count is precomputed
+/// (see nc_build_lut) and conversion is a single load.
+typedef struct {
+    const NCScaleConfig *cfg;
+    bool l1b;
+    bool emissive;
+    const float *lut;   ///< 65536 entries indexed by the raw bit pattern, or NULL
+} NCCalibration;
+
+static inline float nc_calibrate(float count, const NCCalibration *c) {
+    const NCScaleConfig *cfg = c->cfg;
+    float val = count * cfg->scale_factor + cfg->add_offset;
+    if (c->l1b) {
+        if (c->emissive) val = (val > 0.0f) ? (cfg->planck_fk2 / (logf((cfg->planck_fk1 / val) + 1.0f)) - cfg->planck_bc1) / cfg->planck_bc2 : 0.0f;
+        else val *= cfg->kappa0;
+    }
+    return val;
+}
 
-    // Fast path: read the HDF5 chunks and decompress them in parallel with
-    // libdeflate (reader_nc_chunk.c), which is far faster than HDF5's serial
-    // filter pipeline on large full-disk variables. Falls back to nc_get_var on
-    // any unsupported layout, so correctness never depends on it. Only the
-    // 2-byte integer case is handled by the fast reader.
-    bool fast_loaded = false;
-    if (tsize == 2 && datanc->varname) {
-        size_t plen = 0;
-        if (nc_inq_path(ncid, &plen, NULL) == NC_NOERR && plen > 0) {
-            char *path = (char *)malloc(plen + 1);
-            if (path && nc_inq_path(ncid, &plen, path) == NC_NOERR) {
-                if (read_var_chunked_deflate(path, datanc->varname, datatmp,
-                                             datanc->fdata.width,
-                                             datanc->fdata.height, tsize) == 0)
-                    fast_loaded = true;
+/// ChunkConverter callbacks (see reader_nc_chunk.h): raw counts -> calibrated
+/// floats, fill -> NonData, tracking the range of the valid values.
+static void convert_short(const void *src, void *dst, size_t n, const void *arg, float *vmin, float *vmax) {
+    const NCCalibration *c = (const NCCalibration *)arg;
+    const short *in = (const short *)src;
+    float *out = (float *)dst;
+    float lo = *vmin, hi = *vmax;
+    if (c->lut) {
+        const short fill = c->cfg->fillvalue;
+        for (size_t i = 0; i < n; i++) {
+            float val = c->lut[(uint16_t)in[i]];
+            out[i] = val;
+            if (in[i] != fill) {
+                if (val < lo) lo = val;
+                if (val > hi) hi = val;
             }
-            free(path);
         }
+        *vmin = lo; *vmax = hi;
+        return;
+    }
+    for (size_t i = 0; i < n; i++) {
+        if (in[i] == c->cfg->fillvalue) {
+            out[i] = NonData;
+        } else {
+            float val = nc_calibrate(in[i], c);
+            out[i] = val;
+            if (val < lo) lo = val;
+            if (val > hi) hi = val;
+        }
+    }
+    *vmin = lo; *vmax = hi;
+}
+
+static void convert_ushort(const void *src, void *dst, size_t n, const void *arg, float *vmin, float *vmax) {
+    const NCCalibration *c = (const NCCalibration *)arg;
+    const unsigned short *in = (const unsigned short *)src;
+    float *out = (float *)dst;
+    float lo = *vmin, hi = *vmax;
+    if (c->lut) {
+        const unsigned short fill = (unsigned short)c->cfg->fillvalue;
+        for (size_t i = 0; i < n; i++) {
+            float val = c->lut[in[i]];
+            out[i] = val;
+            if (in[i] != fill) {
+                if (val < lo) lo = val;
+                if (val > hi) hi = val;
+            }
+        }
+        *vmin = lo; *vmax = hi;
+        return;
     }
-    if (!fast_loaded && nc_get_var(ncid, varid, datatmp) != NC_NOERR) { free(datatmp); return -1; }
+    for (size_t i = 0; i < n; i++) {
+        if (in[i] == (unsigned short)c->cfg->fillvalue) {
+            out[i] = NonData;
+        } else {
+            float val = nc_calibrate(in[i], c);
+            out[i] = val;
+            if (val < lo) lo = val;
+            if (val > hi) hi = val;
+        }
+    }
+    *vmin = lo; *vmax = hi;
+}
+
+/// Unpacked floating-point variables (float32 and float64 L2 products): only the
+/// fill test and scale/offset, which are 1/0 unless the file says otherwise.
+static void convert_float(const void *src, void *dst, size_t n, const void *arg, float *vmin, float *vmax) {
+    const NCCalibration *c = (const NCCalibration *)arg;
+    const float *in = (const float *)src;
+    float *out = (float *)dst;
+    const float fill = (float)c->cfg->fillvalue_fp;
+    float lo = *vmin, hi = *vmax;
+    for (size_t i = 0; i < n; i++) {
+        if (in[i] == fill || isnan(in[i])) {
+            out[i] = NonData;
+        } else {
+            float val = nc_calibrate(in[i], c);
+            out[i] = val;
+            if (val < lo) lo = val;
+            if (val > hi) hi = val;
+        }
+    }
+    *vmin = lo; *vmax = hi;
+}
+
+static void convert_double(const void *src, void *dst, size_t n, const void *arg, float *vmin, float *vmax) {
+    const NCCalibration *c = (const NCCalibration *)arg;
+    const double *in = (const double *)src;
+    float *out = (float *)dst;
+    const double fill = c->cfg->fillvalue_fp;
+    float lo = *vmin, hi = *vmax;
+    for (size_t i = 0; i < n; i++) {
+        if (in[i] == fill || isnan(in[i])) {
+            out[i] = NonData;
+        } else {
+            float val = nc_calibrate((float)in[i], c);
+            out[i] = val;
+            if (val < lo) lo = val;
+            if (val > hi) hi = val;
+        }
+    }
+    *vmin = lo; *vmax = hi;
+}
+
+/// Byte products (cloud masks, phase, DQF) stay integer: fill -> -128. `arg` is
+/// the fill value; vmin/vmax are untouched. Works in place (src == dst).
+static void convert_byte(const void *src, void *dst, size_t n, const void *arg, float *vmin, float *vmax) {
+    (void)vmin; (void)vmax;
+    const int8_t fill = *(const int8_t *)arg;
+    const int8_t *in = (const int8_t *)src;
+    int8_t *out = (int8_t *)dst;
+    for (size_t i = 0; i < n; i++)
+        out[i] = (in[i] == fill) ? -128 : in[i];
+}
+
+/// Calibration table for every 16-bit count (256 KB, stays in L2 while the grid
+/// streams through). The entries are computed with nc_calibrate() itself, so a
+/// lookup returns exactly what the direct evaluation would, logf included.
+/// The fill value maps to NonData.
+static float *nc_build_lut(const NCCalibration *c, bool is_unsigned) {
+    float *lut = (float *)malloc(65536 * sizeof(float));
+    if (!lut) return NULL;
+    #pragma omp parallel for
+    for (int k = 0; k < 65536; k++) {
+        int count = (is_unsigned || k < 32768) ? k : k - 65536;
+        lut[k] = nc_calibrate((float)count, c);
+    }
+    lut[(uint16_t)c->cfg->fillvalue] = NonData;
+    return lut;
+}
+
+/// Path of an open NetCDF file (malloc'd), or NULL.
+static char *nc_dup_path(int ncid) {
+    size_t plen = 0;
+    if (nc_inq_path(ncid, &plen, NULL) != NC_NOERR || plen == 0) return NULL;
+    char *path = (char *)malloc(plen + 1);
+    if (path && nc_inq_path(ncid, &plen, path) != NC_NOERR) { free(path); path = NULL; }
+    return path;
+}
+
+/// Phase 4 - Unpacking and parallelization: converts raw packed integers to calibrated floats.
+/// Only the pixel window `win` of the grid_w x grid_h variable is read. With factor > 1
+/// float data is box-filtered to (width/factor) x (height/factor) as it is decoded;
+/// byte data ignores it. Sets *applied to the factor actually used.
+static int datanc_unpack_grid(int ncid, int varid, size_t grid_w, size_t grid_h, const PixelWindow *win,
+                              int factor, DataNC *datanc, const NCScaleConfig *cfg, int *applied) {
+    size_t total_size = (size_t)win->width * (size_t)win->height;
+    size_t start[2] = {win->y0, win->x0}, count[2] = {win->height, win->width};
+    *applied = 1;
+
+    // Fast-path candidate: the file path and the variable name (see below).
+    char *path = NULL;
+    #pragma omp critical(hpsv_hdf5)
+    path = datanc->varname ? nc_dup_path(ncid) : NULL;
 
     if (cfg->var_type == NC_BYTE || cfg->var_type == NC_UBYTE) {
         datanc->is_float = false;
-        datanc->bdata = datab_create(datanc->fdata.width, datanc->fdata.height);
-        int8_t *src = (int8_t *)datatmp;
-        #pragma omp parallel for
-        for (size_t i = 0; i < total_size; i++) {
-            if (src[i] == (int8_t)cfg->fillvalue) datanc->bdata.data_in[i] = -128;
-            else datanc->bdata.data_in[i] = src[i];
+        datanc->bdata = datab_create(win->width, win->height);
+        if (!datanc->bdata.data_in) { free(path); return -1; }
+        const int8_t fill = (int8_t)cfg->fillvalue;
+        ChunkConverter conv = { 1, convert_byte, &fill };
+        bool fast_loaded = path &&
+            read_var_chunked_deflate_convert(path, datanc->varname, datanc->bdata.data_in, grid_w, grid_h,
+                                             1, win->x0, win->y0, win->width, win->height, &conv,
+                                             NULL, NULL) == 0;
+        free(path);
+        if (!fast_loaded) {
+            int err;
+            #pragma omp critical(hpsv_hdf5)
+            err = nc_get_vara(ncid, varid, start, count, datanc->bdata.data_in);
+            if (err != NC_NOERR) { datab_destroy(&datanc->bdata); return -1; }
+            size_t w = win->width;
+            #pragma omp parallel for
+            for (size_t r = 0; r < win->height; r++)
+                convert_byte(datanc->bdata.data_in + r * w, datanc->bdata.data_in + r * w, w, &fill,
+                             NULL, NULL);
         }
-    } else {
-        datanc->is_float = true;
-        datanc->fdata = dataf_create(datanc->fdata.width, datanc->fdata.height);
-        float local_min = 1e30f, local_max = -1e30f;
-        if (cfg->var_type == NC_USHORT) {
-            unsigned short *src = (unsigned short *)datatmp;
-            #pragma omp parallel for reduction(min:local_min) reduction(max:local_max)
-            for (size_t i = 0; i < total_size; i++) {
-                if (src[i] == (unsigned short)cfg->fillvalue) {
-                    datanc->fdata.data_in[i] = NonData;
-                } else {
-                    float val = src[i] * cfg->scale_factor + cfg->add_offset;
-                    if (datanc->level == LEVEL_L1b) {
-                        if (datanc->band_id >= 7) val = (val > 0.0f) ? (cfg->planck_fk2 / (logf((cfg->planck_fk1 / val) + 1.0f)) - cfg->planck_bc1) / cfg->planck_bc2 : 0.0f;
-                        else val *= cfg->kappa0;
-                    }
-                    datanc->fdata.data_in[i] = val;
-                    if (val < local_min) local_min = val;
-                    if (val > local_max) local_max = val;
-                }
+        return 0;
+    }
+
+    // Packed 16-bit counts unless the variable is stored as floating point.
+    size_t es = 2;
+    void (*convert)(const void *, void *, size_t, const void *, float *, float *) =
+        cfg->var_type == NC_USHORT ? convert_ushort : convert_short;
+    if (cfg->var_type == NC_FLOAT) { es = 4; convert = convert_float; }
+    else if (cfg->var_type == NC_DOUBLE) { es = 8; convert = convert_double; }
+
+    datanc->is_float = true;
+    if (factor < 1 || win->width < (unsigned int)factor || win->height < (unsigned int)factor)
+        factor = 1;
+    datanc->fdata = dataf_create(win->width / factor, win->height / factor);
+    if (!datanc->fdata.data_in) { free(path); return -1; }
+    NCCalibration cal = { cfg, datanc->level == LEVEL_L1b, datanc->band_id >= 7, NULL };
+    // A grid much larger than the table pays for it many times over: an
+    // emissive band costs one logf per pixel otherwise.
+    float *lut = NULL;
+    if (es == 2 && total_size >= 4 * 65536) {
+        lut = nc_build_lut(&cal, cfg->var_type == NC_USHORT);
+        cal.lut = lut;
+    }
+    ChunkConverter conv = { sizeof(float), convert, &cal };
+    float local_min = 1e30f, local_max = -1e30f;
+
+    // Fast path: read the HDF5 chunks and decompress them in parallel with
+    // libdeflate (reader_nc_chunk.c), which is far faster than HDF5's serial
+    // filter pipeline on large full-disk variables. Each chunk is calibrated
+    // straight into fdata as it is decoded, so no raw int16 copy of the grid is
+    // ever held; with a factor, not even the calibrated full-resolution grid is.
+    // Falls back to nc_get_vara on any unsupported layout, so correctness never
+    // depends on it.
+    bool fast_loaded = false;
+    if (path) {
+        fast_loaded = read_var_chunked_deflate_boxfilter(path, datanc->varname, datanc->fdata.data_in,
+                                                         grid_w, grid_h, es, win->x0, win->y0,
+                                                         win->width, win->height, (size_t)factor,
+                                                         &conv, &local_min, &local_max) == 0;
+        free(path);
+    }
+    if (!fast_loaded) {
+        uint8_t *raw = (uint8_t *)malloc(es * total_size);
+        int err = NC_ENOMEM;
+        if (raw) {
+            #pragma omp critical(hpsv_hdf5)
+            err = nc_get_vara(ncid, varid, start, count, raw);
+        }
+        if (err != NC_NOERR) {
+            free(raw);
+            free(lut);
+            dataf_destroy(&datanc->fdata);
+            return -1;
+        }
+        // Here the factor costs the full-resolution grid after all.
+        if (factor > 1) {
+            dataf_destroy(&datanc->fdata);
+            datanc->fdata = dataf_create(win->width, win->height);
+            if (!datanc->fdata.data_in) {
+                free(raw);
+                free(lut);
+                return -1;
             }
-        } else {
-            short *src = (short *)datatmp;
-            #pragma omp parallel for reduction(min:local_min) reduction(max:local_max)
-            for (size_t i = 0; i < total_size; i++) {
-                if (src[i] == cfg->fillvalue) {
-                    datanc->fdata.data_in[i] = NonData;
-                } else {
-                    float val = src[i] * cfg->scale_factor + cfg->add_offset;
-                    if (datanc->level == LEVEL_L1b) {
-                        if (datanc->band_id >= 7) val = (val > 0.0f) ? (cfg->planck_fk2 / (logf((cfg->planck_fk1 / val) + 1.0f)) - cfg->planck_bc1) / cfg->planck_bc2 : 0.0f;
-                        else val *= cfg->kappa0;
-                    }
-                    datanc->fdata.data_in[i] = val;
-                    if (val < local_min) local_min = val;
-                    if (val > local_max) local_max = val;
-                }
+        }
+        size_t w = win->width;
+        #pragma omp parallel for reduction(min:local_min) reduction(max:local_max)
+        for (size_t r = 0; r < win->height; r++)
+            conv.convert(raw + r * w * es, datanc->fdata.data_in + r * w, w, &cal, &local_min, &local_max);
+        free(raw);
+        if (factor > 1) {
+            DataF small = downsample_boxfilter(datanc->fdata, factor);
+            dataf_destroy(&datanc->fdata);
+            datanc->fdata = small;
+            if (!small.data_in) {
+                free(lut);
+                return -1;
             }
         }
-        datanc->fdata.fmin = local_min; datanc->fdata.fmax = local_max;
     }
-    free(datatmp);
+    free(lut);
+    datanc->fdata.fmin = local_min; datanc->fdata.fmax = local_max;
+    *applied = factor;
     return 0;
 }
 
+/// Open + phases 2-3. Returns -1 if the file could not be opened, 1 if it was
+/// opened (ncid valid) but identification or metadata failed, 0 on success.
+/// netCDF/HDF5 are not thread-safe: call inside critical(hpsv_hdf5).
+static int datanc_open_describe(const char *filename, DataNC *datanc, NCScaleConfig *cfg,
+                                int *ncid, int *varid) {
+    if (nc_open(filename, NC_NOWRITE, ncid) != NC_NOERR) {
+        LOG_ERROR("Error opening NetCDF: %s", filename);
+        return -1;
+    }
+    *varid = datanc_identify_product(*ncid, filename, datanc);
+    if (*varid < 0) {
+        LOG_WARN("Skipped or unsupported product: %s", filename);
+        return 1;
+    }
+    return datanc_read_metadata(*ncid, *varid, datanc, cfg) != 0 ? 1 : 0;
+}
+
+static int nav_plan_read(int ncid, NavPlan *plan);
+static DiskSpans *nav_disk_spans(const NavPlan *plan, size_t x0, size_t y0, int factor,
+                                 unsigned int width, unsigned int height);
+
 /// Phase 5 - Final orchestration: open, identify, read metadata, unpack, and clean up.
-int load_nc_sf(const char *filename, DataNC *datanc) {
-    int ncid, varid, status = -1;
+/// With header_only nothing past the metadata is read (fdata.data_in stays NULL).
+/// With factor > 1 float data comes out box-filtered (see datanc_unpack_grid) and
+/// the geotransform and native resolution describe the reduced grid.
+/// Safe to run for several files at once (load_nc_sf_batch): every netCDF call
+/// sits in critical(hpsv_hdf5), shared with the chunked reader.
+static int load_nc_pipeline(const char *filename, const PixelWindow *win, int factor, bool header_only,
+                            DataNC *datanc) {
+    int ncid, varid, status = -1, opened, applied = 1;
     NCScaleConfig cfg = { .scale_factor = 1.0f, .add_offset = 0.0f, .fillvalue = -1, .var_type = NC_SHORT };
 
     if (datanc != NULL) {
 		memset(datanc, 0, sizeof(DataNC));
         datanc->proj_info.valid = false;
     }
-    
-    if (nc_open(filename, NC_NOWRITE, &ncid) != NC_NOERR) {
-        LOG_ERROR("Error opening NetCDF: %s", filename);
-        return -1;
-    }
 
-    varid = datanc_identify_product(ncid, filename, datanc);
-    if (varid < 0) {
-        LOG_WARN("Skipped or unsupported product: %s", filename);
+    #pragma omp critical(hpsv_hdf5)
+    opened = datanc_open_describe(filename, datanc, &cfg, &ncid, &varid);
+    if (opened < 0) return -1;
+    if (opened > 0) goto cleanup;
+    if (header_only) {
+        datanc->is_float = (cfg.var_type != NC_BYTE && cfg.var_type != NC_UBYTE);
+        status = 0;
         goto cleanup;
     }
 
-    if (datanc_read_metadata(ncid, varid, datanc, &cfg) != 0) goto cleanup;
-
-    size_t total_size = (size_t)datanc->fdata.width * (size_t)datanc->fdata.height;
-    LOG_INFO("NetCDF dimensions: %ux%u (total: %zu)", datanc->fdata.width, datanc->fdata.height, total_size);
-    if (datanc_unpack_grid(ncid, varid, total_size, datanc, &cfg) != 0) goto cleanup;
+    size_t grid_w = datanc->fdata.width, grid_h = datanc->fdata.height;
+    PixelWindow full = {0, 0, (unsigned int)grid_w, (unsigned int)grid_h};
+    PixelWindow pw = full;
+    if (win) {
+        // Clamp to the grid; an empty intersection is an error, not an empty image.
+        size_t x1 = (size_t)win->x0 + win->width, y1 = (size_t)win->y0 + win->height;
+        if (x1 > grid_w) x1 = grid_w;
+        if (y1 > grid_h) y1 = grid_h;
+        if (win->x0 >= x1 || win->y0 >= y1) {
+            LOG_ERROR("Pixel window %u,%u %ux%u lies outside the %zux%zu grid of %s",
+                      win->x0, win->y0, win->width, win->height, grid_w, grid_h, filename);
+            goto cleanup;
+        }
+        pw.x0 = win->x0;
+        pw.y0 = win->y0;
+        pw.width = (unsigned int)(x1 - win->x0);
+        pw.height = (unsigned int)(y1 - win->y0);
+    }
+    datanc->fdata.width = pw.width;
+    datanc->fdata.height = pw.height;
+    // The window's upper-left corner becomes the origin of the geotransform.
+    datanc->geotransform[0] += pw.x0 * datanc->geotransform[1];
+    datanc->geotransform[3] += pw.y0 * datanc->geotransform[5];
+
+    size_t total_size = (size_t)pw.width * (size_t)pw.height;
+    if (win)
+        LOG_INFO("NetCDF dimensions: %zux%zu, window %u,%u %ux%u (total: %zu)", grid_w, grid_h,
+                 pw.x0, pw.y0, pw.width, pw.height, total_size);
+    else
+        LOG_INFO("NetCDF dimensions: %ux%u (total: %zu)", pw.width, pw.height, total_size);
+    if (datanc_unpack_grid(ncid, varid, grid_w, grid_h, &pw, factor, datanc, &cfg, &applied) != 0)
+        goto cleanup;
+    if (applied > 1) {
+        datanc->geotransform[1] *= applied;
+        datanc->geotransform[5] *= applied;
+        datanc->native_resolution_km *= applied;
+        LOG_INFO("Box-filtered while decoding (factor %d): %ux%u", applied, datanc->fdata.width,
+                 datanc->fdata.height);
+    }
+    // Space around a full disk is NonData: kernels downstream only visit the disk.
+    // The spans come from the file's fixed grid, not from scanning the data.
+    if (datanc->is_float && datanc->proj_info.valid) {
+        NavPlan plan;
+        int rc;
+        #pragma omp critical(hpsv_hdf5)
+        rc = nav_plan_read(ncid, &plan);
+        if (rc == 0) {
+            datanc->fdata.spans = nav_disk_spans(&plan, pw.x0, pw.y0, applied,
+                                                 datanc->fdata.width, datanc->fdata.height);
+            nav_plan_destroy(&plan);
+        }
+    }
 
     status = 0;
 cleanup:
+    #pragma omp critical(hpsv_hdf5)
     nc_close(ncid);
     if (status != 0) LOG_FATAL("NetCDF read pipeline failed for %s", filename);
     return status;
 }
 
+int load_nc_sf(const char *filename, DataNC *datanc) {
+    return load_nc_pipeline(filename, NULL, 1, false, datanc);
+}
+
+int load_nc_sf_window(const char *filename, const PixelWindow *win, DataNC *datanc) {
+    return load_nc_pipeline(filename, win, 1, false, datanc);
+}
+
+int load_nc_sf_reduced(const char *filename, const PixelWindow *win, int factor, DataNC *datanc) {
+    return load_nc_pipeline(filename, win, factor, false, datanc);
+}
+
+int load_nc_header(const char *filename, DataNC *datanc) {
+    return load_nc_pipeline(filename, NULL, 1, true, datanc);
+}
+
+int load_nc_sf_batch(NCLoadJob *jobs, int n) {
+    // Two loads in flight: while one is in its serial netCDF/HDF5 phase (open,
+    // metadata, chunk index; one thread, under the lock) the other decodes with a
+    // thread team. More would only queue on the lock. Each outer thread opens
+    // its own nested team for the decode, so nesting must be allowed, and each
+    // team gets 1/conc of the threads: two full teams would oversubscribe the
+    // cores while decodes overlap.
+    int conc = (n > 1 && !getenv("HPSV_SERIAL_LOAD")) ? 2 : 1;
+    int prev_levels = omp_get_max_active_levels();
+    if (conc > 1 && prev_levels < 2) omp_set_max_active_levels(2);
+    int inner = omp_get_max_threads() / conc;
+    if (inner < 1) inner = 1;
+
+    double t0 = omp_get_wtime();
+    int failed = 0;
+    #pragma omp parallel for num_threads(conc) schedule(dynamic, 1) reduction(+:failed)
+    for (int i = 0; i < n; i++) {
+        omp_set_num_threads(inner); // this outer thread's nested decode team
+        double t = omp_get_wtime();
+        jobs[i].status = load_nc_sf_reduced(jobs[i].filename, jobs[i].window, jobs[i].factor, jobs[i].out);
+        jobs[i].seconds = omp_get_wtime() - t;
+        if (jobs[i].status != 0) failed++;
+    }
+    omp_set_max_active_levels(prev_levels);
+    LOG_TIMING(omp_get_wtime() - t0, "Load %d NetCDF files (%d at a time, %d threads each)", n,
+               conc, inner);
+    return failed;
+}
+
 
 double rad2deg = 180.0 / M_PI;
 double hsat, sm_maj, sm_min, lambda_0, H;
@@ -383,14 +711,11 @@ void compute_lalo(double x, double y, double *la, double *lo) {
     *lo = (double)((lon_rad - M_PI) * rad2deg);
 }
 
-int nav_build_plan(const char *filename, NavPlan *plan) {
-    if (!plan) return -1;
+// nav_build_plan() on a file already open. Leaves ncid open.
+static int nav_plan_read(int ncid, NavPlan *plan) {
     memset(plan, 0, sizeof(*plan));
 
-    int ncid, varid, retval;
-    if ((retval = nc_open(filename, NC_NOWRITE, &ncid)))
-        ERR(retval);
-
+    int varid, retval;
     int xid, yid;
     if ((retval = nc_inq_dimid(ncid, "x", &xid)))
         ERR(retval);
@@ -434,7 +759,6 @@ int nav_build_plan(const char *filename, NavPlan *plan) {
     double *y_rad = malloc(height * sizeof(double));
     if (!x_vals_raw || !y_vals_raw || !x_rad || !y_rad) {
         free(x_vals_raw); free(y_vals_raw); free(x_rad); free(y_rad);
-        nc_close(ncid);
         LOG_ERROR("Memory error while reading x[], y[]");
         return -1;
     }
@@ -442,7 +766,6 @@ int nav_build_plan(const char *filename, NavPlan *plan) {
     if ((retval = nc_get_var_short(ncid, xid, x_vals_raw)) ||
         (retval = nc_get_var_short(ncid, yid, y_vals_raw))) {
         free(x_vals_raw); free(y_vals_raw); free(x_rad); free(y_rad);
-        nc_close(ncid);
         ERR(retval);
     }
 
@@ -453,10 +776,6 @@ int nav_build_plan(const char *filename, NavPlan *plan) {
 
     free(x_vals_raw);
     free(y_vals_raw);
-    if ((retval = nc_close(ncid))) {
-        free(x_rad); free(y_rad);
-        ERR(retval);
-    }
 
     plan->width = width;
     plan->height = height;
@@ -469,6 +788,21 @@ int nav_build_plan(const char *filename, NavPlan *plan) {
     return 0;
 }
 
+int nav_build_plan(const char *filename, NavPlan *plan) {
+    if (!plan) return -1;
+    memset(plan, 0, sizeof(*plan));
+
+    int ncid, retval;
+    if ((retval = nc_open(filename, NC_NOWRITE, &ncid)))
+        ERR(retval);
+    int rc = nav_plan_read(ncid, plan);
+    if ((retval = nc_close(ncid))) {
+        nav_plan_destroy(plan);
+        ERR(retval);
+    }
+    return rc;
+}
+
 void nav_plan_destroy(NavPlan *plan) {
     if (!plan) return;
     free(plan->x_rad);
@@ -476,21 +810,310 @@ void nav_plan_destroy(NavPlan *plan) {
     memset(plan, 0, sizeof(*plan));
 }
 
-int compute_navigation_nc(const char *filename, DataF *navla, DataF *navlo) {
-    NavPlan plan;
-    if (nav_build_plan(filename, &plan) != 0) return -1;
+int nav_plan_window(const NavPlan *plan, size_t x0, size_t y0, size_t width,
+                    size_t height, NavPlan *out) {
+    memset(out, 0, sizeof(*out));
+    if (!plan || !plan->x_rad || !plan->y_rad || width == 0 || height == 0 ||
+        x0 + width > plan->width || y0 + height > plan->height)
+        return -1;
+    *out = *plan;
+    out->width = width;
+    out->height = height;
+    out->x_rad = malloc(width * sizeof(double));
+    out->y_rad = malloc(height * sizeof(double));
+    if (!out->x_rad || !out->y_rad) {
+        nav_plan_destroy(out);
+        return -1;
+    }
+    memcpy(out->x_rad, plan->x_rad + x0, width * sizeof(double));
+    memcpy(out->y_rad, plan->y_rad + y0, height * sizeof(double));
+    return 0;
+}
 
-    const size_t width = plan.width, height = plan.height;
-    const double H = plan.H, lambda_0 = plan.lambda_0;
-    const double sm_maj = plan.sm_maj, sm_min = plan.sm_min;
+/* ---- Earth-disk spans from the geometry ----
+ * A pixel of the fixed grid sees the Earth when the discriminant of the
+ * navigation's line-of-sight quadratic is >= 0, the same test navigation_fill()
+ * makes. Along a row it falls off monotonically with |x|, so each row's span is
+ * two binary searches from the column nearest x = 0. A grid reduced by `factor`
+ * (box filter while loading) is tested at the centre of each block.
+ *
+ * The data's own fill can differ from the exact limb by a pixel (the product's
+ * Earth mask, box filter blocks straddling the limb), so every span is widened
+ * by DISK_SPAN_MARGIN pixels and merged with its neighbouring rows: a superset
+ * of the pixels that can hold data, which is all DiskSpans promises.
+ *
+ * The spans of a whole grid are kept per geometry (nav_plan_hash) and factor
+ * for the life of the process, so the channels and navigation of one grid share
+ * one computation; a window is cut out of them. */
+#define DISK_SPAN_MARGIN 2
+#define DISK_SPAN_SLOTS 8
+
+static struct {
+    uint64_t key;
+    int factor;
+    DiskSpans *spans; // whole grid; NULL = no space border
+    bool used;
+} span_cache[DISK_SPAN_SLOTS];
+
+// navigation_fill()'s test: the discriminant b^2 - 4ac of the pixel's line of
+// sight against the ellipsoid, with k = cos^2(y) + (a/b)^2 sin^2(y).
+static inline bool line_of_sight_hits(double snx, double csx, double csy, double k, double H,
+                                      double H2_maj2) {
+    double a = snx * snx + csx * csx * k;
+    double b = -2.0 * H * csx * csy;
+    return b * b - 4.0 * a * H2_maj2 >= 0.0;
+}
 
-    *navla = dataf_create(width, height);
-    *navlo = dataf_create(width, height);
-    if (!navla->data_in || !navlo->data_in) {
-        nav_plan_destroy(&plan);
-        LOG_ERROR("Memory error allocating navigation grids");
-        return -1;
+// Spans of the plan's whole grid reduced by `factor`, before the window cut.
+// Returns NULL on allocation failure.
+static DiskSpans *geometry_spans(const NavPlan *plan, int factor) {
+    const size_t w = plan->width / factor, h = plan->height / factor;
+    if (w == 0 || h == 0) return NULL;
+    const double H = plan->H;
+    const double sm_maj2 = plan->sm_maj * plan->sm_maj, sm_min2 = plan->sm_min * plan->sm_min;
+    const double ratio = sm_maj2 / sm_min2, H2_maj2 = H * H - sm_maj2;
+
+    DiskSpans *s = malloc(sizeof(DiskSpans) + h * sizeof(s->x[0]));
+    double *snx = malloc(w * sizeof(double)), *csx = malloc(w * sizeof(double));
+    unsigned int (*raw)[2] = malloc(h * sizeof(*raw));
+    if (!s || !snx || !csx || !raw) {
+        free(s); free(snx); free(csx); free(raw);
+        return NULL;
     }
+    size_t mid = 0; // the column nearest x = 0, where each row is widest
+    double mid_x = INFINITY;
+    for (size_t i = 0; i < w; i++) {
+        double x = 0.5 * (plan->x_rad[i * factor] + plan->x_rad[i * factor + factor - 1]);
+        snx[i] = sin(x);
+        csx[i] = cos(x);
+        if (fabs(x) < mid_x) {
+            mid_x = fabs(x);
+            mid = i;
+        }
+    }
+
+    for (size_t j = 0; j < h; j++) {
+        double y = 0.5 * (plan->y_rad[j * factor] + plan->y_rad[j * factor + factor - 1]);
+        double sny = sin(y), csy = cos(y);
+        double k = csy * csy + ratio * sny * sny;
+        raw[j][0] = raw[j][1] = 0;
+        if (!line_of_sight_hits(snx[mid], csx[mid], csy, k, H, H2_maj2)) continue;
+        size_t lo = 0, hi = mid; // first column on the disk, in [0, mid]
+        while (lo < hi) {
+            size_t m = (lo + hi) / 2;
+            if (line_of_sight_hits(snx[m], csx[m], csy, k, H, H2_maj2)) hi = m;
+            else lo = m + 1;
+        }
+        raw[j][0] = (unsigned int)lo;
+        lo = mid + 1, hi = w; // one past the last, in [mid+1, w]
+        while (lo < hi) {
+            size_t m = (lo + hi) / 2;
+            if (line_of_sight_hits(snx[m], csx[m], csy, k, H, H2_maj2)) lo = m + 1;
+            else hi = m;
+        }
+        raw[j][1] = (unsigned int)lo;
+    }
+
+    s->height = (unsigned int)h;
+    s->npix = 0;
+    for (size_t j = 0; j < h; j++) {
+        size_t r0 = j < DISK_SPAN_MARGIN ? 0 : j - DISK_SPAN_MARGIN;
+        size_t r1 = j + DISK_SPAN_MARGIN < h ? j + DISK_SPAN_MARGIN : h - 1;
+        size_t x0 = w, x1 = 0;
+        for (size_t r = r0; r <= r1; r++) {
+            if (raw[r][0] == raw[r][1]) continue;
+            if (raw[r][0] < x0) x0 = raw[r][0];
+            if (raw[r][1] > x1) x1 = raw[r][1];
+        }
+        if (x0 >= x1) {
+            x0 = x1 = 0;
+        } else {
+            x0 = x0 < DISK_SPAN_MARGIN ? 0 : x0 - DISK_SPAN_MARGIN;
+            x1 = x1 + DISK_SPAN_MARGIN > w ? w : x1 + DISK_SPAN_MARGIN;
+        }
+        s->x[j][0] = (unsigned int)x0;
+        s->x[j][1] = (unsigned int)x1;
+        s->npix += x1 - x0;
+    }
+    free(snx); free(csx); free(raw);
+    return s;
+}
+
+// Spans of the width x height grid whose pixel (0, 0) is the block of `factor`
+// x `factor` pixels at (x0, y0) of the plan's grid, or NULL when it has no space
+// border, the window is not block-aligned or HPSV_NO_DISK_SPANS=1.
+static DiskSpans *nav_disk_spans(const NavPlan *plan, size_t x0, size_t y0, int factor,
+                                 unsigned int width, unsigned int height) {
+    if (getenv("HPSV_NO_DISK_SPANS") || factor < 1 || x0 % factor || y0 % factor) return NULL;
+    const size_t bx = x0 / factor, by = y0 / factor;
+    if (bx + width > plan->width / factor || by + height > plan->height / factor) return NULL;
+
+    const uint64_t key = nav_plan_hash(plan);
+    DiskSpans *out = NULL;
+    double t0 = omp_get_wtime();
+    bool computed = false;
+#pragma omp critical(hpsv_disk_spans)
+    {
+        int slot = -1;
+        for (int i = 0; i < DISK_SPAN_SLOTS && slot < 0; i++)
+            if (span_cache[i].used && span_cache[i].key == key && span_cache[i].factor == factor)
+                slot = i;
+        if (slot < 0) {
+            DiskSpans *s = geometry_spans(plan, factor);
+            computed = true;
+            if (s && s->npix == (size_t)s->height * (plan->width / factor)) {
+                free(s); // no space border: a CONUS or mesoscale sector
+                s = NULL;
+            }
+            for (int i = 0; i < DISK_SPAN_SLOTS && slot < 0; i++)
+                if (!span_cache[i].used) slot = i;
+            if (slot < 0) { // full: drop the oldest
+                free(span_cache[0].spans);
+                memmove(&span_cache[0], &span_cache[1], sizeof(span_cache[0]) * (DISK_SPAN_SLOTS - 1));
+                slot = DISK_SPAN_SLOTS - 1;
+            }
+            span_cache[slot].key = key;
+            span_cache[slot].factor = factor;
+            span_cache[slot].spans = s;
+            span_cache[slot].used = true;
+        }
+        const DiskSpans *full = span_cache[slot].spans;
+        if (full) out = malloc(sizeof(DiskSpans) + (size_t)height * sizeof(out->x[0]));
+        if (out) {
+            out->height = height;
+            out->npix = 0;
+            for (unsigned int j = 0; j < height; j++) {
+                size_t s0 = full->x[by + j][0], s1 = full->x[by + j][1];
+                s0 = s0 > bx ? s0 - bx : 0;
+                s1 = s1 > bx ? s1 - bx : 0;
+                if (s1 > width) s1 = width;
+                if (s0 >= s1) s0 = s1 = 0;
+                out->x[j][0] = (unsigned int)s0;
+                out->x[j][1] = (unsigned int)s1;
+                out->npix += s1 - s0;
+            }
+        }
+    }
+    if (computed) LOG_TIMING(omp_get_wtime() - t0, "Disk spans from the geometry (factor %d)", factor);
+    if (out && out->npix == (size_t)width * height) { // the window misses the space
+        free(out);
+        out = NULL;
+    }
+    return out;
+}
+
+/* ---- Vectorized navigation ----
+ * The per-pixel inverse projection below is the libm loop of navigation_fill()
+ * with atan2 replaced by hpsv_atan2() (include/fastmath.h) and no branch, so
+ * `omp simd` runs it 4 (AVX2) or 8 (AVX-512) pixels at a time. Off the disk
+ * the discriminant is negative, its sqrt is NaN and the NaN runs through to
+ * lat/lon, where it becomes NonData; NaN compares false, so it also drops out
+ * of the min/max without a mask. GCC only vectorizes the sqrt with
+ * -fno-math-errno (Makefile). hpsv_atan2 is off by at most 2 double ulp, far
+ * below the float rounding of the result: a 2 km full disk came out
+ * bit-identical to the libm loop, though a value next to a float rounding
+ * boundary may land one float ulp away.
+ * HPSV_NAV_FLOAT=1 does the whole solution in float, twice the lanes: under
+ * 10 m inside 95% of the disk radius, a few hundred metres at the extreme
+ * limb. HPSV_NO_SIMD_NAV=1 keeps libm. */
+typedef enum { NAV_KERNEL_LIBM, NAV_KERNEL_SIMD, NAV_KERNEL_FLOAT } NavKernel;
+
+typedef struct {
+    double H, lambda_0, sm_maj2, sm_min2, H2_maj2, rad2deg;
+    float nodata;
+} NavConsts;
+
+static NavKernel nav_kernel(void) {
+    if (getenv("HPSV_NO_SIMD_NAV")) return NAV_KERNEL_LIBM;
+    const char *f = getenv("HPSV_NAV_FLOAT");
+    return (f && *f && strcmp(f, "0") != 0) ? NAV_KERNEL_FLOAT : NAV_KERNEL_SIMD;
+}
+
+static void navigation_row_simd(const double *snx_arr, const double *csx_arr, size_t width,
+                                double sny, double csy, double csy2_rat, const NavConsts *k,
+                                float *la_row, float *lo_row, double *lamin, double *lamax,
+                                double *lomin, double *lomax, size_t *valid) {
+    const double H = k->H, lambda_0 = k->lambda_0, H2_maj2 = k->H2_maj2;
+    const double sm_maj2 = k->sm_maj2, sm_min2 = k->sm_min2, r2d = k->rad2deg;
+    const float nodata = k->nodata;
+    double la_lo = *lamin, la_hi = *lamax, lo_lo = *lomin, lo_hi = *lomax;
+    size_t n = 0;
+#pragma omp simd reduction(min : la_lo, lo_lo) reduction(max : la_hi, lo_hi) reduction(+ : n)
+    for (size_t i = 0; i < width; i++) {
+        double snx = snx_arr[i], csx = csx_arr[i];
+        double a = snx * snx + csx * csx * csy2_rat;
+        double b = -2.0 * H * csx * csy;
+        double disc = b * b - 4.0 * a * H2_maj2;
+        double rs = (-b - sqrt(disc)) / (2.0 * a);
+        double px = rs * csx * csy;
+        double py = -rs * snx;
+        double pz = rs * csx * sny;
+        double la = hpsv_atan2(sm_maj2 * pz, sm_min2 * sqrt((H - px) * (H - px) + py * py)) * r2d;
+        double lo = (lambda_0 - hpsv_atan2(py, H - px)) * r2d;
+        float laf = (float)la, lof = (float)lo;
+        la_row[i] = laf == laf ? laf : nodata;
+        lo_row[i] = lof == lof ? lof : nodata;
+        la_lo = la < la_lo ? la : la_lo;
+        la_hi = la > la_hi ? la : la_hi;
+        lo_lo = lo < lo_lo ? lo : lo_lo;
+        lo_hi = lo > lo_hi ? lo : lo_hi;
+        n += disc >= 0.0;
+    }
+    *lamin = la_lo; *lamax = la_hi; *lomin = lo_lo; *lomax = lo_hi;
+    *valid += n;
+}
+
+// Float variant: lengths in units of the semi-major axis, and the quadratic
+// rearranged against float cancellation. (b/2)^2 - a*c expands to
+// a - Hn^2 (sin^2 x + r cos^2 x sin^2 y), which stays near 1 at the disk
+// centre, and the root is taken as c / (b/2 + sqrt) instead of -b - sqrt.
+// What is left is float rounding of the scan angles, which the ray/ellipsoid
+// intersection amplifies towards the limb.
+static void navigation_row_float(const double *snx_arr, const double *csx_arr, size_t width,
+                                 double sny_d, double csy_d, double csy2_rat_d,
+                                 const NavConsts *k, float *la_row, float *lo_row,
+                                 double *lamin, double *lamax, double *lomin, double *lomax,
+                                 size_t *valid) {
+    const double Hn_d = k->H / sqrt(k->sm_maj2);
+    const float Hn = (float)Hn_d, cn = (float)(k->H2_maj2 / k->sm_maj2);
+    const float ratio = (float)(k->sm_maj2 / k->sm_min2), lambda_0 = (float)k->lambda_0;
+    const float r2d = (float)k->rad2deg, nodata = k->nodata;
+    const float sny = (float)sny_d, csy = (float)csy_d, csy2_rat = (float)csy2_rat_d;
+    const float rat_sny2 = (float)(csy2_rat_d - csy_d * csy_d), Hn2 = (float)(Hn_d * Hn_d);
+    float la_lo = (float)*lamin, la_hi = (float)*lamax, lo_lo = (float)*lomin, lo_hi = (float)*lomax;
+    size_t n = 0;
+#pragma omp simd reduction(min : la_lo, lo_lo) reduction(max : la_hi, lo_hi) reduction(+ : n)
+    for (size_t i = 0; i < width; i++) {
+        float snx = (float)snx_arr[i], csx = (float)csx_arr[i];
+        float a = snx * snx + csx * csx * csy2_rat;
+        float hb = Hn * csx * csy;
+        float disc = a - Hn2 * (snx * snx + csx * csx * rat_sny2);
+        float rs = cn / (hb + sqrtf(disc));
+        float px = rs * csx * csy;
+        float py = -rs * snx;
+        float pz = rs * csx * sny;
+        float la = hpsv_atan2f(ratio * pz, sqrtf((Hn - px) * (Hn - px) + py * py)) * r2d;
+        float lo = (lambda_0 - hpsv_atan2f(py, Hn - px)) * r2d;
+        la_row[i] = la == la ? la : nodata;
+        lo_row[i] = lo == lo ? lo : nodata;
+        la_lo = la < la_lo ? la : la_lo;
+        la_hi = la > la_hi ? la : la_hi;
+        lo_lo = lo < lo_lo ? lo : lo_lo;
+        lo_hi = lo > lo_hi ? lo : lo_hi;
+        n += disc >= 0.0f;
+    }
+    *lamin = la_lo; *lamax = la_hi; *lomin = lo_lo; *lomax = lo_hi;
+    *valid += n;
+}
+
+// Lat/lon of the pixels [x0, x0+navla->width) x [y0, y0+navla->height) of the
+// plan's grid into navla/navlo, already allocated to the window size. Each pixel
+// is computed exactly as for the whole grid, so a window equals the same crop
+// of the full navigation. Returns -1 on allocation failure.
+static int navigation_fill(const NavPlan *plan, size_t x0, size_t y0, DataF *navla, DataF *navlo) {
+    const size_t width = navla->width, height = navla->height;
+    const double H = plan->H, lambda_0 = plan->lambda_0;
+    const double sm_maj = plan->sm_maj, sm_min = plan->sm_min;
 
     // Precompute sin/cos per column (x) and row (y) to avoid recomputing them
     // 'height' and 'width' times, respectively.
@@ -500,43 +1123,54 @@ int compute_navigation_nc(const char *filename, DataF *navla, DataF *navlo) {
     double *csy_arr = malloc(height * sizeof(double));
     if (!snx_arr || !csx_arr || !sny_arr || !csy_arr) {
         free(snx_arr); free(csx_arr); free(sny_arr); free(csy_arr);
-        nav_plan_destroy(&plan);
         LOG_ERROR("Memory error while precomputing navigation sin/cos");
         return -1;
     }
     for (size_t i = 0; i < width; i++) {
-        snx_arr[i] = sin(plan.x_rad[i]);
-        csx_arr[i] = cos(plan.x_rad[i]);
+        snx_arr[i] = sin(plan->x_rad[x0 + i]);
+        csx_arr[i] = cos(plan->x_rad[x0 + i]);
     }
     for (size_t j = 0; j < height; j++) {
-        sny_arr[j] = sin(plan.y_rad[j]);
-        csy_arr[j] = cos(plan.y_rad[j]);
+        sny_arr[j] = sin(plan->y_rad[y0 + j]);
+        csy_arr[j] = cos(plan->y_rad[y0 + j]);
     }
-    nav_plan_destroy(&plan);
 
     const double sm_maj2 = sm_maj * sm_maj;
     const double sm_min2 = sm_min * sm_min;
     const double ratio   = sm_maj2 / sm_min2;
     const double H2_maj2 = H * H - sm_maj2;
+    const NavConsts k = {H, lambda_0, sm_maj2, sm_min2, H2_maj2, rad2deg, NonData};
 
     double lomin = 1e10, lamin = 1e10, lomax = -lomin, lamax = -lamin;
     size_t valid_count = 0;
+    const NavKernel kernel = nav_kernel();
 
     double t0 = omp_get_wtime();
 #pragma omp parallel for schedule(static) \
     reduction(min : lamin, lomin) reduction(max : lamax, lomax) reduction(+ : valid_count)
-    for (size_t j = 0; j < navla->height; j++) {
+    for (size_t j = 0; j < height; j++) {
         double sny = sny_arr[j], csy = csy_arr[j];
         double csy2 = csy * csy, rat_sny2 = ratio * sny * sny;
-        for (size_t i = 0; i < navla->width; i++) {
+        float *la_row = navla->data_in + j * width;
+        float *lo_row = navlo->data_in + j * width;
+        if (kernel == NAV_KERNEL_SIMD) {
+            navigation_row_simd(snx_arr, csx_arr, width, sny, csy, csy2 + rat_sny2, &k, la_row,
+                                lo_row, &lamin, &lamax, &lomin, &lomax, &valid_count);
+            continue;
+        }
+        if (kernel == NAV_KERNEL_FLOAT) {
+            navigation_row_float(snx_arr, csx_arr, width, sny, csy, csy2 + rat_sny2, &k, la_row,
+                                 lo_row, &lamin, &lamax, &lomin, &lomax, &valid_count);
+            continue;
+        }
+        for (size_t i = 0; i < width; i++) {
             double snx = snx_arr[i], csx = csx_arr[i];
             double a   = snx * snx + csx * csx * (csy2 + rat_sny2);
             double b   = -2.0 * H * csx * csy;
             double disc = b * b - 4.0 * a * H2_maj2;
-            size_t k = j * navla->width + i;
             if (disc < 0.0) {
-                navla->data_in[k] = NonData;
-                navlo->data_in[k] = NonData;
+                la_row[i] = NonData;
+                lo_row[i] = NonData;
             } else {
                 double rs  = (-b - sqrt(disc)) / (2.0 * a);
                 double px  = rs * csx * csy;
@@ -545,8 +1179,8 @@ int compute_navigation_nc(const char *filename, DataF *navla, DataF *navlo) {
                 double la  = atan2(sm_maj2 * pz,
                                    sm_min2 * sqrt((H - px) * (H - px) + py * py)) * rad2deg;
                 double lo = (lambda_0 - atan2(py, H - px)) * rad2deg;
-                navla->data_in[k] = (float)la;
-                navlo->data_in[k] = (float)lo;
+                la_row[i] = (float)la;
+                lo_row[i] = (float)lo;
                 if (la < lamin) lamin = la;
                 if (la > lamax) lamax = la;
                 if (lo < lomin) lomin = lo;
@@ -556,7 +1190,8 @@ int compute_navigation_nc(const char *filename, DataF *navla, DataF *navlo) {
         }
     }
     free(snx_arr); free(csx_arr); free(sny_arr); free(csy_arr);
-    LOG_TIMING(omp_get_wtime() - t0, "Navigation (%zux%zu)", navla->width, navla->height);
+    LOG_TIMING(omp_get_wtime() - t0, "Navigation (%zux%zu, %s)", width, height,
+               kernel == NAV_KERNEL_LIBM ? "libm" : (kernel == NAV_KERNEL_SIMD ? "simd" : "simd float"));
 
     // Update lat/lon range only if valid pixels were found.
     if (valid_count > 0) {
@@ -572,7 +1207,62 @@ int compute_navigation_nc(const char *filename, DataF *navla, DataF *navlo) {
         navlo->fmax = 180.0f;
         LOG_WARN("No valid navigation pixels in compute_navigation_nc; using default extents.");
     }
+    return 0;
+}
+
+// Off-disk pixels are NonData in both grids at once, so they share the spans
+// of the window at (x0, y0) of the plan's grid.
+static void navigation_attach_spans(const NavPlan *plan, size_t x0, size_t y0, DataF *navla,
+                                    DataF *navlo) {
+    navla->spans = nav_disk_spans(plan, x0, y0, 1, navla->width, navla->height);
+    navlo->spans = disk_spans_copy(navla->spans);
+}
+
+int compute_navigation_nc(const char *filename, DataF *navla, DataF *navlo) {
+    NavPlan plan;
+    if (nav_build_plan(filename, &plan) != 0) return -1;
+    // Same geometry as an earlier run (HPSV_NAV_CACHE_DIR): map its grids.
+    if (nav_cache_map(&plan, navla, navlo) == 0) {
+        navigation_attach_spans(&plan, 0, 0, navla, navlo);
+        nav_plan_destroy(&plan);
+        return 0;
+    }
+
+    *navla = dataf_create(plan.width, plan.height);
+    *navlo = dataf_create(plan.width, plan.height);
+    if (!navla->data_in || !navlo->data_in ||
+        navigation_fill(&plan, 0, 0, navla, navlo) != 0) {
+        nav_plan_destroy(&plan);
+        dataf_destroy(navla);
+        dataf_destroy(navlo);
+        LOG_ERROR("Memory error allocating navigation grids");
+        return -1;
+    }
+
+    // Float grids (HPSV_NAV_FLOAT) are approximate: keep them out of the cache.
+    if (nav_kernel() != NAV_KERNEL_FLOAT) nav_cache_store(&plan, navla, navlo);
+    navigation_attach_spans(&plan, 0, 0, navla, navlo);
+    nav_plan_destroy(&plan);
+    return 0;
+}
+
+int compute_navigation_window(const NavPlan *plan, const PixelWindow *win,
+                              DataF *navla, DataF *navlo) {
+    if (!plan || !plan->x_rad || !plan->y_rad || !win || win->width == 0 ||
+        win->height == 0 || (size_t)win->x0 + win->width > plan->width ||
+        (size_t)win->y0 + win->height > plan->height)
+        return -1;
 
+    *navla = dataf_create(win->width, win->height);
+    *navlo = dataf_create(win->width, win->height);
+    if (!navla->data_in || !navlo->data_in ||
+        navigation_fill(plan, win->x0, win->y0, navla, navlo) != 0) {
+        dataf_destroy(navla);
+        dataf_destroy(navlo);
+        LOG_ERROR("Memory error allocating navigation grids");
+        return -1;
+    }
+    navigation_attach_spans(plan, win->x0, win->y0, navla, navlo);
     return 0;
 }
 
@@ -668,23 +1358,21 @@ static SolarEphemeris solar_ephemeris(int year, int month, int day, int hour, in
 /// Per-pixel solar zenith/azimuth from the precomputed ephemeris + pixel lat/lon.
 /// Identical math to the original monolithic version; the CUDA kernel mirrors
 /// this body exactly (src/cuda/nav_cuda.cu).
-static void sun_angles_from_ephemeris(float la, float lo, SolarEphemeris e,
-                                      double *zenith_out, double *azimuth_out) {
+/// Takes sin(latitude) and the longitude in radians, so that a caller that
+/// also needs them for the satellite angles solves them once.
+static void sun_angles_sincos(double sp, double Longitude, SolarEphemeris e,
+                              double *zenith_out, double *azimuth_out) {
     const double PI = M_PI;
     const double PI2 = 2 * M_PI;
     const double PIM = M_PI_2;
     const double Pressure = 1;
     const double Temperature = 0;
 
-    double Longitude = lo * PI / 180.0;
-    double Latitude = la * PI / 180.0;
-
     double HourAngle = e.ha_base + Longitude;
     HourAngle = fmod(HourAngle + PI, PI2) - PI;
     if (HourAngle < -PI)
         HourAngle += PI2;
 
-    double sp = sin(Latitude);
     double cp = sqrt(1 - sp * sp);
     double sH = sin(HourAngle);
     double cH = cos(HourAngle);
@@ -706,32 +1394,33 @@ static void sun_angles_from_ephemeris(float la, float lo, SolarEphemeris e,
         *azimuth_out = Azimuth * 180.0 / M_PI;
 }
 
+static void sun_angles_from_ephemeris(float la, float lo, SolarEphemeris e,
+                                      double *zenith_out, double *azimuth_out) {
+    double Longitude = lo * M_PI / 180.0;
+    double Latitude = la * M_PI / 180.0;
+    sun_angles_sincos(sin(Latitude), Longitude, e, zenith_out, azimuth_out);
+}
+
 static void compute_sun_geometry(float la, float lo, int year, int month, int day, int hour,
                                  int min, int sec, double *zenith_out, double *azimuth_out) {
     SolarEphemeris e = solar_ephemeris(year, month, day, hour, min, sec);
     sun_angles_from_ephemeris(la, lo, e, zenith_out, azimuth_out);
 }
 
-/// Computes satellite viewing zenith/azimuth angle for a pixel, from the geometry between the pixel and the geostationary sub-satellite position.
-static void compute_satellite_view_angles(float pixel_lat, float pixel_lon, float sat_lon,
-                                          float sat_height, double *vza_out, double *vaa_out) {
+/// Satellite viewing zenith/azimuth of a pixel from sin/cos of its latitude
+/// and longitude and the geocentric satellite position (x_sat, y_sat, 0), so
+/// that none of them is solved again per pixel.
+static void satellite_view_sincos(double slat, double clat, double slon, double clon,
+                                  double x_sat, double y_sat, double *vza_out,
+                                  double *vaa_out) {
     const double a = 6378137.0;           // WGS84 semi-major axis (m)
     const double f = 1.0 / 298.257223563; // WGS84 flattening
 
-    double lat_rad = pixel_lat * M_PI / 180.0;
-    double lon_rad = pixel_lon * M_PI / 180.0;
-    double sat_lon_rad = sat_lon * M_PI / 180.0;
-
     // Pixel position in geocentric Cartesian coordinates.
-    double N = a / sqrt(1.0 - (2.0 * f - f * f) * sin(lat_rad) * sin(lat_rad));
-    double x_pixel = N * cos(lat_rad) * cos(lon_rad);
-    double y_pixel = N * cos(lat_rad) * sin(lon_rad);
-    double z_pixel = N * (1.0 - (2.0 * f - f * f)) * sin(lat_rad);
-
-    // Geostationary satellite position (equatorial plane, at sat_lon).
-    double sat_radius = a + sat_height;
-    double x_sat = sat_radius * cos(sat_lon_rad);
-    double y_sat = sat_radius * sin(sat_lon_rad);
+    double N = a / sqrt(1.0 - (2.0 * f - f * f) * slat * slat);
+    double x_pixel = N * clat * clon;
+    double y_pixel = N * clat * slon;
+    double z_pixel = N * (1.0 - (2.0 * f - f * f)) * slat;
     double z_sat = 0.0;
 
     // Unit view vector from satellite to pixel.
@@ -753,13 +1442,13 @@ static void compute_satellite_view_angles(float pixel_lat, float pixel_lon, floa
     double vza = acos(fmax(-1.0, fmin(1.0, cos_vza))) * 180.0 / M_PI;
 
     // VAA: projection onto local ENU (East-North-Up) frame.
-    double east_x = -sin(lon_rad);
-    double east_y = cos(lon_rad);
+    double east_x = -slon;
+    double east_y = clon;
     double east_z = 0.0;
 
-    double north_x = -sin(lat_rad) * cos(lon_rad);
-    double north_y = -sin(lat_rad) * sin(lon_rad);
-    double north_z = cos(lat_rad);
+    double north_x = -slat * clon;
+    double north_y = -slat * slon;
+    double north_z = clat;
 
     double view_east = dx * east_x + dy * east_y + dz * east_z;
     double view_north = dx * north_x + dy * north_y + dz * north_z;
@@ -771,6 +1460,26 @@ static void compute_satellite_view_angles(float pixel_lat, float pixel_lon, floa
         *vaa_out = vaa;
 }
 
+// Geostationary satellite position (equatorial plane, at sat_lon).
+static void satellite_position(float sat_lon, float sat_height, double *x_sat, double *y_sat) {
+    const double a = 6378137.0; // WGS84 semi-major axis (m)
+    double sat_lon_rad = sat_lon * M_PI / 180.0;
+    double sat_radius = a + sat_height;
+    *x_sat = sat_radius * cos(sat_lon_rad);
+    *y_sat = sat_radius * sin(sat_lon_rad);
+}
+
+/// Computes satellite viewing zenith/azimuth angle for a pixel, from the geometry between the pixel and the geostationary sub-satellite position.
+static void compute_satellite_view_angles(float pixel_lat, float pixel_lon, float sat_lon,
+                                          float sat_height, double *vza_out, double *vaa_out) {
+    double lat_rad = pixel_lat * M_PI / 180.0;
+    double lon_rad = pixel_lon * M_PI / 180.0;
+    double x_sat, y_sat;
+    satellite_position(sat_lon, sat_height, &x_sat, &y_sat);
+    satellite_view_sincos(sin(lat_rad), cos(lat_rad), sin(lon_rad), cos(lon_rad), x_sat, y_sat,
+                          vza_out, vaa_out);
+}
+
 int reader_solar_ephemeris_from_file(const char *filename, SolarEphemeris *out) {
     if (!out) return ERRCODE;
     int ncid, retval;
@@ -808,6 +1517,13 @@ int reader_read_satellite_params(const char *filename, float *sat_lon, float *sa
     return 0;
 }
 
+// NonData in row y of `d` outside [x0, x1): the pixels off the disk.
+static void fill_off_span(DataF *d, unsigned int y, unsigned int x0, unsigned int x1) {
+    float *row = d->data_in + (size_t)y * d->width;
+    for (unsigned int x = 0; x < x0; x++) row[x] = NonData;
+    for (unsigned int x = x1; x < d->width; x++) row[x] = NonData;
+}
+
 int compute_solar_angles_nc(const char *filename, const DataF *navla, const DataF *navlo,
                             DataF *sza, DataF *saa) {
     int ncid, retval;
@@ -854,21 +1570,29 @@ int compute_solar_angles_nc(const char *filename, const DataF *navla, const Data
 
     double start_time = omp_get_wtime();
 
-// Per-pixel solar geometry calculation.
+// Per-pixel solar geometry calculation, over the disk only (navla spans).
 #pragma omp parallel for
-    for (size_t i = 0; i < navla->size; i++) {
-        float la = navla->data_in[i];
-        float lo = navlo->data_in[i];
-        if (IS_NONDATA(la) || IS_NONDATA(lo)) {
-            sza->data_in[i] = NonData;
-            saa->data_in[i] = NonData;
-        } else {
-            double zen, azi;
-            compute_sun_geometry(la, lo, year, month, day, hour, min, sec, &zen, &azi);
-            sza->data_in[i] = (float)zen;
-            saa->data_in[i] = (float)azi;
+    for (unsigned int y = 0; y < navla->height; y++) {
+        unsigned int x0, x1;
+        dataf_row_span(navla, y, &x0, &x1);
+        fill_off_span(sza, y, x0, x1);
+        fill_off_span(saa, y, x0, x1);
+        for (size_t i = (size_t)y * navla->width + x0; i < (size_t)y * navla->width + x1; i++) {
+            float la = navla->data_in[i];
+            float lo = navlo->data_in[i];
+            if (IS_NONDATA(la) || IS_NONDATA(lo)) {
+                sza->data_in[i] = NonData;
+                saa->data_in[i] = NonData;
+            } else {
+                double zen, azi;
+                compute_sun_geometry(la, lo, year, month, day, hour, min, sec, &zen, &azi);
+                sza->data_in[i] = (float)zen;
+                saa->data_in[i] = (float)azi;
+            }
         }
     }
+    sza->spans = disk_spans_copy(navla->spans);
+    saa->spans = disk_spans_copy(navla->spans);
 
     double elapsed = omp_get_wtime() - start_time;
     LOG_TIMING(elapsed, "Solar geometry");
@@ -912,21 +1636,29 @@ int compute_satellite_angles_nc(const char *filename, const DataF *navla, const
 
     double start_time = omp_get_wtime();
 
-// Per-pixel satellite viewing geometry calculation.
+// Per-pixel satellite viewing geometry calculation, over the disk only.
 #pragma omp parallel for
-    for (size_t i = 0; i < navla->size; i++) {
-        float la = navla->data_in[i];
-        float lo = navlo->data_in[i];
-        if (IS_NONDATA(la) || IS_NONDATA(lo)) {
-            vza->data_in[i] = NonData;
-            vaa->data_in[i] = NonData;
-        } else {
-            double vzen, vazi;
-            compute_satellite_view_angles(la, lo, sat_lon, sat_height_m, &vzen, &vazi);
-            vza->data_in[i] = (float)vzen;
-            vaa->data_in[i] = (float)vazi;
+    for (unsigned int y = 0; y < navla->height; y++) {
+        unsigned int x0, x1;
+        dataf_row_span(navla, y, &x0, &x1);
+        fill_off_span(vza, y, x0, x1);
+        fill_off_span(vaa, y, x0, x1);
+        for (size_t i = (size_t)y * navla->width + x0; i < (size_t)y * navla->width + x1; i++) {
+            float la = navla->data_in[i];
+            float lo = navlo->data_in[i];
+            if (IS_NONDATA(la) || IS_NONDATA(lo)) {
+                vza->data_in[i] = NonData;
+                vaa->data_in[i] = NonData;
+            } else {
+                double vzen, vazi;
+                compute_satellite_view_angles(la, lo, sat_lon, sat_height_m, &vzen, &vazi);
+                vza->data_in[i] = (float)vzen;
+                vaa->data_in[i] = (float)vazi;
+            }
         }
     }
+    vza->spans = disk_spans_copy(navla->spans);
+    vaa->spans = disk_spans_copy(navla->spans);
 
     double elapsed = omp_get_wtime() - start_time;
     LOG_TIMING(elapsed, "Satellite geometry");
@@ -942,23 +1674,105 @@ void compute_relative_azimuth(const DataF *saa, const DataF *vaa, DataF *raa) {
         return;
     }
 
+    // Both angles come from the same navigation: NonData off the saa spans.
 #pragma omp parallel for
-    for (size_t i = 0; i < saa->size; i++) {
-        float sa = saa->data_in[i];
-        float va = vaa->data_in[i];
+    for (unsigned int y = 0; y < saa->height; y++) {
+        unsigned int x0, x1;
+        dataf_row_span(saa, y, &x0, &x1);
+        fill_off_span(raa, y, x0, x1);
+        for (size_t i = (size_t)y * saa->width + x0; i < (size_t)y * saa->width + x1; i++) {
+            float sa = saa->data_in[i];
+            float va = vaa->data_in[i];
+
+            if (sa == NonData || va == NonData) {
+                raa->data_in[i] = NonData;
+            } else {
+                float diff = fabsf(sa - va);
 
-        if (sa == NonData || va == NonData) {
-            raa->data_in[i] = NonData;
-        } else {
-            float diff = fabsf(sa - va);
+                if (diff > 180.0f) {
+                    diff = 360.0f - diff;
+                }
 
-            if (diff > 180.0f) {
-                diff = 360.0f - diff;
+                raa->data_in[i] = diff;
             }
-
-            raa->data_in[i] = diff;
         }
     }
+    raa->spans = disk_spans_copy(saa->spans);
 
     LOG_INFO("Relative azimuth computed for %zu pixels.", raa->size);
 }
+
+int reader_view_ephemeris_from_file(const char *filename, ViewEphemeris *out) {
+    if (!out) return ERRCODE;
+    if (reader_solar_ephemeris_from_file(filename, &out->sun) != 0 ||
+        reader_read_satellite_params(filename, &out->sat_lon, &out->sat_height_m) != 0)
+        return ERRCODE;
+    satellite_position(out->sat_lon, out->sat_height_m, &out->x_sat, &out->y_sat);
+    return 0;
+}
+
+void compute_view_geometry_at(float la, float lo, const ViewEphemeris *v, float *sza, float *vza,
+                              float *raa) {
+    if (IS_NONDATA(la) || IS_NONDATA(lo)) {
+        *sza = *vza = *raa = NonData;
+        return;
+    }
+    // sin/cos of latitude and longitude serve both the sun and the satellite.
+    double lat_rad = la * M_PI / 180.0;
+    double lon_rad = lo * M_PI / 180.0;
+    double slat = sin(lat_rad), clat = cos(lat_rad);
+    double slon = sin(lon_rad), clon = cos(lon_rad);
+    double zen, azi, vzen, vazi;
+    sun_angles_sincos(slat, lon_rad, v->sun, &zen, &azi);
+    satellite_view_sincos(slat, clat, slon, clon, v->x_sat, v->y_sat, &vzen, &vazi);
+    // Same float rounding and fold as the grids of compute_relative_azimuth().
+    float diff = fabsf((float)azi - (float)vazi);
+    if (diff > 180.0f)
+        diff = 360.0f - diff;
+    *sza = (float)zen;
+    *vza = (float)vzen;
+    *raa = diff;
+}
+
+int compute_view_geometry_nc(const char *filename, const DataF *navla, const DataF *navlo,
+                             DataF *sza, DataF *vza, DataF *raa) {
+    ViewEphemeris eph;
+    if (reader_view_ephemeris_from_file(filename, &eph) != 0)
+        return ERRCODE;
+
+    LOG_INFO("Computing viewing geometry in one pass (sub-point: %.1f°E, altitude: %.0f m)",
+             eph.sat_lon, eph.sat_height_m);
+
+    *sza = dataf_create(navla->width, navla->height);
+    *vza = dataf_create(navla->width, navla->height);
+    *raa = dataf_create(navla->width, navla->height);
+    if (sza->data_in == NULL || vza->data_in == NULL || raa->data_in == NULL) {
+        LOG_FATAL("Memory allocation failed for viewing geometry maps.");
+        dataf_destroy(sza);
+        dataf_destroy(vza);
+        dataf_destroy(raa);
+        return ERRCODE;
+    }
+
+    double start_time = omp_get_wtime();
+
+    // Sun ephemeris and satellite position hoisted out of the loop, and no
+    // SAA/VAA grids: the azimuths only live long enough to be folded into RAA.
+#pragma omp parallel for
+    for (unsigned int y = 0; y < navla->height; y++) {
+        unsigned int x0, x1;
+        dataf_row_span(navla, y, &x0, &x1);
+        fill_off_span(sza, y, x0, x1);
+        fill_off_span(vza, y, x0, x1);
+        fill_off_span(raa, y, x0, x1);
+        for (size_t i = (size_t)y * navla->width + x0; i < (size_t)y * navla->width + x1; i++)
+            compute_view_geometry_at(navla->data_in[i], navlo->data_in[i], &eph,
+                                     &sza->data_in[i], &vza->data_in[i], &raa->data_in[i]);
+    }
+    sza->spans = disk_spans_copy(navla->spans);
+    vza->spans = disk_spans_copy(navla->spans);
+    raa->spans = disk_spans_copy(navla->spans);
+
+    LOG_TIMING(omp_get_wtime() - start_time, "Viewing geometry (fused)");
+    return 0;
+}
@@ -14,9 +14,26 @@
  *
  * Anything outside the expected layout falls back (returns non-zero) so the
  * caller re-reads with nc_get_var — correctness never depends on this path.
+ *
+ * With HPSV_CHUNK_CACHE_DIR set, the chunk index found here is saved to a
+ * sidecar file (src/chunk_index_cache.c) and later reads of the same file skip
+ * HDF5 entirely: no open, no index walk, just pread + inflate.
+ *
+ * A pixel window (read_var_chunked_deflate_window) restricts the fetch and the
+ * inflate to the chunks that intersect it: a clip of Mexico out of a full-disk
+ * 0.5 km band touches a few dozen of its 9216 chunks.
+ *
+ * With a ChunkConverter (read_var_chunked_deflate_convert) each decoded chunk is
+ * calibrated straight into the destination grid inside the same parallel task,
+ * so the caller never holds the whole variable as raw integers.
+ *
+ * With a box factor as well (read_var_chunked_deflate_boxfilter) the calibrated
+ * chunks are averaged down band by band as they are decoded: a 0.5 km band
+ * loaded for a 2 km composite never exists at full resolution in memory.
  */
 
 #include "reader_nc_chunk.h"
+#include "chunk_index_cache.h"
 #include "logger.h"
 
 #include <fcntl.h>
@@ -45,9 +62,9 @@ static void unshuffle(const uint8_t *shuf, uint8_t *out, size_t nelem,
  * is an all-fill region — the same thing the per-chunk lookup reports as
  * HADDR_UNDEF. */
 typedef struct {
-  hsize_t *rawsize;
-  unsigned *fmask;
-  haddr_t *rawaddr; /* offset de cada chunk dentro del archivo, para pread() */
+  uint64_t *rawsize;
+  uint32_t *fmask;
+  uint64_t *rawaddr; /* offset de cada chunk dentro del archivo, para pread() */
   size_t nchx, nchy, chy, chx;
   bool ok;
 } ChunkIndex;
@@ -69,80 +86,470 @@ static int chunk_index_cb(const hsize_t *offset, unsigned filter_mask,
 }
 #endif
 
-int read_var_chunked_deflate(const char *filename, const char *varname,
-                             void *out, size_t nx, size_t ny,
-                             size_t elem_size) {
-  if (elem_size != 2) return 1; /* only int16/uint16 handled */
-
-  /* Escape hatch: HPSV_DISABLE_FAST_READ=1 forces the nc_get_var fallback (for
-   * A/B validation or if a future file layout ever misbehaves in production). */
-  if (getenv("HPSV_DISABLE_FAST_READ")) return 1;
+/* Return codes of read_chunked(); anything else non-zero means "fall back". */
+enum { READ_OK = 0, READ_FALLBACK = 1, READ_STALE_CACHE = 2 };
 
-  /* Silence HDF5's automatic error stack printing; we handle failures. */
-  H5Eset_auto2(H5E_DEFAULT, NULL, NULL);
+/* HDF5 (and netCDF-4 on top of it) is not built thread-safe by the distributions
+ * we run on, and several variables may be loaded at once (load_nc_sf_batch).
+ * Every HDF5 call below therefore runs inside critical(hpsv_hdf5), the same
+ * section reader_nc.c uses for its netCDF calls; pread and inflate stay outside,
+ * which is what lets one load's serial phase overlap another's decode. */
 
-  int rc = 1; /* default: fall back */
+/* Opens varname and checks it has the layout we decode (rank 2, {ny, nx},
+ * little-endian elem_size elements, chunked, shuffle + deflate). On success
+ * fills the shape, fill value and base address of lay and leaves file/dset
+ * open. Call inside critical(hpsv_hdf5). */
+static bool h5_open_layout(const char *filename, const char *varname, size_t nx,
+                           size_t ny, size_t elem_size, ChunkLayout *lay,
+                           hid_t *file_out, hid_t *dset_out) {
+  bool ok = false;
   hid_t file = -1, dset = -1, space = -1, dcpl = -1, dtype = -1;
-  uint8_t **raw = NULL;
-  hsize_t *rawsize = NULL;
-  unsigned *fmask = NULL;
-  haddr_t *rawaddr = NULL;
-  int fd = -1;
-  size_t nchunks = 0;               /* set once known; keeps cleanup safe */
-  size_t chy = 0, chx = 0, nchx = 0, nchy = 0, chunk_bytes = 0;
-  int16_t fillval = 0;
 
   file = H5Fopen(filename, H5F_ACC_RDONLY, H5P_DEFAULT);
-  if (file < 0) goto done;
+  if (file < 0) goto out;
 
   dset = H5Dopen2(file, varname, H5P_DEFAULT);
-  if (dset < 0) goto done;
+  if (dset < 0) goto out;
 
   /* Rank 2, dims == {ny, nx}. */
   space = H5Dget_space(dset);
-  if (space < 0 || H5Sget_simple_extent_ndims(space) != 2) goto done;
+  if (space < 0 || H5Sget_simple_extent_ndims(space) != 2) goto out;
   hsize_t dims[2];
-  if (H5Sget_simple_extent_dims(space, dims, NULL) < 0) goto done;
-  if (dims[0] != ny || dims[1] != nx) goto done;
+  if (H5Sget_simple_extent_dims(space, dims, NULL) < 0) goto out;
+  if (dims[0] != ny || dims[1] != nx) goto out;
 
-  /* Little-endian, 2-byte integer element. */
+  /* Element of elem_size bytes (1, 2, 4 or 8), little-endian. A 1-byte type
+   * has no byte order (HDF5 may report H5T_ORDER_NONE), so it is not checked. */
   dtype = H5Dget_type(dset);
   if (dtype < 0 || H5Tget_size(dtype) != elem_size ||
-      H5Tget_order(dtype) != H5T_ORDER_LE)
-    goto done;
+      (elem_size > 1 && H5Tget_order(dtype) != H5T_ORDER_LE))
+    goto out;
 
   /* Chunked layout, filters == shuffle (index 0) then deflate (index 1). */
   dcpl = H5Dget_create_plist(dset);
-  if (dcpl < 0 || H5Pget_layout(dcpl) != H5D_CHUNKED) goto done;
+  if (dcpl < 0 || H5Pget_layout(dcpl) != H5D_CHUNKED) goto out;
   hsize_t cdims[2];
-  if (H5Pget_chunk(dcpl, 2, cdims) < 0) goto done;
-  chy = (size_t)cdims[0];
-  chx = (size_t)cdims[1];
-  if (chy == 0 || chx == 0) goto done;
+  if (H5Pget_chunk(dcpl, 2, cdims) < 0) goto out;
+  lay->chy = (size_t)cdims[0];
+  lay->chx = (size_t)cdims[1];
+  if (lay->chy == 0 || lay->chx == 0) goto out;
 
-  if (H5Pget_nfilters(dcpl) != 2) goto done;
+  if (H5Pget_nfilters(dcpl) != 2) goto out;
   for (unsigned fi = 0; fi < 2; fi++) {
     unsigned flags = 0, cd[8];
     size_t cd_n = 8;
     H5Z_filter_t fid =
         H5Pget_filter2(dcpl, fi, &flags, &cd_n, cd, 0, NULL, NULL);
-    if (fi == 0 && fid != H5Z_FILTER_SHUFFLE) goto done;
-    if (fi == 1 && fid != H5Z_FILTER_DEFLATE) goto done;
+    if (fi == 0 && fid != H5Z_FILTER_SHUFFLE) goto out;
+    if (fi == 1 && fid != H5Z_FILTER_DEFLATE) goto out;
   }
 
   /* Fill value for any unallocated chunks (all-fill regions). */
-  if (H5Pget_fill_value(dcpl, dtype, &fillval) < 0) fillval = 0;
+  if (H5Pget_fill_value(dcpl, dtype, lay->fillval) < 0)
+    memset(lay->fillval, 0, sizeof(lay->fillval));
+
+  /* Chunk addresses are relative to the file's base address, which is not 0
+   * if the file has a user block (netCDF-4 files have none; harmless). */
+  hid_t fcpl = H5Fget_create_plist(file);
+  if (fcpl >= 0) {
+    hsize_t ub = 0;
+    if (H5Pget_userblock(fcpl, &ub) >= 0) lay->base_addr = ub;
+    H5Pclose(fcpl);
+  }
+  ok = true;
+
+out:
+  if (dtype >= 0) H5Tclose(dtype);
+  if (dcpl >= 0) H5Pclose(dcpl);
+  if (space >= 0) H5Sclose(space);
+  if (ok) {
+    *file_out = file;
+    *dset_out = dset;
+  } else {
+    if (dset >= 0) H5Dclose(dset);
+    if (file >= 0) H5Fclose(file);
+  }
+  return ok;
+}
+
+/* Fills rawsize[]/fmask[]/rawaddr[] of lay from the dataset's chunk index: the
+ * whole index in one walk on HDF5 >= 1.14, otherwise one lookup per selected
+ * chunk (then *complete tells whether that was every chunk). Call inside
+ * critical(hpsv_hdf5). */
+static bool h5_walk_index(hid_t dset, ChunkLayout *lay, size_t nchx,
+                          const size_t *sel, size_t nsel, double *t_index,
+                          bool *complete) {
+  bool ok = true;
+  *complete = true;
+#if H5_VERSION_GE(1, 14, 0)
+  (void)sel;
+  (void)nsel;
+  ChunkIndex idx = {lay->rawsize, lay->fmask, lay->rawaddr, nchx,
+                    (lay->ny + lay->chy - 1) / lay->chy, lay->chy, lay->chx, true};
+  double t0i = omp_get_wtime();
+  if (H5Dchunk_iter(dset, H5P_DEFAULT, chunk_index_cb, &idx) < 0 || !idx.ok)
+    ok = false;
+  *t_index = omp_get_wtime() - t0i;
+#else
+  *complete = (nsel == lay->nchunks);
+  for (size_t j = 0; j < nsel; j++) {
+    size_t k = sel[j];
+    hsize_t offset[2] = {(hsize_t)((k / nchx) * lay->chy),
+                         (hsize_t)((k % nchx) * lay->chx)};
+    haddr_t addr = HADDR_UNDEF;
+    hsize_t csize = 0;
+    unsigned mask = 0;
+    double t0i = omp_get_wtime();
+    herr_t info_err = H5Dget_chunk_info_by_coord(dset, offset, &mask, &addr, &csize);
+    *t_index += omp_get_wtime() - t0i;
+    if (info_err < 0) { ok = false; break; }
+    if (addr == HADDR_UNDEF || csize == 0) continue; /* unallocated -> fill */
+    lay->rawsize[k] = csize;
+    lay->fmask[k] = mask;
+    lay->rawaddr[k] = addr;
+  }
+#endif
+  return ok;
+}
+
+/* Serial fetch of the selected chunks with H5Dread_chunk. Call inside
+ * critical(hpsv_hdf5). */
+static bool h5_fetch_chunks(hid_t dset, const ChunkLayout *lay, size_t nchx,
+                            const size_t *sel, size_t nsel, uint8_t **raw) {
+  for (size_t j = 0; j < nsel; j++) {
+    size_t k = sel[j];
+    if (lay->rawsize[k] == 0) { raw[k] = NULL; continue; } /* all-fill region */
+    hsize_t offset[2] = {(hsize_t)((k / nchx) * lay->chy),
+                         (hsize_t)((k % nchx) * lay->chx)};
+    raw[k] = (uint8_t *)malloc(lay->rawsize[k]);
+    if (!raw[k]) return false;
+    unsigned mask = lay->fmask[k];
+    if (H5Dread_chunk(dset, H5P_DEFAULT, offset, &mask, raw[k]) < 0) return false;
+  }
+  return true;
+}
+
+/* Decodes chunk k (raw == NULL: unallocated, all fill) and scatters the part
+ * inside the window [x0, x0+w) x [y0, y0+h) into dst, whose row 0 is window row
+ * dst_r0 and whose rows are w elements of out_es bytes; this also clips the
+ * partial edge chunks of the grid. shuf/elems are per-thread scratch of one
+ * chunk. Returns false if the chunk does not inflate to its full size. */
+static bool decode_scatter(const ChunkLayout *lay, size_t k, size_t nchx,
+                           const uint8_t *raw,
+                           struct libdeflate_decompressor *dec, uint8_t *shuf,
+                           uint8_t *elems, size_t x0, size_t y0, size_t w,
+                           size_t h, uint8_t *dst, size_t dst_r0, size_t out_es,
+                           const ChunkConverter *conv, float *cmin,
+                           float *cmax) {
+  const unsigned SHUF_BIT = 0x1u; /* pipeline index 0 skipped */
+  const unsigned DEFL_BIT = 0x2u; /* pipeline index 1 skipped */
+  const size_t chy = lay->chy, chx = lay->chx, elem_size = lay->elem_size;
+  const size_t chunk_bytes = chy * chx * elem_size;
+  size_t r0 = (k / nchx) * chy, c0 = (k % nchx) * chx;
+
+  const uint8_t *elem_bytes;
+  if (raw == NULL) {
+    for (size_t i = 0; i < chy * chx; i++)
+      memcpy(elems + i * elem_size, lay->fillval, elem_size);
+    elem_bytes = elems;
+  } else {
+    const uint8_t *inflated;
+    if (lay->fmask[k] & DEFL_BIT) {
+      inflated = raw; /* deflate skipped for this chunk */
+    } else {
+      size_t got = 0;
+      if (libdeflate_zlib_decompress(dec, raw, lay->rawsize[k], shuf,
+                                     chunk_bytes, &got) != LIBDEFLATE_SUCCESS ||
+          got != chunk_bytes)
+        return false;
+      inflated = shuf;
+    }
+    if (lay->fmask[k] & SHUF_BIT) {
+      elem_bytes = inflated; /* shuffle skipped -> already interleaved */
+    } else {
+      unshuffle(inflated, elems, chy * chx, elem_size);
+      elem_bytes = elems;
+    }
+  }
+
+  size_t rs = r0 > y0 ? r0 : y0, cs = c0 > x0 ? c0 : x0;
+  size_t re = r0 + chy < y0 + h ? r0 + chy : y0 + h;
+  size_t ce = c0 + chx < x0 + w ? c0 + chx : x0 + w;
+  for (size_t r = rs; r < re; r++) {
+    uint8_t *d = dst + ((r - y0 - dst_r0) * w + (cs - x0)) * out_es;
+    const uint8_t *src = elem_bytes + ((r - r0) * chx + (cs - c0)) * elem_size;
+    if (conv)
+      conv->convert(src, d, ce - cs, conv->arg, cmin, cmax);
+    else
+      memcpy(d, src, (ce - cs) * elem_size);
+  }
+  return true;
+}
+
+/* One window read for decode_window(). The compressed bytes of each chunk come
+ * from raw[] when it was filled beforehand by H5Dread_chunk, otherwise from
+ * pread() on fd right before the chunk is inflated. */
+typedef struct {
+  const ChunkLayout *lay;
+  const size_t *sel; /* chunks that intersect the window, row-major */
+  size_t nsel, nselx, nchx, cy0, cy1;
+  size_t x0, y0, w, h, factor;
+  const ChunkConverter *conv;
+  void *out;
+  uint8_t *const *raw; /* NULL: pread on fd */
+  int fd;
+} WindowDecode;
+
+enum { DECODE_OK = 0, DECODE_BAD_CHUNK = 1, DECODE_BAD_FETCH = 2 };
+
+/* Compressed bytes of chunk k in *bytes: NULL for an unallocated chunk (all
+ * fill), raw[k], or the chunk pread into the caller's buffer *buf, which is
+ * grown to *cap as needed and reused for the next chunk. */
+static bool fetch_chunk(const WindowDecode *d, size_t k, uint8_t **buf,
+                        size_t *cap, const uint8_t **bytes) {
+  const ChunkLayout *lay = d->lay;
+  *bytes = NULL;
+  if (lay->rawsize[k] == 0) return true;
+  if (d->raw) {
+    *bytes = d->raw[k];
+    return true;
+  }
+  if (lay->rawaddr[k] == HADDR_UNDEF) return false;
+  size_t need = (size_t)lay->rawsize[k];
+  if (need > *cap) {
+    uint8_t *nb = (uint8_t *)realloc(*buf, need);
+    if (!nb) return false;
+    *buf = nb;
+    *cap = need;
+  }
+  /* pread puede devolver menos de lo pedido; hay que insistir. */
+  size_t got = 0;
+  while (got < need) {
+    ssize_t n = pread(d->fd, *buf + got, need - got,
+                      (off_t)(lay->rawaddr[k] + lay->base_addr + got));
+    if (n <= 0) return false;
+    got += (size_t)n;
+  }
+  *bytes = *buf;
+  return true;
+}
+
+/* Asks the kernel to start reading chunk k ahead of time. On a latency-bound
+ * mount (NFS) this keeps requests in flight while the threads inflate; on a
+ * local disk it costs next to nothing. */
+static void prefetch_chunk(const WindowDecode *d, size_t k) {
+  const ChunkLayout *lay = d->lay;
+  if (d->raw || lay->rawsize[k] == 0 || lay->rawaddr[k] == HADDR_UNDEF) return;
+  posix_fadvise(d->fd, (off_t)(lay->rawaddr[k] + lay->base_addr),
+                (off_t)lay->rawsize[k], POSIX_FADV_WILLNEED);
+}
+
+/* Per-thread working memory of decode_window(). */
+typedef struct {
+  struct libdeflate_decompressor *dec;
+  uint8_t *shuf, *elems; /* one decoded chunk each */
+  uint8_t *cbuf;         /* compressed bytes of the current chunk, recycled */
+  size_t ccap;
+} DecodeScratch;
+
+/* Fetches sel[j] and decodes it into dst (see decode_scatter), hinting the chunk
+ * `lookahead` places further on. Returns a DECODE_* code. */
+static int fetch_decode(const WindowDecode *d, size_t j, size_t lookahead,
+                        DecodeScratch *t, uint8_t *dst, size_t dst_r0,
+                        size_t out_es, float *cmin, float *cmax) {
+  const uint8_t *bytes;
+  if (!fetch_chunk(d, d->sel[j], &t->cbuf, &t->ccap, &bytes))
+    return DECODE_BAD_FETCH;
+  if (j + lookahead < d->nsel) prefetch_chunk(d, d->sel[j + lookahead]);
+  if (!decode_scatter(d->lay, d->sel[j], d->nchx, bytes, t->dec, t->shuf,
+                      t->elems, d->x0, d->y0, d->w, d->h, dst, dst_r0, out_es,
+                      d->conv, cmin, cmax))
+    return DECODE_BAD_CHUNK;
+  return DECODE_OK;
+}
+
+/* Fetches (if needed) and decodes the selected chunks into d->out; see
+ * read_chunked() for the meaning of factor. Each thread handles one chunk at a
+ * time start to finish, so compressed data in memory is bounded by one chunk
+ * per thread, and while some threads wait on I/O the others inflate. Returns
+ * DECODE_BAD_FETCH if a chunk could not be read (the caller may retry through
+ * HDF5), DECODE_BAD_CHUNK if one did not inflate. */
+static int decode_window(const WindowDecode *d, float *vmin, float *vmax) {
+  const ChunkLayout *lay = d->lay;
+  const size_t chy = lay->chy, chx = lay->chx, elem_size = lay->elem_size;
+  const size_t chunk_bytes = chy * chx * elem_size;
+  const size_t y0 = d->y0, w = d->w, h = d->h, factor = d->factor;
+  const size_t out_es = d->conv ? d->conv->out_elem_size : elem_size;
+  int failed = DECODE_OK;
+  float cmin = *vmin, cmax = *vmax;
+
+  /* With a box factor the window is decoded in bands of whole chunk rows into a
+   * float buffer, and every output row whose factor x factor blocks are complete
+   * is averaged out of it; the few rows of an unfinished block are carried over
+   * to the next band. A band spans enough chunk rows to keep every thread busy
+   * on narrow windows. */
+  const size_t ow = w / factor, oh = h / factor;
+  size_t band_cr = 1, band_cap = 0;
+  float *band = NULL;
+  size_t band_r0 = 0, next_oy = 0; /* window row held in band row 0; next output row */
+  if (factor > 1) {
+    size_t want = 2 * (size_t)omp_get_max_threads();
+    band_cr = (want + d->nselx - 1) / d->nselx;
+    if (band_cr > d->cy1 - d->cy0 + 1) band_cr = d->cy1 - d->cy0 + 1;
+    band_cap = band_cr * chy + factor;
+    band = (float *)malloc(band_cap * w * sizeof(float));
+    if (!band) return DECODE_BAD_CHUNK;
+  }
+  const size_t lookahead = (size_t)omp_get_max_threads();
+
+#pragma omp parallel reduction(min : cmin) reduction(max : cmax)
+  {
+    DecodeScratch t = {libdeflate_alloc_decompressor(),
+                       (uint8_t *)malloc(chunk_bytes),
+                       (uint8_t *)malloc(chunk_bytes), NULL, 0};
+    if (!t.dec || !t.shuf || !t.elems) {
+#pragma omp atomic write
+      failed = DECODE_BAD_CHUNK;
+    }
+
+    if (factor == 1) {
+#pragma omp for schedule(dynamic, 1)
+      for (size_t j = 0; j < d->nsel; j++) {
+        if (failed) continue;
+        int e = fetch_decode(d, j, lookahead, &t, (uint8_t *)d->out, 0, out_es,
+                             &cmin, &cmax);
+        if (e != DECODE_OK) {
+#pragma omp atomic write
+          failed = e;
+        }
+      }
+    } else {
+      for (size_t cr = d->cy0; cr <= d->cy1; cr += band_cr) {
+        size_t ce = cr + band_cr < d->cy1 + 1 ? cr + band_cr : d->cy1 + 1;
+        size_t j0 = (cr - d->cy0) * d->nselx, j1 = (ce - d->cy0) * d->nselx;
+#pragma omp for schedule(dynamic, 1)
+        for (size_t j = j0; j < j1; j++) {
+          if (failed) continue;
+          int e = fetch_decode(d, j, lookahead, &t, (uint8_t *)band, band_r0,
+                               sizeof(float), &cmin, &cmax);
+          if (e != DECODE_OK) {
+#pragma omp atomic write
+            failed = e;
+          }
+        }
+
+        /* Window rows [band_r0, r1) are in the band now. Same summation order
+         * and rounding as downsample_boxfilter(), so the result is identical. */
+        size_t r1 = (ce * chy < y0 + h ? ce * chy : y0 + h) - y0;
+        size_t oy_end = r1 / factor < oh ? r1 / factor : oh;
+#pragma omp for schedule(static)
+        for (size_t oy = next_oy; oy < oy_end; oy++) {
+          float *dst = (float *)d->out + oy * ow;
+          for (size_t i = 0; i < ow; i++) {
+            double f = 0;
+            for (size_t l = 0; l < factor; l++) {
+              const float *row =
+                  band + (oy * factor + l - band_r0) * w + i * factor;
+              for (size_t k = 0; k < factor; k++) f += row[k];
+            }
+            dst[i] = (float)(f / (double)(factor * factor));
+          }
+        }
+
+#pragma omp single
+        {
+          /* Keep the rows of the next, unfinished block. Past the last output
+           * row nothing is kept: the remaining rows are only decoded for the
+           * value range, as they would be without the factor. */
+          size_t keep_r0 = oy_end < oh ? oy_end * factor : r1;
+          memmove(band, band + (keep_r0 - band_r0) * w,
+                  (r1 - keep_r0) * w * sizeof(float));
+          band_r0 = keep_r0;
+          next_oy = oy_end;
+        }
+      }
+    }
+
+    free(t.cbuf);
+    free(t.shuf);
+    free(t.elems);
+    if (t.dec) libdeflate_free_decompressor(t.dec);
+  }
+  free(band);
+
+  *vmin = cmin;
+  *vmax = cmax;
+  return failed;
+}
+
+/* Reads the window [x0, x0+w) x [y0, y0+h) of the nx*ny variable into out
+ * (w*h elements, row-major). The full grid is simply the window (0, 0, nx, ny).
+ * With conv, out holds converted elements and vmin/vmax their range. With
+ * factor > 1 (conv must produce floats) out holds the (w/factor)*(h/factor)
+ * block averages instead. */
+static int read_chunked(const char *filename, const char *varname, void *out,
+                        size_t nx, size_t ny, size_t elem_size, size_t x0,
+                        size_t y0, size_t w, size_t h, size_t factor,
+                        const ChunkConverter *conv, float *vmin, float *vmax,
+                        bool try_cache) {
+  int rc = READ_FALLBACK;
+  hid_t file = -1, dset = -1;
+  uint8_t **raw = NULL;
+  size_t *sel = NULL; /* chunks that intersect the window */
+  ChunkLayout lay;
+  memset(&lay, 0, sizeof(lay));
+  bool from_cache = false;
+  int fd = -1;
+  size_t nchunks = 0;               /* set once known; keeps cleanup safe */
+  size_t chy = 0, chx = 0, nchx = 0, nsel = 0;
+  double t_index = 0.0, t_fetch = 0.0;
+  size_t n_alloc = 0;
+  bool read_ok = true;
+  double t_serial0 = omp_get_wtime();
+
+  /* A cached index (HPSV_CHUNK_CACHE_DIR) replaces the whole HDF5 side: the
+   * entry was stored only after a successful read of this same file, so the
+   * layout checks below already passed for it. */
+  if (try_cache && chunk_cache_load(filename, varname, &lay) == 0) {
+    if (lay.nx == nx && lay.ny == ny && lay.elem_size == elem_size)
+      from_cache = true;
+    else
+      chunk_layout_free(&lay);
+  }
+
+  if (!from_cache) {
+    bool opened;
+#pragma omp critical(hpsv_hdf5)
+    opened = h5_open_layout(filename, varname, nx, ny, elem_size, &lay, &file,
+                            &dset);
+    if (!opened) goto done;
+
+    lay.nx = nx;
+    lay.ny = ny;
+    lay.elem_size = elem_size;
+    lay.nchunks = ((nx + lay.chx - 1) / lay.chx) * ((ny + lay.chy - 1) / lay.chy);
+    lay.rawsize = (uint64_t *)calloc(lay.nchunks, sizeof(uint64_t));
+    lay.fmask = (uint32_t *)calloc(lay.nchunks, sizeof(uint32_t));
+    lay.rawaddr = (uint64_t *)calloc(lay.nchunks, sizeof(uint64_t));
+    if (!lay.rawsize || !lay.fmask || !lay.rawaddr) goto done;
+  }
+  chy = lay.chy;
+  chx = lay.chx;
+  if (from_cache) t_index = omp_get_wtime() - t_serial0;
 
   nchx = (nx + chx - 1) / chx;
-  nchy = (ny + chy - 1) / chy;
-  nchunks = nchx * nchy;
-  chunk_bytes = chy * chx * elem_size;
+  nchunks = lay.nchunks;
+  const uint64_t *rawsize = lay.rawsize;
 
-  raw = (uint8_t **)calloc(nchunks, sizeof(uint8_t *));
-  rawsize = (hsize_t *)calloc(nchunks, sizeof(hsize_t));
-  fmask = (unsigned *)calloc(nchunks, sizeof(unsigned));
-  rawaddr = (haddr_t *)calloc(nchunks, sizeof(haddr_t));
-  if (!raw || !rawsize || !fmask || !rawaddr) goto done;
+  /* Chunk rows cy0..cy1 and columns cx0..cx1 cover the window. */
+  const size_t cy0 = y0 / chy, cy1 = (y0 + h - 1) / chy;
+  const size_t cx0 = x0 / chx, cx1 = (x0 + w - 1) / chx;
+  const size_t nselx = cx1 - cx0 + 1;
+  nsel = (cy1 - cy0 + 1) * nselx;
+  sel = (size_t *)malloc(nsel * sizeof(size_t));
+  if (!sel) goto done;
+  for (size_t j = 0; j < nsel; j++)
+    sel[j] = (cy0 + j / nselx) * nchx + cx0 + j % nselx;
 
   /* --- Serial phase: locate every chunk, then pull its raw bytes. HDF5 is
    * single-locked, so neither half can be parallelized, and this phase — not the
@@ -156,203 +563,91 @@ int read_var_chunked_deflate(const char *filename, const char *varname,
    *
    * So: get the whole index in one pass with H5Dchunk_iter (HDF5 >= 1.14), then
    * fetch. Older HDF5 (Rocky 8 ships 1.10.x) keeps the per-chunk lookup, which
-   * is slow but correct. Both fill rawsize[]/fmask[]; rawsize[k] > 0 marks an
-   * allocated chunk, 0 means an all-fill region to be filled in below. --- */
-  double t_index = 0.0, t_fetch = 0.0;
-  size_t n_alloc = 0;
-  bool read_ok = true;
-  double t_serial0 = omp_get_wtime();
-
-#if H5_VERSION_GE(1, 14, 0)
-  {
-    ChunkIndex idx = {rawsize, fmask, rawaddr, nchx, nchy, chy, chx, true};
-    double t0i = omp_get_wtime();
-    if (H5Dchunk_iter(dset, H5P_DEFAULT, chunk_index_cb, &idx) < 0 || !idx.ok)
-      read_ok = false;
-    t_index = omp_get_wtime() - t0i;
-  }
-#else
-  for (size_t cy = 0; cy < nchy && read_ok; cy++) {
-    for (size_t cx = 0; cx < nchx; cx++) {
-      size_t k = cy * nchx + cx;
-      hsize_t offset[2] = {(hsize_t)(cy * chy), (hsize_t)(cx * chx)};
-      haddr_t addr = HADDR_UNDEF;
-      hsize_t csize = 0;
-      unsigned mask = 0;
-      double t0i = omp_get_wtime();
-      herr_t info_err = H5Dget_chunk_info_by_coord(dset, offset, &mask, &addr, &csize);
-      t_index += omp_get_wtime() - t0i;
-      if (info_err < 0) { read_ok = false; break; }
-      if (addr == HADDR_UNDEF || csize == 0) continue; /* unallocated -> fill */
-      rawsize[k] = csize;
-      fmask[k] = mask;
-    }
+   * is slow but correct — and is exactly what the chunk index cache saves on
+   * repeat reads. For a window it only looks up the selected chunks, so such a
+   * partial index is not stored. Both fill rawsize[]/fmask[]/rawaddr[];
+   * rawsize[k] > 0 marks an allocated chunk, 0 means an all-fill region to be
+   * filled in below. --- */
+  bool index_complete = true;
+  if (!from_cache) {
+#pragma omp critical(hpsv_hdf5)
+    read_ok = h5_walk_index(dset, &lay, nchx, sel, nsel, &t_index,
+                            &index_complete);
+    if (!read_ok) goto done;
   }
-#endif
-  if (!read_ok) goto done;
 
-  /* --- Fetch: leer los bytes crudos de cada chunk. ---
+  /* --- Fetch + inflate: leer los bytes crudos de cada chunk y descomprimirlos.
    *
    * H5Dread_chunk obliga a ir en serie (HDF5 tiene un lock global), pero el
    * índice ya nos dio el offset de cada chunk DENTRO DEL ARCHIVO, así que se
    * pueden leer con pread() en paralelo y saltarse HDF5 por completo. pread es
-   * seguro entre hilos: no comparte el offset del descriptor.
-   *
-   * addr es relativo a la dirección base del archivo, que NO es 0 si el archivo
-   * tiene user block. Se consulta y se suma; con user block 0 (el caso de
-   * netCDF-4) la suma es inocua.
+   * seguro entre hilos: no comparte el offset del descriptor. Cada hilo lee su
+   * chunk justo antes de descomprimirlo (decode_window), así que la latencia de
+   * unos se traslapa con el inflate de otros y en memoria solo hay un chunk
+   * comprimido por hilo, no la variable entera.
    *
-   * Si algo impide el camino directo (no se pudo abrir, no hay addr, HDF5 < 1.14
-   * que no llena rawaddr) se cae a H5Dread_chunk, que sigue siendo correcto. */
+   * Si algo impide el camino directo (no se pudo abrir, no hay addr, pread
+   * falla) se repite con H5Dread_chunk, que sigue siendo correcto. Con el índice
+   * tomado del caché no hay dataset HDF5 abierto: si pread falla, la entrada se
+   * da por obsoleta y se repite la lectura completa por HDF5. */
   bool use_pread = false;
-  hsize_t base_addr = 0;
-#if H5_VERSION_GE(1, 14, 0)
-  {
-    hid_t fcpl = H5Fget_create_plist(file);
-    if (fcpl >= 0) {
-      hsize_t ub = 0;
-      if (H5Pget_userblock(fcpl, &ub) >= 0) base_addr = ub;
-      H5Pclose(fcpl);
-      /* HPSV_NO_PREAD=1 fuerza H5Dread_chunk, para A/B de rendimiento. */
-      if (!getenv("HPSV_NO_PREAD")) {
-        fd = open(filename, O_RDONLY);
-        use_pread = (fd >= 0);
-      }
-    }
+  /* HPSV_NO_PREAD=1 fuerza H5Dread_chunk, para A/B de rendimiento. */
+  if (from_cache || !getenv("HPSV_NO_PREAD")) {
+    fd = open(filename, O_RDONLY);
+    use_pread = (fd >= 0);
   }
-#endif
+  if (from_cache && !use_pread) { rc = READ_STALE_CACHE; goto done; }
+
+  for (size_t j = 0; j < nsel; j++)
+    if (rawsize[sel[j]] > 0) n_alloc++;
+  LOG_TIMING(omp_get_wtime() - t_serial0, "NetCDF chunk index");
 
-  double t0f = omp_get_wtime();
+  WindowDecode d = {&lay, sel, nsel, nselx, nchx, cy0, cy1, x0, y0, w, h,
+                    factor, conv, out, NULL, fd};
+  float cmin = 1e30f, cmax = -1e30f;
+  int drc = DECODE_BAD_FETCH;
+  double t0 = omp_get_wtime();
   if (use_pread) {
-    int failed_read = 0;
-#pragma omp parallel for schedule(static) reduction(+ : n_alloc)
-    for (size_t k = 0; k < nchunks; k++) {
-      if (rawsize[k] == 0 || failed_read) continue; /* all-fill region */
-      if (rawaddr[k] == HADDR_UNDEF) {
-#pragma omp atomic write
-        failed_read = 1;
-        continue;
-      }
-      uint8_t *buf = (uint8_t *)malloc(rawsize[k]);
-      if (!buf) {
-#pragma omp atomic write
-        failed_read = 1;
-        continue;
-      }
-      /* pread puede devolver menos de lo pedido; hay que insistir. */
-      size_t got = 0;
-      bool bad = false;
-      while (got < rawsize[k]) {
-        ssize_t n = pread(fd, buf + got, rawsize[k] - got,
-                          (off_t)(rawaddr[k] + base_addr + got));
-        if (n <= 0) { bad = true; break; }
-        got += (size_t)n;
-      }
-      if (bad) {
-        free(buf);
-#pragma omp atomic write
-        failed_read = 1;
-        continue;
-      }
-      raw[k] = buf;
-      n_alloc++;
-    }
-    if (failed_read) {
-      /* Deshacer lo leído y reintentar por el camino de HDF5. */
-      for (size_t k = 0; k < nchunks; k++) { free(raw[k]); raw[k] = NULL; }
-      n_alloc = 0;
-      use_pread = false;
+    drc = decode_window(&d, &cmin, &cmax);
+    if (drc == DECODE_BAD_FETCH) {
+      if (from_cache) { rc = READ_STALE_CACHE; goto done; }
       LOG_WARN("Lectura directa de chunks falló; se usa H5Dread_chunk.");
+      use_pread = false;
     }
   }
   if (!use_pread) {
-    for (size_t k = 0; k < nchunks; k++) {
-      if (rawsize[k] == 0) { raw[k] = NULL; continue; } /* all-fill region */
-      hsize_t offset[2] = {(hsize_t)((k / nchx) * chy), (hsize_t)((k % nchx) * chx)};
-      raw[k] = (uint8_t *)malloc(rawsize[k]);
-      if (!raw[k]) { read_ok = false; break; }
-      unsigned mask = fmask[k];
-      herr_t read_err = H5Dread_chunk(dset, H5P_DEFAULT, offset, &mask, raw[k]);
-      if (read_err < 0) { read_ok = false; break; }
-      n_alloc++;
-    }
+    /* Todo el fetch por HDF5 primero (serial, bajo el lock), luego el inflate. */
+    raw = (uint8_t **)calloc(nchunks, sizeof(uint8_t *));
+    if (!raw) goto done;
+    double t0f = omp_get_wtime();
+#pragma omp critical(hpsv_hdf5)
+    read_ok = h5_fetch_chunks(dset, &lay, nchx, sel, nsel, raw);
+    t_fetch = omp_get_wtime() - t0f;
+    if (!read_ok) goto done;
+    d.raw = raw;
+    cmin = 1e30f;
+    cmax = -1e30f;
+    drc = decode_window(&d, &cmin, &cmax);
   }
-  t_fetch = omp_get_wtime() - t0f;
-  if (!read_ok) goto done;
-  LOG_TIMING(omp_get_wtime() - t_serial0, "NetCDF chunk index+fetch");
-  LOG_DEBUG("  %zu chunks (%zu allocated): index %.3f s, fetch %.3f s (%s)",
-            nchunks, n_alloc, t_index, t_fetch,
-            use_pread ? "pread paralelo" : "H5Dread_chunk serial");
-
-  /* --- Parallel phase: inflate + unshuffle + scatter. --- */
-  const unsigned SHUF_BIT = 0x1u; /* pipeline index 0 skipped */
-  const unsigned DEFL_BIT = 0x2u; /* pipeline index 1 skipped */
-  int failed = 0;
-  double t0 = omp_get_wtime();
-
-#pragma omp parallel
-  {
-    struct libdeflate_decompressor *dec = libdeflate_alloc_decompressor();
-    uint8_t *shuf = (uint8_t *)malloc(chunk_bytes);
-    uint8_t *elems = (uint8_t *)malloc(chunk_bytes);
-    if (!dec || !shuf || !elems) {
-#pragma omp atomic write
-      failed = 1;
-    }
-
-#pragma omp for schedule(static)
-    for (size_t k = 0; k < nchunks; k++) {
-      if (failed) continue;
-      size_t cy = k / nchx, cx = k % nchx;
-      size_t r0 = cy * chy, c0 = cx * chx;
-
-      const uint8_t *elem_bytes;
-      if (raw[k] == NULL) {
-        int16_t *e16 = (int16_t *)elems; /* unallocated chunk -> fill */
-        for (size_t i = 0; i < chy * chx; i++) e16[i] = fillval;
-        elem_bytes = elems;
-      } else {
-        const uint8_t *inflated;
-        if (fmask[k] & DEFL_BIT) {
-          inflated = raw[k]; /* deflate skipped for this chunk */
-        } else {
-          size_t got = 0;
-          if (libdeflate_zlib_decompress(dec, raw[k], rawsize[k], shuf,
-                                         chunk_bytes,
-                                         &got) != LIBDEFLATE_SUCCESS ||
-              got != chunk_bytes) {
-#pragma omp atomic write
-            failed = 1;
-            continue;
-          }
-          inflated = shuf;
-        }
-        if (fmask[k] & SHUF_BIT) {
-          elem_bytes = inflated; /* shuffle skipped -> already interleaved */
-        } else {
-          unshuffle(inflated, elems, chy * chx, elem_size);
-          elem_bytes = elems;
-        }
-      }
-
-      /* Scatter the chunk tile into out, clipping partial edge chunks. */
-      size_t rmax = (r0 + chy <= ny) ? chy : (ny - r0);
-      size_t cmax = (c0 + chx <= nx) ? chx : (nx - c0);
-      for (size_t lr = 0; lr < rmax; lr++) {
-        uint8_t *dst = (uint8_t *)out + ((r0 + lr) * nx + c0) * elem_size;
-        const uint8_t *src = elem_bytes + (lr * chx) * elem_size;
-        memcpy(dst, src, cmax * elem_size);
-      }
-    }
+  LOG_DEBUG("  %zu/%zu chunks (%zu allocated): index %.3f s%s, fetch %s", nsel,
+            nchunks, n_alloc, t_index, from_cache ? " (cache)" : "",
+            use_pread ? "pread paralelo junto con el inflate" : "H5Dread_chunk serial");
 
-    free(shuf);
-    free(elems);
-    if (dec) libdeflate_free_decompressor(dec);
-  }
-
-  if (!failed) {
-    LOG_TIMING(omp_get_wtime() - t0, "NetCDF chunked decompress (libdeflate)");
-    rc = 0;
+  if (drc == DECODE_OK) {
+    if (use_pread)
+      LOG_TIMING(omp_get_wtime() - t0, "NetCDF chunked fetch + decompress (pread + libdeflate%s)",
+                 conv ? " + convert" : "");
+    else
+      LOG_TIMING(omp_get_wtime() - t0, "NetCDF chunked fetch %.3f s + decompress (libdeflate%s)",
+                 t_fetch, conv ? " + convert" : "");
+    if (vmin) *vmin = cmin;
+    if (vmax) *vmax = cmax;
+    rc = READ_OK;
+    /* Only a complete index that just decoded cleanly is worth keeping. */
+    if (!from_cache && index_complete && chunk_cache_enabled())
+      chunk_cache_store(filename, varname, &lay);
+  } else if (from_cache) {
+    rc = READ_STALE_CACHE; /* bytes at the cached offsets are not our chunks */
   }
 
 done:
@@ -360,14 +655,77 @@ done:
     for (size_t k = 0; k < nchunks; k++) free(raw[k]);
     free(raw);
   }
-  free(rawsize);
-  free(fmask);
-  if (dtype >= 0) H5Tclose(dtype);
-  if (dcpl >= 0) H5Pclose(dcpl);
-  if (space >= 0) H5Sclose(space);
-  free(rawaddr);
+  free(sel);
+  chunk_layout_free(&lay);
   if (fd >= 0) close(fd);
-  if (dset >= 0) H5Dclose(dset);
-  if (file >= 0) H5Fclose(file);
+  if (dset >= 0 || file >= 0) {
+#pragma omp critical(hpsv_hdf5)
+    {
+      if (dset >= 0) H5Dclose(dset);
+      if (file >= 0) H5Fclose(file);
+    }
+  }
   return rc;
 }
+
+int read_var_chunked_deflate_boxfilter(const char *filename,
+                                       const char *varname, float *out,
+                                       size_t nx, size_t ny, size_t elem_size,
+                                       size_t x0, size_t y0, size_t w, size_t h,
+                                       size_t factor,
+                                       const ChunkConverter *conv, float *vmin,
+                                       float *vmax) {
+  /* int8/uint8 masks, int16/uint16 counts, float32/float64 L2 fields; the fill
+   * value of a cached entry holds at most 8 bytes. */
+  if (elem_size != 1 && elem_size != 2 && elem_size != 4 && elem_size != 8)
+    return 1;
+  if (w == 0 || h == 0 || x0 + w > nx || y0 + h > ny) return 1;
+  if (factor == 0 || w < factor || h < factor) return 1;
+  if (factor > 1 && (!conv || conv->out_elem_size != sizeof(float))) return 1;
+
+  /* Escape hatch: HPSV_DISABLE_FAST_READ=1 forces the nc_get_var fallback (for
+   * A/B validation or if a future file layout ever misbehaves in production). */
+  if (getenv("HPSV_DISABLE_FAST_READ")) return 1;
+
+  /* Silence HDF5's automatic error stack printing; we handle failures. */
+#pragma omp critical(hpsv_hdf5)
+  H5Eset_auto2(H5E_DEFAULT, NULL, NULL);
+
+  int rc = read_chunked(filename, varname, out, nx, ny, elem_size, x0, y0, w,
+                        h, factor, conv, vmin, vmax, chunk_cache_enabled());
+  if (rc == READ_STALE_CACHE) {
+    LOG_WARN("Chunk index cache entry for %s:%s is stale; re-reading via HDF5.",
+             filename, varname);
+    chunk_cache_invalidate(filename, varname);
+    rc = read_chunked(filename, varname, out, nx, ny, elem_size, x0, y0, w, h,
+                      factor, conv, vmin, vmax, false);
+  }
+  return rc == READ_OK ? 0 : 1;
+}
+
+int read_var_chunked_deflate_convert(const char *filename, const char *varname,
+                                     void *out, size_t nx, size_t ny,
+                                     size_t elem_size, size_t x0, size_t y0,
+                                     size_t w, size_t h,
+                                     const ChunkConverter *conv, float *vmin,
+                                     float *vmax) {
+  return read_var_chunked_deflate_boxfilter(filename, varname, (float *)out, nx,
+                                            ny, elem_size, x0, y0, w, h, 1,
+                                            conv, vmin, vmax);
+}
+
+int read_var_chunked_deflate_window(const char *filename, const char *varname,
+                                    void *out, size_t nx, size_t ny,
+                                    size_t elem_size, size_t x0, size_t y0,
+                                    size_t w, size_t h) {
+  return read_var_chunked_deflate_convert(filename, varname, out, nx, ny,
+                                          elem_size, x0, y0, w, h, NULL, NULL,
+                                          NULL);
+}
+
+int read_var_chunked_deflate(const char *filename, const char *varname,
+                             void *out, size_t nx, size_t ny,
+                             size_t elem_size) {
+  return read_var_chunked_deflate_window(filename, varname, out, nx, ny,
+                                         elem_size, 0, 0, nx, ny);
+}
@@ -0,0 +1,292 @@
+/* Precomputed fixed-grid -> geographic reprojection maps, reusable on disk.
+ * Copyright (c) 2025-2026 Alejandro Aguilar Sierra (asierra@unam.mx)
+ * Laboratorio Nacional de Observación de la Tierra, UNAM
+ *
+ * This file is part of HPSATVIEWS.
+ * Licensed under the GNU General Public License v3.0 (see LICENSE file).
+ *
+ * reproject_image_analytical() solves the inverse scan-angle equations (atan,
+ * tan, sqrt, asin, atan2 in double) for every output pixel, yet they depend only
+ * on the ReprojPlan: the sector geometry and the output grid. The dozen products
+ * rendered from one scene, and every later scene of the same sector, solve the
+ * very same transform. With HPSV_REPROJ_MAP_DIR set the solution is saved here
+ * once and later renders map it and only gather.
+ *
+ * One file per (plan, interpolation), named by a hash of the key. The entry
+ * repeats the key, compared exactly on lookup, so a collision reads as a miss.
+ * The map follows at a page-aligned offset and is mapped read-only. The last
+ * map used also stays in this process for the next product. Native-endian, like
+ * the other caches: meant for the host that wrote it.
+ */
+
+#include "reproj_map.h"
+#include "logger.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <omp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#define RPM_MAGIC "HPSVRPM1"
+#define RPM_ALIGN 4096
+
+/* Everything the map depends on. Built with memset so padding hashes and
+ * compares as zero. */
+typedef struct {
+  uint32_t width, height, src_w, src_h;
+  uint32_t bilinear, reserved;
+  double target_lon_min, target_lat_max;
+  double deg_per_px_lon, deg_per_px_lat;
+  double b2_over_a2, e2, b, H, a2_over_b2, lambda0;
+  double safe_gt[6];
+} RpmKey;
+
+typedef struct {
+  char magic[8];
+  uint32_t header_size; /* sizeof(RpmHeader): guards against layout drift */
+  uint32_t reserved;
+  RpmKey key;
+  uint64_t map_offset;
+} RpmHeader;
+
+/* The map in use: malloc'ed when just computed, mapped when read back. */
+static struct {
+  RpmKey key;
+  ReprojMap map;
+  void *base;  /* mmap base, or NULL if `buf` holds the map */
+  size_t len;
+  void *buf;
+} current;
+static bool have_current;
+
+bool reproj_map_enabled(void) {
+  const char *dir = getenv("HPSV_REPROJ_MAP_DIR");
+  return dir && dir[0] != '\0';
+}
+
+static void make_key(const ReprojPlan *plan, bool bilinear, RpmKey *k) {
+  memset(k, 0, sizeof(*k));
+  k->width = plan->width;
+  k->height = plan->height;
+  k->src_w = plan->src_w;
+  k->src_h = plan->src_h;
+  k->bilinear = bilinear;
+  k->target_lon_min = plan->target_lon_min;
+  k->target_lat_max = plan->target_lat_max;
+  k->deg_per_px_lon = plan->deg_per_px_lon;
+  k->deg_per_px_lat = plan->deg_per_px_lat;
+  k->b2_over_a2 = plan->b2_over_a2;
+  k->e2 = plan->e2;
+  k->b = plan->b;
+  k->H = plan->H;
+  k->a2_over_b2 = plan->a2_over_b2;
+  k->lambda0 = plan->lambda0;
+  memcpy(k->safe_gt, plan->safe_gt, sizeof(k->safe_gt));
+}
+
+static size_t map_bytes(const RpmKey *k) {
+  size_t npix = (size_t)k->width * k->height;
+  return k->bilinear ? npix * 2 * sizeof(double) : npix * sizeof(uint32_t);
+}
+
+static uint64_t map_offset(void) {
+  return ((uint64_t)sizeof(RpmHeader) + RPM_ALIGN - 1) / RPM_ALIGN * RPM_ALIGN;
+}
+
+static int entry_path(const RpmKey *k, char *out, size_t out_len) {
+  uint64_t h = 1469598103934665603ULL;
+  const uint8_t *b = (const uint8_t *)k;
+  for (size_t i = 0; i < sizeof(*k); i++) {
+    h ^= b[i];
+    h *= 1099511628211ULL;
+  }
+  int n = snprintf(out, out_len, "%s/%016llx.rpm", getenv("HPSV_REPROJ_MAP_DIR"),
+                   (unsigned long long)h);
+  return (n < 0 || (size_t)n >= out_len) ? 1 : 0;
+}
+
+static void set_pointers(ReprojMap *map, const RpmKey *k, void *data) {
+  map->width = k->width;
+  map->height = k->height;
+  map->src_w = k->src_w;
+  map->src_h = k->src_h;
+  map->bilinear = k->bilinear != 0;
+  map->index = map->bilinear ? NULL : (uint32_t *)data;
+  map->coord = map->bilinear ? (double *)data : NULL;
+}
+
+static void drop_current(void) {
+  if (!have_current) return;
+  if (current.base) munmap(current.base, current.len);
+  free(current.buf);
+  memset(&current, 0, sizeof(current));
+  have_current = false;
+}
+
+static bool map_entry(const char *path, const RpmKey *k) {
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) return false; /* plain miss */
+  struct stat st;
+  const uint64_t expect = map_offset() + map_bytes(k);
+  if (fstat(fd, &st) != 0 || (uint64_t)st.st_size != expect) {
+    close(fd);
+    LOG_DEBUG("Reprojection map: ignoring unusable entry %s", path);
+    return false;
+  }
+  void *base = mmap(NULL, (size_t)expect, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED) return false;
+
+  const RpmHeader *h = (const RpmHeader *)base;
+  if (memcmp(h->magic, RPM_MAGIC, 8) != 0 || h->header_size != sizeof(*h) ||
+      memcmp(&h->key, k, sizeof(*k)) != 0 || h->map_offset != map_offset()) {
+    munmap(base, (size_t)expect);
+    LOG_DEBUG("Reprojection map: %s belongs to another plan", path);
+    return false;
+  }
+  current.key = *k;
+  current.base = base;
+  current.len = (size_t)expect;
+  set_pointers(&current.map, k, (uint8_t *)base + h->map_offset);
+  have_current = true;
+  return true;
+}
+
+static void store_entry(const char *path, const RpmKey *k, const void *data) {
+  const char *dir = getenv("HPSV_REPROJ_MAP_DIR");
+  if (mkdir(dir, 0775) != 0 && errno != EEXIST) {
+    LOG_DEBUG("Reprojection map: cannot create %s: %s", dir, strerror(errno));
+    return;
+  }
+  RpmHeader h;
+  memset(&h, 0, sizeof(h));
+  memcpy(h.magic, RPM_MAGIC, 8);
+  h.header_size = sizeof(h);
+  h.key = *k;
+  h.map_offset = map_offset();
+
+  /* Unique temporary name per process, then an atomic rename: the products of
+   * one scene are often rendered in parallel and race to store the same map. */
+  char tmp[PATH_MAX + 32];
+  snprintf(tmp, sizeof(tmp), "%s.%ld.tmp", path, (long)getpid());
+  FILE *fp = fopen(tmp, "wb");
+  if (!fp) {
+    LOG_DEBUG("Reprojection map: cannot write %s: %s", tmp, strerror(errno));
+    return;
+  }
+  size_t pad = (size_t)(h.map_offset - sizeof(h));
+  static const uint8_t zeros[RPM_ALIGN];
+  size_t n = map_bytes(k);
+  bool ok = fwrite(&h, sizeof(h), 1, fp) == 1 && fwrite(zeros, 1, pad, fp) == pad &&
+            fwrite(data, 1, n, fp) == n;
+  ok = (fclose(fp) == 0) && ok;
+  if (!ok || rename(tmp, path) != 0) {
+    LOG_DEBUG("Reprojection map: failed to store %s", path);
+    unlink(tmp);
+    return;
+  }
+  LOG_DEBUG("Reprojection map: stored %s (%ux%u)", path, k->width, k->height);
+}
+
+const ReprojMap *reproj_map_get(const ReprojPlan *plan, bool bilinear) {
+  if (!plan || plan->width == 0 || plan->height == 0) return NULL;
+  // Source indices are 32-bit; a 0.5 km full disk (471 Mpx) still fits.
+  if ((uint64_t)plan->src_w * plan->src_h >= REPROJ_MAP_NONE) return NULL;
+  RpmKey k;
+  make_key(plan, bilinear, &k);
+  if (have_current && memcmp(&current.key, &k, sizeof(k)) == 0) return &current.map;
+  drop_current();
+
+  double t0 = omp_get_wtime();
+  char path[PATH_MAX];
+  bool named = reproj_map_enabled() && entry_path(&k, path, sizeof(path)) == 0;
+  if (named && map_entry(path, &k)) {
+    LOG_TIMING(omp_get_wtime() - t0, "Reprojection map hit (%ux%u, %s)", k.width,
+               k.height, path);
+    return &current.map;
+  }
+
+  void *buf = malloc(map_bytes(&k));
+  if (!buf) {
+    LOG_ERROR("Memory error allocating the reprojection map");
+    return NULL;
+  }
+  ReprojMap map;
+  set_pointers(&map, &k, buf);
+  if (reproject_fill_map(plan, &map) != 0) {
+    free(buf);
+    return NULL;
+  }
+  LOG_TIMING(omp_get_wtime() - t0, "Reprojection map computed (%ux%u)", k.width, k.height);
+  if (named) store_entry(path, &k, buf);
+
+  current.key = k;
+  current.map = map;
+  current.buf = buf;
+  have_current = true;
+  return &current.map;
+}
+
+ImageData reproj_map_apply(const ReprojMap *map, const ImageData *src_image,
+                           const unsigned char *nodata_pixel) {
+  const unsigned int bpp = src_image->bpp;
+  ImageData geo_image = image_create(map->width, map->height, bpp);
+  if (!geo_image.data) {
+    LOG_FATAL("Memory allocation failed for destination geographic image.");
+    return geo_image;
+  }
+
+  double t_start = omp_get_wtime();
+  const unsigned int src_w = map->src_w;
+  const uint8_t *src = src_image->data;
+  static const unsigned char zero_pixel[4] = {0};
+  const unsigned char *fill = nodata_pixel ? nodata_pixel : zero_pixel;
+  long valid_pixels = 0;
+  ReprojTile *tiles;
+  const size_t ntiles = reproject_tiles(map->width, map->height, &tiles);
+  if (ntiles == 0) {
+    LOG_ERROR("Memory error allocating reprojection tiles");
+    image_destroy(&geo_image);
+    return geo_image;
+  }
+
+  /* Same Morton tile walk as the analytic loop, for the same reason. */
+  #pragma omp parallel for schedule(dynamic) reduction(+ : valid_pixels)
+  for (size_t t = 0; t < ntiles; t++) {
+    for (size_t y = tiles[t].y0; y <= tiles[t].y1; y++) {
+      for (size_t i = y * map->width + tiles[t].x0; i <= y * map->width + tiles[t].x1; i++) {
+        uint8_t *out = geo_image.data + i * bpp;
+        if (map->bilinear) {
+          double col = map->coord[2 * i], row = map->coord[2 * i + 1];
+          if (col < 0.0) {
+            memcpy(out, fill, bpp);
+            continue;
+          }
+          reproj_bilinear(src, src_w, bpp, col, row, out);
+        } else {
+          uint32_t s = map->index[i];
+          if (s == REPROJ_MAP_NONE) {
+            memcpy(out, fill, bpp);
+            continue;
+          }
+          memcpy(out, src + (size_t)s * bpp, bpp);
+        }
+        valid_pixels++;
+      }
+    }
+  }
+  free(tiles);
+
+  double elapsed = omp_get_wtime() - t_start;
+  LOG_INFO("Reprojection results: %ld valid (precomputed map)", valid_pixels);
+  LOG_TIMING(elapsed, "Reprojection map gather (%.0f MB/s gathered)",
+             reproj_gathered_mb(valid_pixels, bpp) / elapsed);
+  return geo_image;
+}
@@ -7,8 +7,10 @@
  */
 
 #include "reprojection.h"
+#include "reproj_map.h"
 #include "datanc.h"
 #include "reader_nc.h"
+#include "nav_plan.h"
 #include "logger.h"
 #include <float.h>
 #include <limits.h>
@@ -102,11 +104,15 @@ void reprojection_find_pixel_for_coord(const DataF* navla, const DataF* navlo,
     *out_iy = best_iy;
 }
 
-ReprojPlan reproject_build_plan(const ImageData* src_image, const DataNC* data_nc,
-                                float lat_min, float lat_max, float lon_min, float lon_max,
-                                float native_resolution_km, const float* clip_coords) {
+/* src_w0/src_h0: dims of the source raster, used when data_nc carries no grid.
+ * bpp: bytes per output pixel. */
+static ReprojPlan build_plan(unsigned int src_w0, unsigned int src_h0, unsigned int bpp,
+                             const DataNC* data_nc,
+                             float lat_min, float lat_max, float lon_min, float lon_max,
+                             float native_resolution_km, const float* clip_coords,
+                             size_t max_dim) {
     ReprojPlan plan = {0};
-    if (!src_image || !src_image->data || !data_nc || !data_nc->proj_info.valid) {
+    if (!data_nc || !data_nc->proj_info.valid) {
         LOG_ERROR("Invalid parameters for reprojection plan.");
         return plan;
     }
@@ -121,9 +127,9 @@ ReprojPlan reproject_build_plan(const ImageData* src_image, const DataNC* data_n
 
     const double *gt = data_nc->geotransform;
     unsigned int src_w = data_nc->fdata.width > 0 ? data_nc->fdata.width :
-                         (data_nc->bdata.width > 0 ? data_nc->bdata.width : src_image->width);
+                         (data_nc->bdata.width > 0 ? data_nc->bdata.width : src_w0);
     unsigned int src_h = data_nc->fdata.height > 0 ? data_nc->fdata.height :
-                         (data_nc->bdata.height > 0 ? data_nc->bdata.height : src_image->height);
+                         (data_nc->bdata.height > 0 ? data_nc->bdata.height : src_h0);
 
     float target_lon_min, target_lon_max, target_lat_min, target_lat_max;
     if (clip_coords) {
@@ -150,9 +156,14 @@ ReprojPlan reproject_build_plan(const ImageData* src_image, const DataNC* data_n
     size_t height = (size_t)(lat_range / target_res_deg + 0.5f);
     if (width  < 10) width  = 10;
     if (height < 10) height = 10;
-    const size_t MAX_DIM = 10000;
-    if (width  > MAX_DIM) width  = MAX_DIM;
-    if (height > MAX_DIM) height = MAX_DIM;
+    if (width > max_dim || height > max_dim) {
+        // Ya no en silencio: el producto sale a menor resolución que la nativa.
+        LOG_WARN("Geographic output %zux%zu exceeds %zu px per side; downscaled. "
+                 "GeoTIFF output without -s streams it at full resolution.",
+                 width, height, max_dim);
+        if (width  > max_dim) width  = max_dim;
+        if (height > max_dim) height = max_dim;
+    }
 
     double safe_gt[6];
     for (int i = 0; i < 6; i++) safe_gt[i] = gt[i];
@@ -172,7 +183,7 @@ ReprojPlan reproject_build_plan(const ImageData* src_image, const DataNC* data_n
 
     plan.width  = (unsigned int)width;
     plan.height = (unsigned int)height;
-    plan.bpp    = src_image->bpp;
+    plan.bpp    = bpp;
     plan.src_w  = src_w;
     plan.src_h  = src_h;
     plan.target_lon_min = target_lon_min;
@@ -189,6 +200,371 @@ ReprojPlan reproject_build_plan(const ImageData* src_image, const DataNC* data_n
     return plan;
 }
 
+ReprojPlan reproject_build_plan(const ImageData* src_image, const DataNC* data_nc,
+                                float lat_min, float lat_max, float lon_min, float lon_max,
+                                float native_resolution_km, const float* clip_coords) {
+    if (!src_image || !src_image->data) {
+        LOG_ERROR("Invalid parameters for reprojection plan.");
+        return (ReprojPlan){0};
+    }
+    return build_plan(src_image->width, src_image->height, src_image->bpp, data_nc,
+                      lat_min, lat_max, lon_min, lon_max,
+                      native_resolution_km, clip_coords, REPROJ_MAX_DIM);
+}
+
+ReprojPlan reproject_build_plan_full(const ImageData* src_image, const DataNC* data_nc,
+                                     float lat_min, float lat_max, float lon_min, float lon_max,
+                                     float native_resolution_km, const float* clip_coords) {
+    if (!src_image || !src_image->data) {
+        LOG_ERROR("Invalid parameters for reprojection plan.");
+        return (ReprojPlan){0};
+    }
+    return build_plan(src_image->width, src_image->height, src_image->bpp, data_nc,
+                      lat_min, lat_max, lon_min, lon_max,
+                      native_resolution_km, clip_coords, REPROJ_STREAM_MAX_DIM);
+}
+
+bool reproject_stream_wanted(const ReprojPlan* full) {
+    if (!full || full->width == 0) return false;
+    return full->width > REPROJ_MAX_DIM || full->height > REPROJ_MAX_DIM ||
+           getenv("HPSV_STREAM_REPROJ") != NULL;
+}
+
+size_t reproject_tiles(unsigned int width, unsigned int height, ReprojTile** tiles) {
+    *tiles = NULL;
+    if (width == 0 || height == 0) return 0;
+    if (getenv("HPSV_NO_TILED_REPROJ")) {
+        ReprojTile* t = malloc(height * sizeof(*t));
+        if (!t) return 0;
+        for (unsigned int y = 0; y < height; y++) t[y] = (ReprojTile){0, y, width - 1, y};
+        *tiles = t;
+        return height;
+    }
+
+    const unsigned int tx = (width + REPROJ_TILE - 1) / REPROJ_TILE;
+    const unsigned int ty = (height + REPROJ_TILE - 1) / REPROJ_TILE;
+    ReprojTile* t = malloc((size_t)tx * ty * sizeof(*t));
+    if (!t) return 0;
+    unsigned int side = 1;
+    while (side < tx || side < ty) side <<= 1;
+
+    // Walk the Z curve over the enclosing power-of-two square, keeping the
+    // tiles that exist: bit 2k of d goes to x, bit 2k+1 to y.
+    size_t n = 0;
+    for (size_t d = 0; d < (size_t)side * side; d++) {
+        unsigned int x = 0, y = 0;
+        for (unsigned int b = 0; (d >> (2 * b)) != 0; b++) {
+            x |= (unsigned int)((d >> (2 * b)) & 1) << b;
+            y |= (unsigned int)((d >> (2 * b + 1)) & 1) << b;
+        }
+        if (x >= tx || y >= ty) continue;
+        ReprojTile* c = &t[n++];
+        c->x0 = x * REPROJ_TILE;
+        c->y0 = y * REPROJ_TILE;
+        c->x1 = c->x0 + REPROJ_TILE - 1 < width ? c->x0 + REPROJ_TILE - 1 : width - 1;
+        c->y1 = c->y0 + REPROJ_TILE - 1 < height ? c->y0 + REPROJ_TILE - 1 : height - 1;
+    }
+    *tiles = t;
+    return n;
+}
+
+/* Source position of output pixel (ox, oy): the inverse scan-angle equations
+ * of GOES-R PUG Vol. 4, then the geotransform. Returns REPROJ_OFF_HORIZON or
+ * REPROJ_OFF_SOURCE when the pixel has no source, leaving col/row unset.
+ * `vis`, if not NULL, gets the visibility margin (>= 0 on the visible side of
+ * the horizon), which unlike the test itself varies smoothly. */
+enum { REPROJ_ON_SOURCE, REPROJ_OFF_HORIZON, REPROJ_OFF_SOURCE };
+
+static inline bool on_source(const ReprojPlan* p, double col, double row) {
+    return !(col < 0.0 || col >= (double)(p->src_w - 1) ||
+             row < 0.0 || row >= (double)(p->src_h - 1));
+}
+
+static inline int source_coord(const ReprojPlan* p, size_t ox, size_t oy,
+                               double* col, double* row, double* vis) {
+    double lon_deg = p->target_lon_min + ((double)ox + 0.5) * p->deg_per_px_lon;
+    double lat_deg = p->target_lat_max - ((double)oy + 0.5) * p->deg_per_px_lat;
+    double phi    = lat_deg * (M_PI / 180.0);
+    double lambda = lon_deg * (M_PI / 180.0);
+
+    double phi_c = atan(p->b2_over_a2 * tan(phi));
+    double cos_phi_c = cos(phi_c);
+    double sin_phi_c = sin(phi_c);
+
+    double r_c = p->b / sqrt(1.0 - p->e2 * cos_phi_c * cos_phi_c);
+
+    double d_lambda = lambda - p->lambda0;
+    double cos_dl   = cos(d_lambda);
+    double sin_dl   = sin(d_lambda);
+
+    double s_x = p->H - r_c * cos_phi_c * cos_dl;
+    double s_y = -r_c * cos_phi_c * sin_dl;
+    double s_z = r_c * sin_phi_c;
+
+    // Visibility check
+    double margin = p->H * (p->H - s_x) - (s_y * s_y + p->a2_over_b2 * s_z * s_z);
+    if (vis) *vis = margin;
+    if (margin < 0.0)
+        return REPROJ_OFF_HORIZON;
+
+    double s_n = sqrt(s_x * s_x + s_y * s_y + s_z * s_z);
+    double x_rad = asin(-s_y / s_n);
+    double y_rad = atan2(s_z, s_x);
+
+    // Convert scan angles to source pixel coordinates usando el GT protegido
+    *col = (x_rad - p->safe_gt[0]) / p->safe_gt[1];
+    *row = (y_rad - p->safe_gt[3]) / p->safe_gt[5];
+
+    // Boundary check
+    return on_source(p, *col, *row) ? REPROJ_ON_SOURCE : REPROJ_OFF_SOURCE;
+}
+
+int reproject_fill_map(const ReprojPlan* plan, ReprojMap* map) {
+    const size_t width = plan->width;
+    long valid_pixels = 0;
+
+    #pragma omp parallel for reduction(+:valid_pixels)
+    for (size_t oy = 0; oy < plan->height; oy++) {
+        for (size_t ox = 0; ox < width; ox++) {
+            size_t i = oy * width + ox;
+            double col, row;
+            bool on = source_coord(plan, ox, oy, &col, &row, NULL) == REPROJ_ON_SOURCE;
+            valid_pixels += on;
+            if (map->bilinear) {
+                map->coord[2 * i]     = on ? col : -1.0;
+                map->coord[2 * i + 1] = on ? row : -1.0;
+            } else {
+                // Vecino más cercano, redondeado igual que en el loop analítico.
+                map->index[i] = on ? (uint32_t)((size_t)(int)(row + 0.5) * plan->src_w +
+                                                (size_t)(int)(col + 0.5))
+                                   : REPROJ_MAP_NONE;
+            }
+        }
+    }
+    return valid_pixels > 0 ? 0 : 1;
+}
+
+/* Source bytes a gather of `valid` output pixels touches, in MB: one pixel
+ * for nearest neighbour, the 2x2 neighbourhood for bilinear. What the
+ * "MB/s gathered" timings divide by. */
+double reproj_gathered_mb(long valid, unsigned int bpp) {
+    return (double)valid * (bpp == 1 ? 1.0 : 4.0 * bpp) / 1e6;
+}
+
+/* Writes the output pixel at `dst` from source position (col, row): nearest
+ * neighbour for bpp 1, bilinear otherwise. */
+static inline void put_sample(const ImageData* src_image, unsigned int src_w,
+                              double col, double row, uint8_t* dst) {
+    unsigned int bpp = src_image->bpp;
+    if (bpp == 1) {
+        // Vecino Más Cercano
+        int c_nn = (int)(col + 0.5);
+        int r_nn = (int)(row + 0.5);
+        size_t src_idx = ((size_t)r_nn * src_w + (size_t)c_nn) * bpp;
+        *dst = src_image->data[src_idx];
+    } else {
+        // Bilineal
+        reproj_bilinear(src_image->data, src_w, bpp, col, row, dst);
+    }
+}
+
+/* ---- Approximate reprojection (HPSV_REPROJ_APPROX=<px>) ----
+ * The source column/row vary smoothly over the output grid, so the exact
+ * inverse projection is solved only at the corners of a block and bilinearly
+ * interpolated inside, as GDAL's approximate transformer does along rows. A
+ * block is accepted when the interpolation misses the exact position by at
+ * most `tol` source pixels at its centre and edge midpoints; otherwise it is
+ * split in four. The horizon is decided the same way on the visibility margin
+ * of source_coord(): a block is taken as all visible (or all beyond the limb)
+ * only if the margin keeps its sign with room to spare over its own
+ * interpolation error, so the limb is solved pixel by pixel. */
+typedef struct {
+    const ReprojPlan* plan;
+    const ImageData* src;
+    ImageData* dst;        // output rows y0 .. y0 + dst->height - 1
+    size_t y0;
+    const unsigned char* nodata_pixel;
+    double tol;
+    long exact, valid;   // per tile: exact solutions, output pixels on source
+} ApproxCtx;
+
+typedef struct { double col, row, vis; int where; } SrcPos;
+
+static SrcPos approx_exact(ApproxCtx* c, size_t ox, size_t oy) {
+    SrcPos s = {0.0, 0.0, 0.0, 0};
+    s.where = source_coord(c->plan, ox, oy, &s.col, &s.row, &s.vis);
+    c->exact++;
+    return s;
+}
+
+static void approx_put(ApproxCtx* c, size_t ox, size_t oy, double col, double row, bool on) {
+    unsigned int bpp = c->src->bpp;
+    uint8_t* dst = c->dst->data + ((oy - c->y0) * c->plan->width + ox) * bpp;
+    if (!on) {
+        if (c->nodata_pixel) memcpy(dst, c->nodata_pixel, bpp);
+        return;
+    }
+    c->valid++;
+    put_sample(c->src, c->plan->src_w, col, row, dst);
+}
+
+// Bilinear interpolation between corner values f00, f10 (top) and f01, f11.
+static inline double lerp2(double f00, double f10, double f01, double f11, double u, double v) {
+    return (1.0 - v) * ((1.0 - u) * f00 + u * f10) + v * ((1.0 - u) * f01 + u * f11);
+}
+
+// Pixels [x0..x1] x [y0..y1], inclusive.
+static void approx_block(ApproxCtx* c, size_t x0, size_t y0, size_t x1, size_t y1) {
+    size_t nx = x1 - x0 + 1, ny = y1 - y0 + 1;
+    if (nx <= 2 && ny <= 2) {
+        for (size_t oy = y0; oy <= y1; oy++)
+            for (size_t ox = x0; ox <= x1; ox++) {
+                SrcPos s = approx_exact(c, ox, oy);
+                approx_put(c, ox, oy, s.col, s.row, s.where == REPROJ_ON_SOURCE);
+            }
+        return;
+    }
+
+    SrcPos k[4] = {approx_exact(c, x0, y0), approx_exact(c, x1, y0),
+                   approx_exact(c, x0, y1), approx_exact(c, x1, y1)};
+    const double sx = nx > 1 ? 1.0 / (double)(nx - 1) : 0.0;
+    const double sy = ny > 1 ? 1.0 / (double)(ny - 1) : 0.0;
+    size_t xm = x0 + (nx - 1) / 2, ym = y0 + (ny - 1) / 2;
+
+    // Visible or not at all nine points, and how far from the limb.
+    bool visible = k[0].vis >= 0.0;
+    double vis_min = INFINITY, vis_err = 0.0, pos_err = 0.0;
+    for (int i = 0; i < 4; i++) {
+        if ((k[i].vis >= 0.0) != visible) goto split;
+        if (fabs(k[i].vis) < vis_min) vis_min = fabs(k[i].vis);
+    }
+    const size_t test[5][2] = {{xm, ym}, {xm, y0}, {xm, y1}, {x0, ym}, {x1, ym}};
+    for (int t = 0; t < 5; t++) {
+        SrcPos e = approx_exact(c, test[t][0], test[t][1]);
+        if ((e.vis >= 0.0) != visible) goto split;
+        double u = (double)(test[t][0] - x0) * sx, v = (double)(test[t][1] - y0) * sy;
+        if (fabs(e.vis) < vis_min) vis_min = fabs(e.vis);
+        vis_err = fmax(vis_err, fabs(lerp2(k[0].vis, k[1].vis, k[2].vis, k[3].vis, u, v) - e.vis));
+        if (visible) {
+            pos_err = fmax(pos_err, fabs(lerp2(k[0].col, k[1].col, k[2].col, k[3].col, u, v) - e.col));
+            pos_err = fmax(pos_err, fabs(lerp2(k[0].row, k[1].row, k[2].row, k[3].row, u, v) - e.row));
+        }
+    }
+    if (vis_min <= 2.0 * vis_err || pos_err > c->tol) goto split;
+
+    for (size_t oy = y0; oy <= y1; oy++) {
+        double v = (double)(oy - y0) * sy;
+        double cl = (1.0 - v) * k[0].col + v * k[2].col, cr = (1.0 - v) * k[1].col + v * k[3].col;
+        double rl = (1.0 - v) * k[0].row + v * k[2].row, rr = (1.0 - v) * k[1].row + v * k[3].row;
+        for (size_t ox = x0; ox <= x1; ox++) {
+            double u = (double)(ox - x0) * sx;
+            double col = cl + u * (cr - cl), row = rl + u * (rr - rl);
+            approx_put(c, ox, oy, col, row, visible && on_source(c->plan, col, row));
+        }
+    }
+    return;
+
+split:
+    // Four disjoint blocks (fewer on a one-pixel-wide side).
+    approx_block(c, x0, y0, xm, ym);
+    if (xm < x1) approx_block(c, xm + 1, y0, x1, ym);
+    if (ym < y1) approx_block(c, x0, ym + 1, xm, y1);
+    if (xm < x1 && ym < y1) approx_block(c, xm + 1, ym + 1, x1, y1);
+}
+
+/// Tolerance of the approximate mode in source pixels; 0 = exact (default).
+static double approx_tolerance(void) {
+    const char* env = getenv("HPSV_REPROJ_APPROX");
+    if (!env || !*env) return 0.0;
+    double tol = strtod(env, NULL);
+    return tol > 0.0 ? tol : 0.0;
+}
+
+/* Approximate reprojection of output rows y0 .. y0 + dst->height - 1 into dst.
+ * Adds to *exact and *valid; returns -1 if the tiles cannot be allocated. */
+static int approx_rows(const ReprojPlan* plan, const ImageData* src_image,
+                       const unsigned char* nodata_pixel, double tol,
+                       ImageData* dst, size_t y0, long* exact, long* valid) {
+    ReprojTile* tiles;
+    const size_t ntiles = reproject_tiles(plan->width, dst->height, &tiles);
+    if (ntiles == 0) return -1;
+    long n_exact = 0, n_valid = 0;
+
+    #pragma omp parallel for schedule(dynamic) reduction(+:n_exact, n_valid)
+    for (size_t t = 0; t < ntiles; t++) {
+        ApproxCtx c = {plan, src_image, dst, y0, nodata_pixel, tol, 0, 0};
+        approx_block(&c, tiles[t].x0, y0 + tiles[t].y0, tiles[t].x1, y0 + tiles[t].y1);
+        n_exact += c.exact;
+        n_valid += c.valid;
+    }
+    free(tiles);
+    *exact += n_exact;
+    *valid += n_valid;
+    return 0;
+}
+
+static void reproject_approx(const ReprojPlan* plan, const ImageData* src_image,
+                             const unsigned char* nodata_pixel, double tol,
+                             ImageData* geo_image) {
+    double t_start = omp_get_wtime();
+    long exact = 0, valid_pixels = 0;
+    if (approx_rows(plan, src_image, nodata_pixel, tol, geo_image, 0, &exact, &valid_pixels) != 0) {
+        LOG_ERROR("Memory error allocating reprojection tiles");
+        return;
+    }
+
+    LOG_INFO("Reprojection results: %ld valid, approximate within %.3g px "
+             "(%ld exact solutions for %zu pixels)", valid_pixels, tol, exact,
+             (size_t)plan->width * plan->height);
+    LOG_TIMING(omp_get_wtime() - t_start, "Approximate reprojection finished");
+}
+
+/* Exact reprojection of output rows y0 .. y0 + dst->height - 1 into dst, tile
+ * by tile in Morton order: near the limb consecutive output pixels of a row
+ * land on source rows far apart, and a row-major walk thrashes the cache and
+ * the TLB on the gathers. Adds to the counters; returns -1 if the tiles cannot
+ * be allocated. */
+static int analytic_rows(const ReprojPlan* plan, const ImageData* src_image,
+                         const unsigned char* nodata_pixel, ImageData* dst, size_t y0,
+                         long* horizon, long* bounds, long* valid) {
+    const size_t width = plan->width;
+    const unsigned int bpp = plan->bpp, src_w = plan->src_w;
+    ReprojTile* tiles;
+    const size_t ntiles = reproject_tiles(plan->width, dst->height, &tiles);
+    if (ntiles == 0) return -1;
+
+    // Contadores thread-safe para diagnosticar el rechazo
+    long err_horizon = 0;
+    long err_bounds = 0;
+    long valid_pixels = 0;
+
+    #pragma omp parallel for schedule(dynamic) reduction(+:err_horizon, err_bounds, valid_pixels)
+    for (size_t t = 0; t < ntiles; t++) {
+        for (size_t ty = tiles[t].y0; ty <= tiles[t].y1; ty++) {
+            const size_t oy = y0 + ty;
+            for (size_t ox = tiles[t].x0; ox <= tiles[t].x1; ox++) {
+                size_t dst_idx = (ty * width + ox) * bpp;
+                double col, row;
+                int where = source_coord(plan, ox, oy, &col, &row, NULL);
+                if (where != REPROJ_ON_SOURCE) {
+                    if (where == REPROJ_OFF_HORIZON) err_horizon++;
+                    else err_bounds++;
+                    if (nodata_pixel) memcpy(dst->data + dst_idx, nodata_pixel, bpp);
+                    continue;
+                }
+
+                valid_pixels++;
+                put_sample(src_image, src_w, col, row, dst->data + dst_idx);
+            }
+        }
+    }
+    free(tiles);
+    *horizon += err_horizon;
+    *bounds += err_bounds;
+    *valid += valid_pixels;
+    return 0;
+}
+
 ImageData reproject_image_analytical(const ImageData* src_image, const DataNC* data_nc,
                                      float lat_min, float lat_max,
                                      float lon_min, float lon_max,
@@ -200,57 +576,23 @@ ImageData reproject_image_analytical(const ImageData* src_image, const DataNC* d
         return image_create(0, 0, 0);
     }
 
-    // Projection parameters.
-    double a   = data_nc->proj_info.semi_major;
-    double b   = data_nc->proj_info.semi_minor;
-    double H   = a + data_nc->proj_info.sat_height;
-    double e2  = (a * a - b * b) / (a * a);
-    double a2  = a * a;
-    double b2  = b * b;
-    double a2_over_b2 = a2 / b2;
-    double lambda0 = data_nc->proj_info.lon_origin * (M_PI / 180.0);
-
-    const double *gt = data_nc->geotransform;
-    unsigned int src_w = data_nc->fdata.width > 0 ? data_nc->fdata.width :
-                         (data_nc->bdata.width > 0 ? data_nc->bdata.width : src_image->width);
-    unsigned int src_h = data_nc->fdata.height > 0 ? data_nc->fdata.height :
-                         (data_nc->bdata.height > 0 ? data_nc->bdata.height : src_image->height);
-
-    // Target geographic extent.
-    float target_lon_min, target_lon_max, target_lat_min, target_lat_max;
-    if (clip_coords) {
-        target_lon_min = (clip_coords[0] > lon_min) ? clip_coords[0] : lon_min;
-        target_lon_max = (clip_coords[2] < lon_max) ? clip_coords[2] : lon_max;
-        target_lat_min = (clip_coords[3] > lat_min) ? clip_coords[3] : lat_min;
-        target_lat_max = (clip_coords[1] < lat_max) ? clip_coords[1] : lat_max;
-    } else {
-        target_lon_min = lon_min;
-        target_lon_max = lon_max;
-        target_lat_min = lat_min;
-        target_lat_max = lat_max;
-    }
-
-    float lon_range = target_lon_max - target_lon_min;
-    float lat_range = target_lat_max - target_lat_min;
-    float lat_center = (target_lat_min + target_lat_max) / 2.0f;
-    float lat_rad_c = lat_center * (float)(M_PI / 180.0);
-    float km_per_deg_lat = 111.132954f - 0.559822f * cosf(2.0f * lat_rad_c);
-    float target_res_km = (native_resolution_km > 0.0f) ? native_resolution_km : 1.0f;
-    float target_res_deg = target_res_km / km_per_deg_lat;
-
-    size_t width  = (size_t)(lon_range / target_res_deg + 0.5f);
-    size_t height = (size_t)(lat_range / target_res_deg + 0.5f);
-
-    if (width  < 10) width  = 10;
-    if (height < 10) height = 10;
-
-    const size_t MAX_DIM = 10000;
-    if (width  > MAX_DIM) width  = MAX_DIM;
-    if (height > MAX_DIM) height = MAX_DIM;
+    ReprojPlan plan = reproject_build_plan(src_image, data_nc, lat_min, lat_max,
+                                           lon_min, lon_max, native_resolution_km,
+                                           clip_coords);
+    if (plan.width == 0) return image_create(0, 0, 0);
+    const size_t width = plan.width, height = plan.height;
+    const unsigned int bpp = plan.bpp;
 
     LOG_INFO("Analytic reprojection: %ux%u (bpp:%u) -> %zux%zu",
              src_image->width, src_image->height, src_image->bpp, width, height);
 
+    // Same sector and output grid as an earlier product (HPSV_REPROJ_MAP_DIR):
+    // the transform is already solved, only the gather is left.
+    if (reproj_map_enabled()) {
+        const ReprojMap* map = reproj_map_get(&plan, bpp != 1);
+        if (map) return reproj_map_apply(map, src_image, nodata_pixel);
+    }
+
     ImageData geo_image = image_create(width, height, src_image->bpp);
     if (!geo_image.data) {
         LOG_FATAL("Memory allocation failed for destination geographic image.");
@@ -258,139 +600,374 @@ ImageData reproject_image_analytical(const ImageData* src_image, const DataNC* d
     }
     memset(geo_image.data, 0, width * height * src_image->bpp);
 
-	double t_start = omp_get_wtime();
-    unsigned int bpp = src_image->bpp;
-
-    // Output pixel resolution (degrees per pixel).
-    double deg_per_px_lon = (double)lon_range / (double)width;
-    double deg_per_px_lat = (double)lat_range / (double)height;
-
-    // 1. Diagnóstico Seguro: Imprimir variables espaciales fuera del ciclo
-    LOG_DEBUG("Reprojection params: a=%.1f, b=%.1f, H=%.1f", a, b, H);
-    LOG_DEBUG("Original reprojection GT: [%.6f, %.6f, %.6f, %.6f]", gt[0], gt[1], gt[3], gt[5]);
-
-    // 2. Fallback Analítico para variables físicas (LST) si el Geotransform L2 viene nulo
-    double safe_gt[6];
-    for (int i=0; i<6; i++) safe_gt[i] = gt[i];
-    
-    if (safe_gt[1] == 0.0 || safe_gt[5] == 0.0 || fabs(safe_gt[1]) > 1.0) {
-        LOG_WARN("Invalid geotransform. Generating analytic fallback for Full Disk.");
-        double fov = 0.303744; // FOV Radianes estándar de GOES-R FD
-        safe_gt[0] = -fov / 2.0;
-        safe_gt[1] = fov / (double)src_w;
-        safe_gt[2] = 0.0;
-        safe_gt[3] = fov / 2.0;
-        safe_gt[4] = 0.0;
-        safe_gt[5] = -fov / (double)src_h;
+    double tol = approx_tolerance();
+    if (tol > 0.0) {
+        reproject_approx(&plan, src_image, nodata_pixel, tol, &geo_image);
+        return geo_image;
     }
 
-    // 3. Contadores thread-safe para diagnosticar el rechazo
+	double t_start = omp_get_wtime();
+
     long err_horizon = 0;
     long err_bounds = 0;
     long valid_pixels = 0;
+    if (analytic_rows(&plan, src_image, nodata_pixel, &geo_image, 0,
+                      &err_horizon, &err_bounds, &valid_pixels) != 0) {
+        LOG_ERROR("Memory error allocating reprojection tiles");
+        image_destroy(&geo_image);
+        return geo_image;
+    }
 
-    #pragma omp parallel for collapse(2) reduction(+:err_horizon, err_bounds, valid_pixels)
-    for (size_t oy = 0; oy < height; oy++) {
-        for (size_t ox = 0; ox < width; ox++) {
-            size_t dst_idx = (oy * width + ox) * bpp;
-            double lon_deg = (double)target_lon_min + ((double)ox + 0.5) * deg_per_px_lon;
-            double lat_deg = (double)target_lat_max - ((double)oy + 0.5) * deg_per_px_lat;
-            double phi    = lat_deg * (M_PI / 180.0);
-            double lambda = lon_deg * (M_PI / 180.0);
-
-            double phi_c = atan((b2 / a2) * tan(phi));
-            double cos_phi_c = cos(phi_c);
-            double sin_phi_c = sin(phi_c);
-
-            double r_c = b / sqrt(1.0 - e2 * cos_phi_c * cos_phi_c);
-
-            double d_lambda = lambda - lambda0;
-            double cos_dl   = cos(d_lambda);
-            double sin_dl   = sin(d_lambda);
-
-            double s_x = H - r_c * cos_phi_c * cos_dl;
-            double s_y = -r_c * cos_phi_c * sin_dl;
-            double s_z = r_c * sin_phi_c;
-
-            // Visibility check
-            if (H * (H - s_x) < s_y * s_y + a2_over_b2 * s_z * s_z) {
-                err_horizon++;
-                if (nodata_pixel) memcpy(geo_image.data + dst_idx, nodata_pixel, bpp);
-                continue;
-            }
+    // Reporte final seguro (fuera del hilo de OpenMP)
+    LOG_INFO("Reprojection results: %ld valid, %ld horizon discards, %ld bounds discards", 
+             valid_pixels, err_horizon, err_bounds);
 
-            double s_n = sqrt(s_x * s_x + s_y * s_y + s_z * s_z);
-            double x_rad = asin(-s_y / s_n);
-            double y_rad = atan2(s_z, s_x);
+    double elapsed = omp_get_wtime() - t_start;
+    LOG_TIMING(elapsed, "Analytic reprojection finished (%.0f MB/s gathered)",
+               reproj_gathered_mb(valid_pixels, bpp) / elapsed);
 
-            // Convert scan angles to source pixel coordinates usando el GT protegido
-            double col = (x_rad - safe_gt[0]) / safe_gt[1];
-            double row = (y_rad - safe_gt[3]) / safe_gt[5];
+    return geo_image;
+}
 
-            // Boundary check
-            if (col < 0.0 || col >= (double)(src_w - 1) ||
-                row < 0.0 || row >= (double)(src_h - 1)) {
-                err_bounds++;
-                if (nodata_pixel) memcpy(geo_image.data + dst_idx, nodata_pixel, bpp);
-                continue;
-            }
+/* Physical value at source position (col, row): bilinear between the four
+ * neighbours, or the nearest one when any of them is NonData (the disk edge,
+ * masked pixels), so NonData never leaks into an interpolated value. */
+static inline float sample_dataf(const DataF* src, double col, double row) {
+    int c0 = (int)col;
+    int r0 = (int)row;
+    double dc = col - c0;
+    double dr = row - r0;
+    const float* p = src->data_in + (size_t)r0 * src->width + (size_t)c0;
+    float v00 = p[0], v10 = p[1], v01 = p[src->width], v11 = p[src->width + 1];
+    if (IS_NONDATA(v00) || IS_NONDATA(v10) || IS_NONDATA(v01) || IS_NONDATA(v11)) {
+        int c_nn = (int)(col + 0.5);
+        int r_nn = (int)(row + 0.5);
+        return src->data_in[(size_t)r_nn * src->width + (size_t)c_nn];
+    }
+    return (float)((1.0 - dc) * (1.0 - dr) * v00 + dc * (1.0 - dr) * v10 +
+                   (1.0 - dc) * dr * v01 + dc * dr * v11);
+}
 
-            valid_pixels++;
+DataF reproject_dataf(const DataF* src, const DataNC* data_nc,
+                      float lat_min, float lat_max, float lon_min, float lon_max,
+                      float native_resolution_km, const float* clip_coords) {
+    DataF geo = {0};
+    if (!src || !src->data_in || !data_nc || !data_nc->proj_info.valid) {
+        LOG_ERROR("Invalid parameters for reproject_dataf.");
+        return geo;
+    }
+    ReprojPlan plan = build_plan(src->width, src->height, sizeof(float), data_nc,
+                                 lat_min, lat_max, lon_min, lon_max,
+                                 native_resolution_km, clip_coords, REPROJ_MAX_DIM);
+    if (plan.width == 0) return geo;
+    if (plan.src_w != src->width || plan.src_h != src->height) {
+        LOG_ERROR("Float reprojection: grid %ux%u does not match the source %ux%u.",
+                  plan.src_w, plan.src_h, src->width, src->height);
+        return geo;
+    }
+    LOG_INFO("Float reprojection: %ux%u -> %ux%u", src->width, src->height,
+             plan.width, plan.height);
 
-            if (bpp == 1) {
-                // Vecino Más Cercano
-                int c_nn = (int)(col + 0.5);
-                int r_nn = (int)(row + 0.5);
-                size_t src_idx = ((size_t)r_nn * src_w + (size_t)c_nn) * bpp;
-                geo_image.data[dst_idx] = src_image->data[src_idx];
-            } else {
-                // Bilineal
-                int c0 = (int)col;
-                int r0 = (int)row;
-                double dc = col - c0;
-                double dr = row - r0;
-                int c1 = c0 + 1;
-                int r1 = r0 + 1;
-
-                double w00 = (1.0 - dc) * (1.0 - dr);
-                double w10 = dc * (1.0 - dr);
-                double w01 = (1.0 - dc) * dr;
-                double w11 = dc * dr;
-
-                size_t i00 = ((size_t)r0 * src_w + (size_t)c0) * bpp;
-                size_t i10 = ((size_t)r0 * src_w + (size_t)c1) * bpp;
-                size_t i01 = ((size_t)r1 * src_w + (size_t)c0) * bpp;
-                size_t i11 = ((size_t)r1 * src_w + (size_t)c1) * bpp;
-
-                for (unsigned int ch = 0; ch < bpp; ch++) {
-                    double val = w00 * src_image->data[i00 + ch]
-                               + w10 * src_image->data[i10 + ch]
-                               + w01 * src_image->data[i01 + ch]
-                               + w11 * src_image->data[i11 + ch];
-                    int ival = (int)(val + 0.5);
-                    geo_image.data[dst_idx + ch] = (uint8_t)(ival < 0 ? 0 : (ival > 255 ? 255 : ival));
+    geo = dataf_create(plan.width, plan.height);
+    ReprojTile* tiles;
+    const size_t ntiles = geo.data_in ? reproject_tiles(plan.width, plan.height, &tiles) : 0;
+    if (ntiles == 0) {
+        LOG_ERROR("Memory allocation failed for the float reprojection.");
+        dataf_destroy(&geo);
+        return geo;
+    }
+
+    double t_start = omp_get_wtime();
+    float fmin = INFINITY, fmax = -INFINITY;
+    long valid_pixels = 0;
+
+    // Same tile walk, same inverse projection as the byte loop; only the
+    // sample differs.
+    #pragma omp parallel for schedule(dynamic) reduction(min:fmin) reduction(max:fmax) \
+        reduction(+:valid_pixels)
+    for (size_t t = 0; t < ntiles; t++) {
+        for (size_t oy = tiles[t].y0; oy <= tiles[t].y1; oy++) {
+            for (size_t ox = tiles[t].x0; ox <= tiles[t].x1; ox++) {
+                float* dst = geo.data_in + oy * plan.width + ox;
+                double col, row;
+                if (source_coord(&plan, ox, oy, &col, &row, NULL) != REPROJ_ON_SOURCE) {
+                    *dst = NonData;
+                    continue;
                 }
+                float v = sample_dataf(src, col, row);
+                *dst = v;
+                if (IS_NONDATA(v)) continue;
+                valid_pixels++;
+                if (v < fmin) fmin = v;
+                if (v > fmax) fmax = v;
             }
         }
     }
+    free(tiles);
 
-    // Reporte final seguro (fuera del hilo de OpenMP)
-    LOG_INFO("Reprojection results: %ld valid, %ld horizon discards, %ld bounds discards", 
-             valid_pixels, err_horizon, err_bounds);
+    geo.fmin = valid_pixels ? fmin : NonData;
+    geo.fmax = valid_pixels ? fmax : NonData;
+    LOG_INFO("Reprojection results: %ld valid, range [%g, %g]", valid_pixels, geo.fmin, geo.fmax);
+    LOG_TIMING(omp_get_wtime() - t_start, "Float reprojection finished");
+    return geo;
+}
+
+int reproject_image_strips(const ImageData* src_image, const ReprojPlan* plan,
+                           const unsigned char* nodata_pixel,
+                           ReprojStripFn emit, void* ctx) {
+    if (!src_image || !src_image->data || !plan || plan->width == 0 || !emit) {
+        LOG_ERROR("Invalid parameters for reproject_image_strips.");
+        return -1;
+    }
+    const unsigned int bpp = plan->bpp;
+    const unsigned int rows = plan->height < REPROJ_STRIP_ROWS ? plan->height : REPROJ_STRIP_ROWS;
+    LOG_INFO("Streamed reprojection: %ux%u (bpp:%u) -> %ux%u in strips of %u rows",
+             src_image->width, src_image->height, bpp, plan->width, plan->height, rows);
+
+    // Un solo buffer de franja, reusado: la memoria queda acotada por
+    // width * REPROJ_STRIP_ROWS * bpp y no por el tamaño de la salida. Los mapas
+    // de HPSV_REPROJ_MAP_DIR no se usan aquí: ocupan la salida completa.
+    ImageData strip = image_create(plan->width, rows, bpp);
+    if (!strip.data) {
+        LOG_ERROR("Memory allocation failed for the reprojection strip.");
+        return -1;
+    }
+
+    double t_start = omp_get_wtime(), t_emit = 0.0;
+    const double tol = approx_tolerance();
+    long err_horizon = 0, err_bounds = 0, exact = 0, valid_pixels = 0;
+    int status = 0;
+    for (unsigned int y0 = 0; y0 < plan->height && status == 0; y0 += rows) {
+        strip.height = plan->height - y0 < rows ? plan->height - y0 : rows;
+        memset(strip.data, 0, (size_t)plan->width * strip.height * bpp);
+        status = tol > 0.0
+            ? approx_rows(plan, src_image, nodata_pixel, tol, &strip, y0, &exact, &valid_pixels)
+            : analytic_rows(plan, src_image, nodata_pixel, &strip, y0,
+                            &err_horizon, &err_bounds, &valid_pixels);
+        if (status != 0) {
+            LOG_ERROR("Memory error allocating reprojection tiles");
+            break;
+        }
+        double t0 = omp_get_wtime();
+        status = emit(ctx, &strip, y0);
+        t_emit += omp_get_wtime() - t0;
+    }
+    image_destroy(&strip);
 
+    if (tol > 0.0)
+        LOG_INFO("Reprojection results: %ld valid, approximate within %.3g px "
+                 "(%ld exact solutions for %zu pixels)", valid_pixels, tol, exact,
+                 (size_t)plan->width * plan->height);
+    else
+        LOG_INFO("Reprojection results: %ld valid, %ld horizon discards, %ld bounds discards",
+                 valid_pixels, err_horizon, err_bounds);
+    // El ancho de banda se mide sin el consumidor (compresión y escritura).
     double elapsed = omp_get_wtime() - t_start;
-    LOG_TIMING(elapsed, "Analytic reprojection finished");
+    LOG_TIMING(elapsed, "Streamed reprojection finished (%.0f MB/s gathered, %.3f s in the strip consumer)",
+               reproj_gathered_mb(valid_pixels, bpp) / (elapsed - t_emit), t_emit);
+    return status;
+}
 
-    return geo_image;
+
+// Scan angles (rad) of a geographic point: the forward fixed-grid projection of
+// reproject_image_analytical() with the plan's ellipsoid. False if the point is
+// not visible from the satellite.
+static bool geo_to_scan(const NavPlan* plan, double lat_deg, double lon_deg,
+                        double* x_rad, double* y_rad) {
+    double a2 = plan->sm_maj * plan->sm_maj;
+    double b2 = plan->sm_min * plan->sm_min;
+    double e2 = (a2 - b2) / a2;
+    double H = plan->H;
+
+    double phi = lat_deg * (M_PI / 180.0);
+    double phi_c = atan((b2 / a2) * tan(phi));
+    double cos_phi_c = cos(phi_c);
+    double r_c = plan->sm_min / sqrt(1.0 - e2 * cos_phi_c * cos_phi_c);
+    double d_lambda = lon_deg * (M_PI / 180.0) - plan->lambda_0;
+
+    double s_x = H - r_c * cos_phi_c * cos(d_lambda);
+    double s_y = -r_c * cos_phi_c * sin(d_lambda);
+    double s_z = r_c * sin(phi_c);
+    if (H * (H - s_x) < s_y * s_y + (a2 / b2) * s_z * s_z) return false;
+
+    double s_n = sqrt(s_x * s_x + s_y * s_y + s_z * s_z);
+    *x_rad = asin(-s_y / s_n);
+    *y_rad = atan2(s_z, s_x);
+    return true;
 }
 
+// Index of the element of the monotonic array v[n] (x_rad grows, y_rad
+// decreases) closest to t, or -1 if t lies more than half a pixel past either
+// end (the point falls outside the sector).
+static int nearest_index(const double* v, size_t n, double t) {
+    bool up = v[n - 1] >= v[0];
+    double lo_edge = v[0] - 0.5 * (v[1] - v[0]);
+    double hi_edge = v[n - 1] + 0.5 * (v[n - 1] - v[n - 2]);
+    if (up ? (t < lo_edge || t > hi_edge) : (t > lo_edge || t < hi_edge)) return -1;
+    size_t lo = 0, hi = n - 1;
+    while (hi - lo > 1) {
+        size_t mid = lo + (hi - lo) / 2;
+        if ((v[mid] <= t) == up) lo = mid;
+        else hi = mid;
+    }
+    return (int)(fabs(v[lo] - t) <= fabs(v[hi] - t) ? lo : hi);
+}
+
+// Lat/lon (degrees) of pixel (ix, iy) of the plan's grid, rounded to float like
+// the navigation grids (the libm kernel of compute_navigation_nc()). False if
+// the pixel does not see the Earth, i.e. it is NonData in the grids.
+static bool pixel_latlon(const NavPlan* plan, size_t ix, size_t iy, float* lat, float* lon) {
+    double snx = sin(plan->x_rad[ix]), csx = cos(plan->x_rad[ix]);
+    double sny = sin(plan->y_rad[iy]), csy = cos(plan->y_rad[iy]);
+    double sm_maj2 = plan->sm_maj * plan->sm_maj;
+    double sm_min2 = plan->sm_min * plan->sm_min;
+    double H = plan->H;
+
+    double a = snx * snx + csx * csx * (csy * csy + (sm_maj2 / sm_min2) * sny * sny);
+    double b = -2.0 * H * csx * csy;
+    double disc = b * b - 4.0 * a * (H * H - sm_maj2);
+    if (disc < 0.0) return false;
+    double rs = (-b - sqrt(disc)) / (2.0 * a);
+    double px = rs * csx * csy;
+    double py = -rs * snx;
+    double pz = rs * csx * sny;
+    *lat = (float)(atan2(sm_maj2 * pz, sm_min2 * sqrt((H - px) * (H - px) + py * py)) *
+                   (180.0 / M_PI));
+    *lon = (float)((plan->lambda_0 - atan2(py, H - px)) * (180.0 / M_PI));
+    return true;
+}
 
-int reprojection_find_bounding_box(const DataF* navla, const DataF* navlo,
+// The pixel reprojection_find_pixel_for_coord() would pick for (lat, lon),
+// starting from (ix, iy), the one its scan angles fall on: the nearest valid
+// pixel in degrees among the 5x5 around. Away from the limb the grid is close
+// to square in degrees and the pick is one of the inner 3x3; false if it lands
+// on the outer ring (a nearer pixel may lie farther out) or none sees the Earth.
+static bool snap_to_grid_pick(const NavPlan* plan, float lat, float lon, int* ix, int* iy) {
+    const int R = 2;
+    float min_dist_sq = FLT_MAX;
+    int best_ix = -1, best_iy = -1;
+    for (int j = *iy - R; j <= *iy + R; j++) {
+        if (j < 0 || j >= (int)plan->height) continue;
+        for (int i = *ix - R; i <= *ix + R; i++) {
+            if (i < 0 || i >= (int)plan->width) continue;
+            float la, lo;
+            if (!pixel_latlon(plan, (size_t)i, (size_t)j, &la, &lo)) continue;
+            float lat_diff = la - lat;
+            float lon_diff = lo - lon;
+            if (lon_diff > 180.0f) lon_diff -= 360.0f;
+            else if (lon_diff < -180.0f) lon_diff += 360.0f;
+            float dist_sq = lat_diff * lat_diff + lon_diff * lon_diff;
+            if (dist_sq < min_dist_sq) {
+                min_dist_sq = dist_sq;
+                best_ix = i;
+                best_iy = j;
+            }
+        }
+    }
+    if (best_ix < 0 || abs(best_ix - *ix) == R || abs(best_iy - *iy) == R) return false;
+    *ix = best_ix;
+    *iy = best_iy;
+    return true;
+}
+
+// Pixel box {min_ix, min_iy, max_ix, max_iy} of a clip domain in the plan's
+// grid: the edge samples of the grid search, projected to scan angles, located
+// in x_rad/y_rad by bisection and snapped to the pixel the search would pick.
+// False if the domain crosses the limb or the border of the sector, where the
+// search snaps samples to the nearest valid pixel in degrees; it decides those.
+static bool plan_bounding_box(const NavPlan* plan, const float clip_coords[4], int box[4]) {
+    if (!plan || !plan->x_rad || !plan->y_rad || plan->width < 2 || plan->height < 2)
+        return false;
+    const int SAMPLES_PER_EDGE = 20;
+    float lon_min = clip_coords[0], lat_max = clip_coords[1];
+    float lon_max = clip_coords[2], lat_min = clip_coords[3];
+    int min_ix = INT_MAX, max_ix = INT_MIN;
+    int min_iy = INT_MAX, max_iy = INT_MIN;
+
+    for (int s = 0; s <= SAMPLES_PER_EDGE; s++) {
+        float t = (float)s / (float)SAMPLES_PER_EDGE;
+        float lon = lon_min + t * (lon_max - lon_min);
+        float lat = lat_min + t * (lat_max - lat_min);
+        const float pts[4][2] = {
+            {lat_max, lon}, {lat_min, lon}, {lat, lon_min}, {lat, lon_max}
+        };
+        for (int k = 0; k < 4; k++) {
+            double x, y;
+            if (!geo_to_scan(plan, pts[k][0], pts[k][1], &x, &y)) {
+                LOG_DEBUG("Clip domain crosses the limb; using the navigation grid");
+                return false;
+            }
+            int ix = nearest_index(plan->x_rad, plan->width, x);
+            int iy = nearest_index(plan->y_rad, plan->height, y);
+            if (ix < 0 || iy < 0) {
+                LOG_DEBUG("Clip domain leaves the sector; using the navigation grid");
+                return false;
+            }
+            if (!snap_to_grid_pick(plan, pts[k][0], pts[k][1], &ix, &iy)) {
+                LOG_DEBUG("Clip edge next to the limb; using the navigation grid");
+                return false;
+            }
+            if (ix < min_ix) min_ix = ix;
+            if (ix > max_ix) max_ix = ix;
+            if (iy < min_iy) min_iy = iy;
+            if (iy > max_iy) max_iy = iy;
+        }
+    }
+    box[0] = min_ix;
+    box[1] = min_iy;
+    box[2] = max_ix;
+    box[3] = max_iy;
+    return true;
+}
+
+// Box {min_ix, min_iy, max_ix, max_iy} grown by `margin` pixels per side, its
+// corners snapped outwards to multiples of `align`, clamped to the grid.
+static void box_to_window(const int box[4], int margin, int align,
+                          size_t width, size_t height, PixelWindow* win) {
+    if (align < 1) align = 1;
+    int x0 = box[0] - margin, y0 = box[1] - margin;
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    x0 -= x0 % align;
+    y0 -= y0 % align;
+    int x1 = (box[2] + 1 + margin + align - 1) / align * align;
+    int y1 = (box[3] + 1 + margin + align - 1) / align * align;
+    if (x1 > (int)width) x1 = (int)width;
+    if (y1 > (int)height) y1 = (int)height;
+
+    win->x0 = (unsigned int)x0;
+    win->y0 = (unsigned int)y0;
+    win->width = (unsigned int)(x1 - x0);
+    win->height = (unsigned int)(y1 - y0);
+}
+
+int reprojection_find_bounding_box(const NavPlan* plan, const DataF* navla, const DataF* navlo,
                                    float clip_lon_min, float clip_lat_max,
                                    float clip_lon_max, float clip_lat_min,
                                    int* out_x_start, int* out_y_start,
                                    int* out_width, int* out_height) {
     const int SAMPLES_PER_EDGE = 20;
+    const float clip_coords[4] = {clip_lon_min, clip_lat_max, clip_lon_max, clip_lat_min};
+    int box[4];
+    *out_x_start = 0;
+    *out_y_start = 0;
+    *out_width = 0;
+    *out_height = 0;
+
+    if (plan && !getenv("HPSV_NO_ANALYTIC_CLIP") && plan_bounding_box(plan, clip_coords, box)) {
+        *out_x_start = box[0];
+        *out_y_start = box[1];
+        *out_width = box[2] - box[0] + 1;
+        *out_height = box[3] - box[1] + 1;
+        LOG_DEBUG("Clip box from the fixed-grid geometry: %d,%d %dx%d px", *out_x_start,
+                  *out_y_start, *out_width, *out_height);
+        return 4 * (SAMPLES_PER_EDGE + 1);
+    }
+    if (!navla || !navla->data_in || !navlo || !navlo->data_in) {
+        LOG_DEBUG("No navigation grid to search the clip in.");
+        return 0;
+    }
+
     int min_ix = INT_MAX, max_ix = INT_MIN;
     int min_iy = INT_MAX, max_iy = INT_MIN;
     int valid_samples = 0;
@@ -448,12 +1025,57 @@ int reprojection_find_bounding_box(const DataF* navla, const DataF* navlo,
         *out_y_start = min_iy;
         *out_width = max_ix - min_ix + 1;
         *out_height = max_iy - min_iy + 1;
-    } else {
-        *out_x_start = 0;
-        *out_y_start = 0;
-        *out_width = 0;
-        *out_height = 0;
     }
     
     return valid_samples;
 }
+
+bool reprojection_clip_window(const DataF* navla, const DataF* navlo,
+                              const float clip_coords[4], int margin, int align,
+                              PixelWindow* win) {
+    int ix, iy, iw, ih;
+    reprojection_find_bounding_box(NULL, navla, navlo, clip_coords[0], clip_coords[1],
+                                   clip_coords[2], clip_coords[3], &ix, &iy, &iw, &ih);
+    if (iw <= 0 || ih <= 0) return false;
+    const int box[4] = {ix, iy, ix + iw - 1, iy + ih - 1};
+    box_to_window(box, margin, align, navla->width, navla->height, win);
+    return true;
+}
+
+bool reprojection_clip_window_plan(const NavPlan* plan, const float clip_coords[4],
+                                   int margin, int align, PixelWindow* win) {
+    int box[4];
+    if (!plan_bounding_box(plan, clip_coords, box)) return false;
+    box_to_window(box, margin, align, plan->width, plan->height, win);
+    return true;
+}
+
+bool reprojection_clip_navigation(const char* filename, const float clip_coords[4],
+                                  int margin, int align, PixelWindow* win,
+                                  DataF* navla, DataF* navlo) {
+    double t0 = omp_get_wtime();
+    NavPlan plan;
+    if (!getenv("HPSV_NO_ANALYTIC_CLIP") && nav_build_plan(filename, &plan) == 0) {
+        bool ok = reprojection_clip_window_plan(&plan, clip_coords, margin, align, win) &&
+                  compute_navigation_window(&plan, win, navla, navlo) == 0;
+        nav_plan_destroy(&plan);
+        if (ok) {
+            LOG_TIMING(omp_get_wtime() - t0, "Analytic clip window and its navigation");
+            return true;
+        }
+    }
+
+    // Whole-grid navigation and nearest-pixel search, then crop.
+    DataF la = {0}, lo = {0};
+    if (compute_navigation_nc(filename, &la, &lo) != 0) return false;
+    bool ok = reprojection_clip_window(&la, &lo, clip_coords, margin, align, win);
+    if (ok) {
+        *navla = dataf_crop(&la, win->x0, win->y0, win->width, win->height);
+        *navlo = dataf_crop(&lo, win->x0, win->y0, win->width, win->height);
+        ok = navla->data_in && navlo->data_in;
+        if (!ok) { dataf_destroy(navla); dataf_destroy(navlo); }
+    }
+    dataf_destroy(&la);
+    dataf_destroy(&lo);
+    return ok;
+}
@@ -31,6 +31,7 @@
 #include "reader_webp.h"
 #include "reprojection.h"
 #include "rgb.h"
+#include "rgb_recipe.h"
 #include "truecolor.h"
 #include "writer_geotiff.h"
 #include "writer_png.h"
@@ -48,14 +49,18 @@ void rgb_context_destroy(RgbContext *ctx) {
     if (!ctx)
         return;
 
-    channelset_destroy(ctx->channel_set);
+    // Los productos de un batch solo toman prestados canales y navegación de la
+    // escena; los libera quien la cargó.
+    if (!ctx->shared_scene) {
+        channelset_destroy(ctx->channel_set);
 
-    for (int i = 1; i <= 16; i++) {
-        datanc_destroy(&ctx->channels[i]);
-    }
+        for (int i = 1; i <= 16; i++) {
+            datanc_destroy(&ctx->channels[i]);
+        }
 
-    dataf_destroy(&ctx->nav_lat);
-    dataf_destroy(&ctx->nav_lon);
+        dataf_destroy(&ctx->nav_lat);
+        dataf_destroy(&ctx->nav_lon);
+    }
 
     dataf_destroy(&ctx->comp_r);
     dataf_destroy(&ctx->comp_g);
@@ -182,6 +187,7 @@ static bool compose_truecolor(RgbContext *ctx) {
     DataF *ch_blue = &ctx->channels[1].fdata; // C01
     DataF *ch_red = &ctx->channels[2].fdata;  // C02
     DataF *ch_nir = &ctx->channels[3].fdata;  // C03
+    DataF nir_copy = {0};
 
     ctx->comp_b = dataf_copy(ch_blue);
     ctx->comp_r = dataf_copy(ch_red);
@@ -190,18 +196,29 @@ static bool compose_truecolor(RgbContext *ctx) {
 
     // Rayleigh correction.
     if (ctx->opts.apply_rayleigh || ctx->opts.rayleigh_analytic) {
+        // La corrección cenital se aplica a C03 en su lugar; en un batch C03 es
+        // de la escena y lo leen los demás productos, así que se corrige una copia.
+        if (ctx->shared_scene) {
+            nir_copy = dataf_copy(ch_nir);
+            if (!nir_copy.data_in)
+                return false;
+            ch_nir = &nir_copy;
+        }
         RayleighNav nav = {0};
         bool nav_ok = load_rayleigh_nav(ctx, &nav, ctx->comp_b.width, ctx->comp_b.height);
         if (nav_ok) {
-            apply_solar_zenith_correction(&ctx->comp_b, &nav.sza);
-            apply_solar_zenith_correction(&ctx->comp_r, &nav.sza);
-            apply_solar_zenith_correction(ch_nir, &nav.sza);
+            apply_solar_zenith_correction(&ctx->comp_b, &nav);
+            apply_solar_zenith_correction(&ctx->comp_r, &nav);
+            apply_solar_zenith_correction(ch_nir, &nav);
             if (ctx->opts.rayleigh_analytic) {
                 analytic_rayleigh_correction(&ctx->comp_b, &nav, 0.47);
                 analytic_rayleigh_correction(&ctx->comp_r, &nav, 0.64);
             } else {
-                luts_rayleigh_correction(&ctx->comp_b, &nav, 1, &ctx->comp_r);
-                luts_rayleigh_correction(&ctx->comp_r, &nav, 2, NULL);
+                // C01 relaxes over clouds with the uncorrected C02.
+                DataF *bands[2] = {&ctx->comp_b, &ctx->comp_r};
+                const uint8_t channels[2] = {1, 2};
+                const DataF *redbands[2] = {&ctx->comp_r, NULL};
+                luts_rayleigh_correction_bands(bands, channels, redbands, 2, &nav);
             }
             rayleigh_free_navigation(&nav);
         } else {
@@ -210,6 +227,7 @@ static bool compose_truecolor(RgbContext *ctx) {
     }
     // 3. Generate the green channel.
     ctx->comp_g = create_truecolor_synthetic_green(&ctx->comp_b, &ctx->comp_r, ch_nir);
+    dataf_destroy(&nir_copy);
     if (!ctx->comp_g.data_in)
         return false;
     // Green formula already uses geo2grid-matched CIMSS coefficients; no extra boost needed.
@@ -582,56 +600,35 @@ static bool compose_night(RgbContext *ctx) {
     return true;
 }
 
-static bool compose_ash(RgbContext *ctx) {
-    ctx->comp_r = dataf_op_dataf(&ctx->channels[15].fdata, &ctx->channels[13].fdata, OP_SUB);
-    ctx->comp_g = dataf_op_dataf(&ctx->channels[14].fdata, &ctx->channels[11].fdata, OP_SUB);
-    ctx->comp_b = dataf_copy(&ctx->channels[13].fdata);
-    ctx->min_r = -6.7f;
-    ctx->max_r = 2.6f;
-    ctx->min_g = -6.0f;
-    ctx->max_g = 6.3f;
-    ctx->min_b = 243.6f;
-    ctx->max_b = 302.4f;
-    return true;
-}
-
-static bool compose_severestorm(RgbContext *ctx) {
-    ctx->comp_r = dataf_op_dataf(&ctx->channels[8].fdata, &ctx->channels[10].fdata, OP_SUB);
-    ctx->comp_g = dataf_op_dataf(&ctx->channels[7].fdata, &ctx->channels[13].fdata, OP_SUB);
-    ctx->comp_b = dataf_op_dataf(&ctx->channels[5].fdata, &ctx->channels[2].fdata, OP_SUB);
-    ctx->min_r = -35.0f;
-    ctx->max_r = 5.0f;
-    ctx->min_g = -5.0f;
-    ctx->max_g = 60.0f;
-    ctx->min_b = -0.75f;
-    ctx->max_b = 0.25f;
-    return true;
-}
-
-static bool compose_airmass(RgbContext *ctx) {
-    ctx->comp_r = dataf_op_dataf(&ctx->channels[8].fdata, &ctx->channels[10].fdata, OP_SUB);
-    ctx->comp_g = dataf_op_dataf(&ctx->channels[12].fdata, &ctx->channels[13].fdata, OP_SUB);
-    ctx->comp_b = dataf_op_scalar(&ctx->channels[8].fdata, 273.15f, OP_SUB, true);
-    ctx->min_r = -26.2f;
-    ctx->max_r = 0.6f;
-    ctx->min_g = -43.2f;
-    ctx->max_g = 6.7f;
-    ctx->min_b = 29.25f;
-    ctx->max_b = 64.65f;
-    return true;
+// Renders three band expressions straight to final_image (src/rgb_recipe.c).
+// The user's per-channel gamma (-g) composes with the recipe's:
+// (n^(1/g1))^(1/g2) = n^(1/(g1*g2)). As in the float-grid path, it is consumed
+// here, so later products of a batch start again from 1.
+static bool render_combos(RgbContext *ctx, const LinearCombo combo[3], const float range[3][2],
+                          const float recipe_gamma[3]) {
+    float gamma[3];
+    for (int c = 0; c < 3; c++) gamma[c] = recipe_gamma[c] * ctx->opts.gamma[c];
+    if (fabsf(ctx->opts.gamma[0] - 1.0f) > 1e-6f || fabsf(ctx->opts.gamma[1] - 1.0f) > 1e-6f ||
+        fabsf(ctx->opts.gamma[2] - 1.0f) > 1e-6f) {
+        LOG_INFO("Applying gamma R=%.2f G=%.2f B=%.2f", ctx->opts.gamma[0], ctx->opts.gamma[1],
+                 ctx->opts.gamma[2]);
+        ctx->opts.gamma[0] = ctx->opts.gamma[1] = ctx->opts.gamma[2] = 1.0f;
+    }
+    ctx->final_image = rgb_recipe_render(combo, range, gamma, ctx->channels);
+    return ctx->final_image.data != NULL;
 }
 
-static bool compose_so2(RgbContext *ctx) {
-    ctx->comp_r = dataf_op_dataf(&ctx->channels[9].fdata, &ctx->channels[10].fdata, OP_SUB);
-    ctx->comp_g = dataf_op_dataf(&ctx->channels[13].fdata, &ctx->channels[11].fdata, OP_SUB);
-    ctx->comp_b = dataf_copy(&ctx->channels[13].fdata);
-    ctx->min_r = -4.0f;
-    ctx->max_r = 2.0f;
-    ctx->min_g = -4.0f;
-    ctx->max_g = 5.0f;
-    ctx->min_b = 233.0f;
-    ctx->max_b = 300.0f;
-    return true;
+static bool compose_recipe(RgbContext *ctx, const RgbRecipe *recipe) {
+    LinearCombo combo[3];
+    if (rgb_recipe_compile(recipe, combo) != 0)
+        return false;
+    float range[3][2], gamma[3];
+    for (int c = 0; c < 3; c++) {
+        range[c][0] = recipe->ch[c].min;
+        range[c][1] = recipe->ch[c].max;
+        gamma[c] = recipe->ch[c].gamma;
+    }
+    return render_combos(ctx, combo, range, gamma);
 }
 
 static bool compose_daynite(RgbContext *ctx) {
@@ -700,42 +697,54 @@ static bool compose_custom(RgbContext *ctx) {
     LOG_DEBUG("Custom RGB ranges: %s: %f,%f  %f,%f %f,%f", ctx->opts.minmax, ranges[0][0],
               ranges[0][1], ranges[1][0], ranges[1][1], ranges[2][0], ranges[2][1]);
 
-    // 3. Evaluate the linear combinations.
-    ctx->comp_r = evaluate_linear_combo(&combo[0], ctx->channels);
-    ctx->comp_g = evaluate_linear_combo(&combo[1], ctx->channels);
-    ctx->comp_b = evaluate_linear_combo(&combo[2], ctx->channels);
-
-    if (!ctx->comp_r.data_in || !ctx->comp_g.data_in || !ctx->comp_b.data_in) {
+    // 3. Evaluate and stretch in one pass, like the built-in recipes.
+    static const float linear[3] = {1.0f, 1.0f, 1.0f};
+    if (!render_combos(ctx, combo, (const float(*)[2])ranges, linear)) {
         LOG_ERROR("Failed to evaluate custom mode math formulas.");
         return false;
     }
-
-    // 4. Assign ranges.
-    ctx->min_r = ranges[0][0];
-    ctx->max_r = ranges[0][1];
-    ctx->min_g = ranges[1][0];
-    ctx->max_g = ranges[1][1];
-    ctx->min_b = ranges[2][0];
-    ctx->max_b = ranges[2][1];
-
     return true;
 }
 
+// Band-algebra composites: R, G, B as {expression, min, max, gamma}. The bands
+// an expression uses must also be in the mode's req_channels.
+static const RgbRecipe RECIPE_ASH = {{
+    {"C15-C13", -6.7f, 2.6f, 1.0f},
+    {"C14-C11", -6.0f, 6.3f, 1.0f},
+    {"C13", 243.6f, 302.4f, 1.0f},
+}};
+static const RgbRecipe RECIPE_AIRMASS = {{
+    {"C08-C10", -26.2f, 0.6f, 1.0f},
+    {"C12-C13", -43.2f, 6.7f, 1.0f},
+    {"273.15-C08", 29.25f, 64.65f, 1.0f},
+}};
+static const RgbRecipe RECIPE_SEVERESTORM = {{
+    {"C08-C10", -35.0f, 5.0f, 1.0f},
+    {"C07-C13", -5.0f, 60.0f, 1.0f},
+    {"C05-C02", -0.75f, 0.25f, 1.0f},
+}};
+static const RgbRecipe RECIPE_SO2 = {{
+    {"C09-C10", -4.0f, 2.0f, 1.0f},
+    {"C13-C11", -4.0f, 5.0f, 1.0f},
+    {"C13", 233.0f, 300.0f, 1.0f},
+}};
+
 static const RgbStrategy STRATEGIES[] = {
     {"truecolor",
      {"C01", "C02", "C03", NULL},
      compose_truecolor,
      "True Color",
-     false},
-    {"night", {"C13", NULL}, compose_night, "Nocturnal IR with temperature", false},
-    {"ash", {"C11", "C13", "C14", "C15", NULL}, compose_ash, "Volcanic Ash", false},
-    {"airmass", {"C08", "C10", "C12", "C13", NULL}, compose_airmass, "Air Mass", false},
-    {"severestorm", {"C02", "C05", "C07", "C08", "C10", "C13", NULL}, compose_severestorm,
-     "Severe Convection", false},
-    {"so2", {"C09", "C10", "C11", "C13", NULL}, compose_so2, "SO2 Detection", false},
-    {"daynite", {"C01", "C02", "C03", "C13", NULL}, compose_daynite, "Day/Night Composite", true},
-    {"custom", {NULL}, compose_custom, "Custom mode", false},
-    {NULL, {NULL}, NULL, NULL, false} // Sentinel.
+     false,
+     NULL},
+    {"night", {"C13", NULL}, compose_night, "Nocturnal IR with temperature", false, NULL},
+    {"ash", {"C11", "C13", "C14", "C15", NULL}, NULL, "Volcanic Ash", false, &RECIPE_ASH},
+    {"airmass", {"C08", "C10", "C12", "C13", NULL}, NULL, "Air Mass", false, &RECIPE_AIRMASS},
+    {"severestorm", {"C02", "C05", "C07", "C08", "C10", "C13", NULL}, NULL,
+     "Severe Convection", false, &RECIPE_SEVERESTORM},
+    {"so2", {"C09", "C10", "C11", "C13", NULL}, NULL, "SO2 Detection", false, &RECIPE_SO2},
+    {"daynite", {"C01", "C02", "C03", "C13", NULL}, compose_daynite, "Day/Night Composite", true, NULL},
+    {"custom", {NULL}, compose_custom, "Custom mode", false, NULL},
+    {NULL, {NULL}, NULL, NULL, false, NULL} // Sentinel.
 };
 
 static const RgbStrategy *get_strategy_for_mode(const char *mode) {
@@ -751,7 +760,91 @@ static const RgbStrategy *get_strategy_for_mode(const char *mode) {
 
 // --- PHASE 3: MAIN PIPELINE (THE RUNNER) ---
 
-static bool load_channels(RgbContext *ctx, const char **req_channels) {
+// Lectura por ventana para el clip en la malla nativa: un recorte de México en
+// disco completo usa ~3% de los píxeles, así que solo se leen (y descomprimen)
+// los chunks alrededor del recuadro. Se activa únicamente cuando la salida no
+// puede depender del resto del disco: rangos fijos por composite, sin
+// histograma/CLAHE (estadística global), sin reproyección, sin daynite (la
+// mezcla se decide con el % de noche de toda la escena), sin luces de ciudad
+// (el fondo va por ancho de disco) y sin --full-res (upsample_bilinear no es
+// invariante a traslaciones). HPSV_NO_CLIP_WINDOW=1 fuerza la lectura completa.
+//
+// Si aplica, deja en `win` la ventana en píxeles del canal de referencia `ref`
+// (ver plan_reference) y la navegación ya recortada a la ventana en
+// ctx->nav_lat/nav_lon.
+static bool clip_window_allowed(const RgbOptions *o) {
+    return o->has_clip && !o->do_reprojection && !o->save_both && !o->use_full_res &&
+           !o->use_cuda && !o->apply_histogram && !o->apply_clahe && !o->use_citylights &&
+           strcmp(o->mode, "daynite") != 0 && !getenv("HPSV_NO_CLIP_WINDOW");
+}
+
+static bool plan_clip_window(RgbContext *ctx, int ref, PixelWindow *win) {
+    const RgbOptions *o = &ctx->opts;
+    if (!clip_window_allowed(o))
+        return false;
+
+    const char *ref_file = NULL;
+    for (int i = 0; i < ctx->channel_set->count; i++)
+        if (atoi(ctx->channel_set->channels[i].name + 1) == ref)
+            ref_file = ctx->channel_set->channels[i].filename;
+    // Margen para los filtros con vecindad (promedio 2x2 del sharpen, bordes del
+    // box filter) y esquinas alineadas a 4: la mayor razón entre resoluciones ABI
+    // (0.5 km vs 2 km), para que los bloques del remuestreo caigan igual que en
+    // el disco completo. La ventana sale de la proyección analítica y solo se
+    // navega la ventana (ver reprojection_clip_navigation).
+    if (!ref_file || !reprojection_clip_navigation(ref_file, o->clip_coords, 8, 4, win,
+                                                   &ctx->nav_lat, &ctx->nav_lon))
+        return false;
+    ctx->has_navigation = true;
+    ctx->load_window = *win;
+    LOG_INFO("Clip window: %u,%u %ux%u px of C%02d", win->x0, win->y0, win->width,
+             win->height, ref);
+    return true;
+}
+
+// Resolución nativa (km) de cada canal del ChannelSet, leída de los
+// encabezados. false si alguno no se pudo leer.
+static bool channel_resolutions(const RgbContext *ctx, float res[17]) {
+    for (int i = 0; i < ctx->channel_set->count; i++) {
+        const char *fn = ctx->channel_set->channels[i].filename;
+        int cn = atoi(ctx->channel_set->channels[i].name + 1);
+        if (!fn || cn <= 0 || cn > 16)
+            return false;
+        DataNC hdr;
+        if (load_nc_header(fn, &hdr) != 0)
+            return false;
+        free((void *)hdr.varname);
+        res[cn] = hdr.native_resolution_km;
+        if (res[cn] <= 0.0f)
+            return false;
+    }
+    return true;
+}
+
+// Solo metadatos: la referencia es el canal de menor resolución, la misma
+// elección que hace load_channels() con los datos ya cargados, y factor[cn] es
+// la razón de resolución de cada canal respecto a ella. Conocerla antes de leer
+// permite reducir los canales finos mientras se descomprimen (load_nc_sf_reduced):
+// C02 a 0.5 km para un compuesto a 1 o 2 km nunca existe completo en memoria
+// (~1.9 GB en disco completo). Devuelve 0 si algún encabezado no se pudo leer.
+static int plan_reference(const RgbContext *ctx, int factor[17]) {
+    float res[17] = {0};
+    int ref = 0;
+    if (!channel_resolutions(ctx, res))
+        return 0;
+    for (int i = 0; i < ctx->channel_set->count; i++) {
+        int cn = atoi(ctx->channel_set->channels[i].name + 1);
+        if (ref == 0 || res[cn] > res[ref])
+            ref = cn;
+    }
+    for (int cn = 1; cn <= 16; cn++)
+        factor[cn] = res[cn] > 0.0f ? (int)(res[ref] / res[cn] + 0.5f) : 1;
+    return ref;
+}
+
+// Pasos 1-3 de load_channels(): el ChannelSet de req_channels con el archivo de
+// cada canal, sin leer datos. false con ctx->error_msg puesto si falla.
+static bool locate_channels(RgbContext *ctx, const char **req_channels) {
     // 1. Create the ChannelSet.
     int count = 0;
     while (req_channels[count] != NULL)
@@ -796,8 +889,28 @@ static bool load_channels(RgbContext *ctx, const char **req_channels) {
         return false;
     }
     free(input_dup_dir);
+    return true;
+}
+
+static bool load_channels(RgbContext *ctx, const char **req_channels) {
+    if (!locate_channels(ctx, req_channels))
+        return false;
 
-    // 4. Load channels and validate.
+    // 4. Load channels and validate (only the clip window when it is safe, and
+    // the finer channels already reduced to the reference resolution).
+    // HPSV_NO_DECIMATED_LOAD=1 loads them at full resolution and resamples after.
+    PixelWindow win = {0};
+    int win_factor[17] = {0};
+    int plan_ref = ctx->opts.use_full_res ? 0 : plan_reference(ctx, win_factor);
+    bool windowed = plan_ref > 0 && plan_clip_window(ctx, plan_ref, &win);
+    bool decimate = plan_ref > 0 && !getenv("HPSV_NO_DECIMATED_LOAD");
+
+    // All files go through one batch, so the serial HDF5 phase of one channel
+    // overlaps the parallel decode of another (load_nc_sf_batch).
+    NCLoadJob jobs[16];
+    PixelWindow cwin[16];
+    int job_cn[16];
+    int njobs = 0;
     for (int i = 0; i < ctx->channel_set->count; i++) {
         if (!ctx->channel_set->channels[i].filename) {
             snprintf(ctx->error_msg, sizeof(ctx->error_msg), "Falta archivo para canal %s",
@@ -805,28 +918,45 @@ static bool load_channels(RgbContext *ctx, const char **req_channels) {
             return false;
         }
         int cn = atoi(ctx->channel_set->channels[i].name + 1); // "C01" -> 1
-        if (cn > 0 && cn <= 16) {
-            LOG_DEBUG("Loading channel C%02d from %s", cn, ctx->channel_set->channels[i].filename);
-            if (load_nc_sf(ctx->channel_set->channels[i].filename, &ctx->channels[cn]) != 0) {
-                snprintf(ctx->error_msg, sizeof(ctx->error_msg), "Falla al cargar NetCDF: %s",
-                         ctx->channel_set->channels[i].filename);
-                return false;
-            }
+        if (cn <= 0 || cn > 16 || njobs == 16)
+            continue;
+        LOG_DEBUG("Loading channel C%02d from %s", cn, ctx->channel_set->channels[i].filename);
+        cwin[njobs] = (PixelWindow){win.x0 * win_factor[cn], win.y0 * win_factor[cn],
+                                    win.width * win_factor[cn], win.height * win_factor[cn]};
+        jobs[njobs] = (NCLoadJob){ctx->channel_set->channels[i].filename,
+                                  windowed ? &cwin[njobs] : NULL,
+                                  decimate && win_factor[cn] > 1 ? win_factor[cn] : 1,
+                                  &ctx->channels[cn], 0, 0.0};
+        job_cn[njobs++] = cn;
+    }
+    load_nc_sf_batch(jobs, njobs);
 
-            if (ctx->opts.use_full_res) {
-                // Select highest resolution (smallest km value) for --full-res.
-                if (ctx->ref_channel_idx == 0 ||
-                    ctx->channels[cn].native_resolution_km <
-                        ctx->channels[ctx->ref_channel_idx].native_resolution_km) {
-                    ctx->ref_channel_idx = cn;
-                }
-            } else {
-                // Default: select lowest resolution (largest km value).
-                if (ctx->ref_channel_idx == 0 ||
-                    ctx->channels[cn].native_resolution_km >
-                        ctx->channels[ctx->ref_channel_idx].native_resolution_km) {
-                    ctx->ref_channel_idx = cn;
-                }
+    for (int j = 0; j < njobs; j++) {
+        int cn = job_cn[j];
+        if (jobs[j].status != 0) {
+            snprintf(ctx->error_msg, sizeof(ctx->error_msg), "Falla al cargar NetCDF: %s",
+                     jobs[j].filename);
+            return false;
+        }
+        LOG_TIMING(jobs[j].seconds, "Load C%02d", cn);
+        // Reduced while loading: now at the reference resolution, but its file
+        // is not the one the navigation grid comes from.
+        if (jobs[j].factor > 1)
+            continue;
+
+        if (ctx->opts.use_full_res) {
+            // Select highest resolution (smallest km value) for --full-res.
+            if (ctx->ref_channel_idx == 0 ||
+                ctx->channels[cn].native_resolution_km <
+                    ctx->channels[ctx->ref_channel_idx].native_resolution_km) {
+                ctx->ref_channel_idx = cn;
+            }
+        } else {
+            // Default: select lowest resolution (largest km value).
+            if (ctx->ref_channel_idx == 0 ||
+                ctx->channels[cn].native_resolution_km >
+                    ctx->channels[ctx->ref_channel_idx].native_resolution_km) {
+                ctx->ref_channel_idx = cn;
             }
         }
     }
@@ -885,6 +1015,46 @@ static bool load_channels(RgbContext *ctx, const char **req_channels) {
     return true;
 }
 
+// Recuadro del recorte en la malla del canal de referencia (la del archivo o la
+// ventana leída de él), sacado de su geometría: reprojection_find_bounding_box
+// con el plan del archivo, por bisección y sin malla lat/lon. Solo si el
+// recorte cruza el limbo o se sale del sector se busca en nav_lat/nav_lon, si
+// están en host. false si el recorte no cae en la malla.
+static bool clip_crop_box(const RgbContext *ctx, PixelWindow *box) {
+    const DataF *ref = &ctx->channels[ctx->ref_channel_idx].fdata;
+    const PixelWindow *w = &ctx->load_window;
+    NavPlan plan;
+    if (nav_build_plan(rgb_ref_filename(ctx), &plan) == 0 && w->width > 0) {
+        NavPlan full = plan;
+        nav_plan_window(&full, w->x0, w->y0, w->width, w->height, &plan);
+        nav_plan_destroy(&full);
+    }
+    bool use_plan = plan.width == ref->width && plan.height == ref->height;
+    bool use_grid = ctx->has_navigation && !ctx->nav_on_device;
+
+    int ix, iy, iw, ih;
+    reprojection_find_bounding_box(use_plan ? &plan : NULL, use_grid ? &ctx->nav_lat : NULL,
+                                   use_grid ? &ctx->nav_lon : NULL, ctx->opts.clip_coords[0],
+                                   ctx->opts.clip_coords[1], ctx->opts.clip_coords[2],
+                                   ctx->opts.clip_coords[3], &ix, &iy, &iw, &ih);
+    nav_plan_destroy(&plan);
+    if (iw <= 0 || ih <= 0)
+        return false;
+    *box = (PixelWindow){(unsigned)ix, (unsigned)iy, (unsigned)iw, (unsigned)ih};
+    return true;
+}
+
+// Con un recorte en la malla nativa, un modo que no usa lat/lon (todos salvo
+// daynite y Rayleigh) solo las querría para recortar, y el recuadro ya sale de
+// la geometría (clip_crop_box): no se navega el disco completo. La escena de un
+// batch sí, porque la comparten productos que pueden necesitarlas.
+static bool navigation_only_for_clip(const RgbContext *ctx, const RgbStrategy *strategy) {
+    const RgbOptions *o = &ctx->opts;
+    return o->has_clip && !o->do_reprojection && !o->save_both && !o->use_cuda &&
+           !o->apply_rayleigh && !o->rayleigh_analytic && !strategy->needs_navigation &&
+           strcmp(strategy->mode_name, "batch") != 0;
+}
+
 static bool process_geospatial(RgbContext *ctx, const RgbStrategy *strategy) {
     // Compute navigation using the reference channel file (already at the target resolution)
     // to avoid computing at full resolution and then resampling.
@@ -900,8 +1070,14 @@ static bool process_geospatial(RgbContext *ctx, const RgbStrategy *strategy) {
     // navegación no se calcularía en ningún lado y fmin/fmax quedarían en cero,
     // colapsando la extensión del reproyectado. Diferir aquí algo que allá no se
     // produce es justo el error que esto evita.
-    if ((truecolor_cuda_eligible(&ctx->opts) && ctx->opts.apply_rayleigh) ||
-        daynite_cuda_eligible(&ctx->opts)) {
+    PixelWindow box;
+    if (ctx->has_navigation) {
+        // Ya calculada y recortada por plan_clip_window() (lectura por ventana).
+        LOG_DEBUG("Navigation already cropped to the clip window.");
+    } else if (navigation_only_for_clip(ctx, strategy) && clip_crop_box(ctx, &box)) {
+        LOG_DEBUG("Clip box from the geometry; no navigation grids needed.");
+    } else if ((truecolor_cuda_eligible(&ctx->opts) && ctx->opts.apply_rayleigh) ||
+               daynite_cuda_eligible(&ctx->opts)) {
         ctx->nav_on_device = true;
         ctx->has_navigation = true;
         LOG_DEBUG("Navegación diferida a la GPU (no se calcula lat/lon en CPU).");
@@ -1049,25 +1225,32 @@ static bool apply_scaling(RgbContext *ctx) {
     return true;
 }
 
-static bool write_output(RgbContext *ctx, const char *product_label) {
-    bool is_geotiff = ctx->opts.force_geotiff ||
-                      (ctx->opts.output_filename && (strstr(ctx->opts.output_filename, ".tif") ||
-                                                     strstr(ctx->opts.output_filename, ".tiff")));
+static bool output_is_geotiff(const RgbContext *ctx) {
+    return ctx->opts.force_geotiff ||
+           (ctx->opts.output_filename && (strstr(ctx->opts.output_filename, ".tif") ||
+                                          strstr(ctx->opts.output_filename, ".tiff")));
+}
 
-    if (is_geotiff) {
-        DataNC meta_out =
-            ctx->channels[ctx->ref_channel_idx]; // Preserves sat_id, sector_id, band_id, timestamp, etc.
+/// GeoTIFF metadata of a width x height lat/lon output over the final extent.
+static DataNC latlon_meta(const RgbContext *ctx, unsigned int width, unsigned int height) {
+    DataNC meta_out =
+        ctx->channels[ctx->ref_channel_idx]; // Preserves sat_id, sector_id, band_id, timestamp, etc.
+    meta_out.proj_code = PROJ_LATLON;
+    meta_out.proj_info.valid = false; // Not applicable for lat/lon.
+    meta_out.geotransform[0] = ctx->final_lon_min;
+    meta_out.geotransform[1] = (ctx->final_lon_max - ctx->final_lon_min) / (double)width;
+    meta_out.geotransform[2] = 0.0;
+    meta_out.geotransform[3] = ctx->final_lat_max;
+    meta_out.geotransform[4] = 0.0;
+    meta_out.geotransform[5] = (ctx->final_lat_min - ctx->final_lat_max) / (double)height;
+    return meta_out;
+}
+
+static bool write_output(RgbContext *ctx, const char *product_label) {
+    if (output_is_geotiff(ctx)) {
+        DataNC meta_out;
         if (ctx->opts.do_reprojection) {
-            meta_out.proj_code = PROJ_LATLON;
-            meta_out.proj_info.valid = false; // Not applicable for lat/lon.
-            meta_out.geotransform[0] = ctx->final_lon_min;
-            meta_out.geotransform[1] =
-                (ctx->final_lon_max - ctx->final_lon_min) / (double)ctx->final_image.width;
-            meta_out.geotransform[2] = 0.0;
-            meta_out.geotransform[3] = ctx->final_lat_max;
-            meta_out.geotransform[4] = 0.0;
-            meta_out.geotransform[5] =
-                (ctx->final_lat_min - ctx->final_lat_max) / (double)ctx->final_image.height;
+            meta_out = latlon_meta(ctx, ctx->final_image.width, ctx->final_image.height);
         } else {
             // Native (geostationary) metadata.
             meta_out = ctx->channels[ctx->ref_channel_idx];
@@ -1097,6 +1280,25 @@ static bool write_output(RgbContext *ctx, const char *product_label) {
     return true;
 }
 
+/**
+ * Reprojects final_image over `plan` strip by strip straight into the output
+ * GeoTIFF (reproject_image_strips), for outputs too big to hold: final_image
+ * stays the fixed-grid composite. The extent (final_lon/lat) must be set.
+ */
+static bool write_output_streamed(RgbContext *ctx, const ReprojPlan *plan,
+                                  const unsigned char *nodata_pixel, const char *product_label) {
+    DataNC meta_out = latlon_meta(ctx, plan->width, plan->height);
+    LOG_INFO("Saving reprojected (streamed): %s", ctx->opts.output_filename);
+    GeoTiffStream *gts = geotiff_stream_open(ctx->opts.output_filename, (int)plan->width,
+                                             (int)plan->height, (int)ctx->final_image.bpp,
+                                             &meta_out, NULL, NULL, product_label,
+                                             ctx->opts.build_cog);
+    if (!gts) return false;
+    int rc = reproject_image_strips(&ctx->final_image, plan, nodata_pixel,
+                                    geotiff_stream_strip, gts);
+    return geotiff_stream_close(gts) == 0 && rc == 0;
+}
+
 // =============================================================================
 // UNIFIED INTERFACE (dependency injection via ProcessConfig)
 // =============================================================================
@@ -1165,57 +1367,48 @@ static void config_to_rgb_context(const ProcessConfig *cfg, RgbContext *ctx) {
     ctx->opts.is_l2_product = (strstr(basename_input, "CMIP") != NULL);
 }
 
-int run_rgb(const ProcessConfig *cfg, MetadataContext *meta) {
-    if (!cfg || !meta) {
-        LOG_ERROR("run_rgb: NULL parameters");
-        return 1;
-    }
-
-    LOG_INFO("Processing RGB: %s", cfg->input_file);
-
-    RgbContext ctx;
-    config_to_rgb_context(cfg, &ctx);
-    int status = 1;
-    char **custom_channels = NULL;
-
+// Metadatos de las opciones, estrategia del modo y nombre largo del producto.
+// NULL si el modo no existe (ya reportado).
+static const RgbStrategy *rgb_begin(RgbContext *ctx, const ProcessConfig *cfg,
+                                    MetadataContext *meta, const char **product) {
     // Use the short product name (-N flag) if provided; otherwise fall back to mode string.
     const char *mode_label = (cfg->product_short && cfg->product_short[0])
                                  ? cfg->product_short
-                                 : (ctx.opts.mode ? ctx.opts.mode : "unknown");
+                                 : (ctx->opts.mode ? ctx->opts.mode : "unknown");
     metadata_add(meta, "mode", mode_label);
 
-    if (fabsf(ctx.opts.gamma[0] - 1.0f) > 1e-6f || fabsf(ctx.opts.gamma[1] - 1.0f) > 1e-6f ||
-        fabsf(ctx.opts.gamma[2] - 1.0f) > 1e-6f) {
-        if (fabsf(ctx.opts.gamma[0] - ctx.opts.gamma[1]) < 1e-6f &&
-            fabsf(ctx.opts.gamma[0] - ctx.opts.gamma[2]) < 1e-6f) {
-            metadata_add(meta, "gamma", ctx.opts.gamma[0]);
+    if (fabsf(ctx->opts.gamma[0] - 1.0f) > 1e-6f || fabsf(ctx->opts.gamma[1] - 1.0f) > 1e-6f ||
+        fabsf(ctx->opts.gamma[2] - 1.0f) > 1e-6f) {
+        if (fabsf(ctx->opts.gamma[0] - ctx->opts.gamma[1]) < 1e-6f &&
+            fabsf(ctx->opts.gamma[0] - ctx->opts.gamma[2]) < 1e-6f) {
+            metadata_add(meta, "gamma", ctx->opts.gamma[0]);
         } else {
             char gamma_str[48];
-            snprintf(gamma_str, sizeof(gamma_str), "%.4g;%.4g;%.4g", ctx.opts.gamma[0],
-                     ctx.opts.gamma[1], ctx.opts.gamma[2]);
+            snprintf(gamma_str, sizeof(gamma_str), "%.4g;%.4g;%.4g", ctx->opts.gamma[0],
+                     ctx->opts.gamma[1], ctx->opts.gamma[2]);
             metadata_add(meta, "gamma", (const char *)gamma_str);
         }
     }
-    if (ctx.opts.apply_clahe)
+    if (ctx->opts.apply_clahe)
         metadata_add_bool(meta, "clahe", true);
-    if (ctx.opts.apply_rayleigh)
+    if (ctx->opts.apply_rayleigh)
         metadata_add_bool(meta, "rayleigh", true);
-    if (ctx.opts.apply_histogram)
+    if (ctx->opts.apply_histogram)
         metadata_add_bool(meta, "histogram", true);
-    if (ctx.opts.use_piecewise_stretch)
+    if (ctx->opts.use_piecewise_stretch)
         metadata_add_bool(meta, "stretch", true);
-    if (ctx.opts.do_reprojection && !ctx.opts.save_both)
+    if (ctx->opts.do_reprojection && !ctx->opts.save_both)
         metadata_add_bool(meta, "geographics", true);
-    if (ctx.opts.has_clip)
+    if (ctx->opts.has_clip)
         metadata_set_clip(meta, true);
 
-    if (ctx.opts.apply_clahe) {
-        metadata_add(meta, "clahe_limit", ctx.opts.clahe_clip_limit);
+    if (ctx->opts.apply_clahe) {
+        metadata_add(meta, "clahe_limit", ctx->opts.clahe_clip_limit);
     }
 
-    const RgbStrategy *strategy = get_strategy_for_mode(ctx.opts.mode);
+    const RgbStrategy *strategy = get_strategy_for_mode(ctx->opts.mode);
     if (!strategy) {
-        LOG_ERROR("Mode '%s' not recognized.", ctx.opts.mode);
+        LOG_ERROR("Mode '%s' not recognized.", ctx->opts.mode);
 
         char available[512] = {0};
         for (int i = 0; STRATEGIES[i].mode_name != NULL; i++) {
@@ -1224,53 +1417,62 @@ int run_rgb(const ProcessConfig *cfg, MetadataContext *meta) {
             strcat(available, STRATEGIES[i].mode_name);
         }
         LOG_INFO("Available modes: %s", available);
-        goto cleanup;
+        return NULL;
     }
     LOG_INFO("Selected mode: %s - %s", strategy->mode_name, strategy->description);
 
-    const char *product = cfg->product_long ? cfg->product_long : strategy->description;
-    metadata_set_product(meta, product);
+    *product = cfg->product_long ? cfg->product_long : strategy->description;
+    metadata_set_product(meta, *product);
+
+
+    return strategy;
+}
 
+// Canales que necesita el modo: los de la estrategia, o los de --expr en custom
+// (en *custom_channels, que libera el llamador con free_channel_list). NULL si
+// la expresión no sirve.
+static const char **rgb_required_channels(const RgbContext *ctx, const RgbStrategy *strategy,
+                                          char ***custom_channels) {
     // Rayleigh correction is not meaningful for night mode (thermal IR only).
-    if (strcmp(ctx.opts.mode, "night") == 0) {
-        if (ctx.opts.apply_rayleigh || ctx.opts.rayleigh_analytic) {
+    if (strcmp(ctx->opts.mode, "night") == 0) {
+        if (ctx->opts.apply_rayleigh || ctx->opts.rayleigh_analytic) {
             LOG_WARN(
                 "Rayleigh correction is ignored in 'night' mode (only affects visible channels).");
         }
-        if (ctx.opts.use_piecewise_stretch) {
+        if (ctx->opts.use_piecewise_stretch) {
             LOG_WARN("Contrast stretch is ignored in 'night' mode.");
         }
     }
 
-    const char **req_channels = NULL;
-    if (strcmp(ctx.opts.mode, "custom") == 0) {
-        if (!ctx.opts.expr) {
-            LOG_ERROR("'custom' mode requires specifying --expr");
-            goto cleanup;
-        }
-        int count = get_unique_channels_rgb(ctx.opts.expr, &custom_channels);
-        if (count == 0 || !custom_channels) {
-            LOG_ERROR("No valid bands detected in: %s", ctx.opts.expr);
-            goto cleanup;
-        }
-        LOG_INFO("Custom mode: %d bands required", count);
-        req_channels = (const char **)custom_channels;
-    } else {
-        req_channels = (const char **)strategy->req_channels;
+    if (strcmp(ctx->opts.mode, "custom") != 0)
+        return (const char **)strategy->req_channels;
+    if (!ctx->opts.expr) {
+        LOG_ERROR("'custom' mode requires specifying --expr");
+        return NULL;
     }
-
-    if (!load_channels(&ctx, req_channels)) {
-        LOG_ERROR("%s", ctx.error_msg);
-        goto cleanup;
+    int count = get_unique_channels_rgb(ctx->opts.expr, custom_channels);
+    if (count == 0 || !*custom_channels) {
+        LOG_ERROR("No valid bands detected in: %s", ctx->opts.expr);
+        return NULL;
     }
+    LOG_INFO("Custom mode: %d bands required", count);
+    return (const char **)*custom_channels;
+}
 
-    // Extract satellite/band/timestamp/geometry metadata from reference channel.
-    metadata_from_nc(meta, &ctx.channels[ctx.ref_channel_idx]);
+static void free_channel_list(char **list) {
+    if (!list)
+        return;
+    for (int i = 0; list[i] != NULL; i++)
+        free(list[i]);
+    free(list);
+}
 
-    if (!process_geospatial(&ctx, strategy)) {
-        LOG_ERROR("%s", ctx.error_msg);
-        goto cleanup;
-    }
+// Todo lo que sigue a la carga y la navegación: composición, realces,
+// reproyección o recorte, escalado y escritura de un producto.
+static bool rgb_render(RgbContext *ctx, const ProcessConfig *cfg, MetadataContext *meta,
+                       const RgbStrategy *strategy, const char *product) {
+    ReprojPlan stream_plan = {0}; // set when the reprojected GeoTIFF is streamed
+    bool streamed = false;
 
     // RGB composite. The true-color path can run device-resident under --cuda;
     // every other mode/option (analytic Rayleigh, non-truecolor modes, custom)
@@ -1281,19 +1483,19 @@ int run_rgb(const ProcessConfig *cfg, MetadataContext *meta) {
         // Accelerated: true-color, optionally with Rayleigh LUT, ratio
         // sharpening and piecewise stretch. Still CPU-only: analytic Rayleigh
         // and the other modes.
-        bool truecolor_cuda = truecolor_cuda_eligible(&ctx.opts);
+        bool truecolor_cuda = truecolor_cuda_eligible(&ctx->opts);
         // daynite: mismo gate salvo el modo, más las luces de ciudad, que siguen
         // en CPU (habría que subir el fondo WebP y no están en la ruta operativa).
-        bool daynite_cuda = strcmp(ctx.opts.mode, "daynite") == 0 &&
-                            !ctx.opts.rayleigh_analytic && !ctx.opts.use_sharpen &&
-                            !ctx.opts.use_citylights && ctx.channels[13].fdata.data_in;
+        bool daynite_cuda = strcmp(ctx->opts.mode, "daynite") == 0 &&
+                            !ctx->opts.rayleigh_analytic && !ctx->opts.use_sharpen &&
+                            !ctx->opts.use_citylights && ctx->channels[13].fdata.data_in;
         if (daynite_cuda) {
             LOG_INFO("Generating 'daynite' composite (CUDA, device-resident)...");
-            cuda_handled = compose_daynite_cuda(&ctx);
+            cuda_handled = compose_daynite_cuda(ctx);
         }
         if (!cuda_handled && truecolor_cuda) {
             LOG_INFO("Generating 'truecolor' composite (CUDA, device-resident)...");
-            cuda_handled = compose_truecolor_cuda(&ctx, NULL, NULL);
+            cuda_handled = compose_truecolor_cuda(ctx, NULL, NULL);
         }
         if (!cuda_handled)
             LOG_WARN("--cuda: this RGB configuration isn't GPU-accelerated yet; using CPU path.");
@@ -1302,196 +1504,222 @@ int run_rgb(const ProcessConfig *cfg, MetadataContext *meta) {
 
     if (!cuda_handled) {
         LOG_INFO("Generating '%s' composite...", strategy->mode_name);
-        if (!strategy->composer_func(&ctx)) {
+        bool composed = strategy->recipe ? compose_recipe(ctx, strategy->recipe)
+                                         : strategy->composer_func(ctx);
+        if (!composed) {
             LOG_ERROR("Failed to generate RGB composite.");
-            goto cleanup;
+            return false;
         }
 
         // Preprocess the DataF channels (apply per-channel gamma).
-        if (ctx.comp_r.data_in && ctx.comp_g.data_in && ctx.comp_b.data_in) {
-            bool any_gamma = fabsf(ctx.opts.gamma[0] - 1.0f) > 1e-6f ||
-                             fabsf(ctx.opts.gamma[1] - 1.0f) > 1e-6f ||
-                             fabsf(ctx.opts.gamma[2] - 1.0f) > 1e-6f;
+        if (ctx->comp_r.data_in && ctx->comp_g.data_in && ctx->comp_b.data_in) {
+            bool any_gamma = fabsf(ctx->opts.gamma[0] - 1.0f) > 1e-6f ||
+                             fabsf(ctx->opts.gamma[1] - 1.0f) > 1e-6f ||
+                             fabsf(ctx->opts.gamma[2] - 1.0f) > 1e-6f;
             if (any_gamma) {
-                LOG_INFO("Applying gamma R=%.2f G=%.2f B=%.2f", ctx.opts.gamma[0], ctx.opts.gamma[1],
-                         ctx.opts.gamma[2]);
+                LOG_INFO("Applying gamma R=%.2f G=%.2f B=%.2f", ctx->opts.gamma[0], ctx->opts.gamma[1],
+                         ctx->opts.gamma[2]);
                 // Only update the range to [0,1] for channels where gamma != 1.0; otherwise
                 // dataf_apply_gamma leaves the data unchanged, so the --minmax range
-                // (already in ctx.min_*/max_*) must be kept for rendering.
-                if (fabsf(ctx.opts.gamma[0] - 1.0f) > 1e-6f) {
-                    dataf_apply_gamma(&ctx.comp_r, ctx.opts.gamma[0], ctx.min_r, ctx.max_r);
-                    ctx.min_r = 0.0f;
-                    ctx.max_r = 1.0f;
+                // (already in ctx->min_*/max_*) must be kept for rendering.
+                if (fabsf(ctx->opts.gamma[0] - 1.0f) > 1e-6f) {
+                    dataf_apply_gamma(&ctx->comp_r, ctx->opts.gamma[0], ctx->min_r, ctx->max_r);
+                    ctx->min_r = 0.0f;
+                    ctx->max_r = 1.0f;
                 }
-                if (fabsf(ctx.opts.gamma[1] - 1.0f) > 1e-6f) {
-                    dataf_apply_gamma(&ctx.comp_g, ctx.opts.gamma[1], ctx.min_g, ctx.max_g);
-                    ctx.min_g = 0.0f;
-                    ctx.max_g = 1.0f;
+                if (fabsf(ctx->opts.gamma[1] - 1.0f) > 1e-6f) {
+                    dataf_apply_gamma(&ctx->comp_g, ctx->opts.gamma[1], ctx->min_g, ctx->max_g);
+                    ctx->min_g = 0.0f;
+                    ctx->max_g = 1.0f;
                 }
-                if (fabsf(ctx.opts.gamma[2] - 1.0f) > 1e-6f) {
-                    dataf_apply_gamma(&ctx.comp_b, ctx.opts.gamma[2], ctx.min_b, ctx.max_b);
-                    ctx.min_b = 0.0f;
-                    ctx.max_b = 1.0f;
+                if (fabsf(ctx->opts.gamma[2] - 1.0f) > 1e-6f) {
+                    dataf_apply_gamma(&ctx->comp_b, ctx->opts.gamma[2], ctx->min_b, ctx->max_b);
+                    ctx->min_b = 0.0f;
+                    ctx->max_b = 1.0f;
                 }
-                ctx.opts.gamma[0] = ctx.opts.gamma[1] = ctx.opts.gamma[2] = 1.0f;
+                ctx->opts.gamma[0] = ctx->opts.gamma[1] = ctx->opts.gamma[2] = 1.0f;
             }
 
             // Render to image.
-            ctx.final_image =
-                create_multiband_rgb(&ctx.comp_r, &ctx.comp_g, &ctx.comp_b, ctx.min_r, ctx.max_r,
-                                     ctx.min_g, ctx.max_g, ctx.min_b, ctx.max_b);
+            ctx->final_image =
+                create_multiband_rgb(&ctx->comp_r, &ctx->comp_g, &ctx->comp_b, ctx->min_r, ctx->max_r,
+                                     ctx->min_g, ctx->max_g, ctx->min_b, ctx->max_b);
         }
     }
 
-    if (ctx.final_image.data == NULL) {
+    if (ctx->final_image.data == NULL) {
         LOG_ERROR("Failed to generate RGB image.");
-        goto cleanup;
+        return false;
     }
 
     // Post-processing (blending, CLAHE, alpha) — before reprojection.
-    if (!apply_enhancements(&ctx)) {
+    if (!apply_enhancements(ctx)) {
         LOG_ERROR("Failure in post-processing (enhancements).");
-        goto cleanup;
+        return false;
     }
 
     // -B: scale and save the fixed-grid output before reprojecting.
-    if (ctx.opts.save_both) {
-        if (!apply_scaling(&ctx)) {
+    if (ctx->opts.save_both) {
+        if (!apply_scaling(ctx)) {
             LOG_ERROR("Failure in scaling (fixed-grid).");
-            goto cleanup;
+            return false;
         }
-        if (ctx.opts.output_filename == NULL) {
-            const char *ext_fg = ctx.opts.force_geotiff ? ".tif" : ".png";
-            ctx.opts.output_filename = metadata_build_filename(meta, ext_fg);
-            ctx.opts.output_generated = true;
-            if (ctx.opts.output_filename == NULL) {
+        if (ctx->opts.output_filename == NULL) {
+            const char *ext_fg = ctx->opts.force_geotiff ? ".tif" : ".png";
+            ctx->opts.output_filename = metadata_build_filename(meta, ext_fg);
+            ctx->opts.output_generated = true;
+            if (ctx->opts.output_filename == NULL) {
                 LOG_ERROR("Failed to generate fixed-grid filename.");
-                goto cleanup;
+                return false;
             }
         }
-        LOG_INFO("Saving fixed-grid: %s", ctx.opts.output_filename);
+        LOG_INFO("Saving fixed-grid: %s", ctx->opts.output_filename);
         // Temporarily disable reprojection flag so write_output uses the native projection.
-        ctx.opts.do_reprojection = false;
-        if (!write_output(&ctx, product)) {
+        ctx->opts.do_reprojection = false;
+        if (!write_output(ctx, product)) {
             LOG_ERROR("Failed to save fixed-grid.");
-            goto cleanup;
+            return false;
         }
-        ctx.opts.do_reprojection = true;
+        ctx->opts.do_reprojection = true;
         // Append _geo suffix to the filename for the reprojected output.
-        char *geo_filename = insert_geo_suffix(ctx.opts.output_filename);
-        if (ctx.opts.output_generated) {
-            free(ctx.opts.output_filename);
+        char *geo_filename = insert_geo_suffix(ctx->opts.output_filename);
+        if (ctx->opts.output_generated) {
+            free(ctx->opts.output_filename);
         }
-        ctx.opts.output_filename = geo_filename;
-        ctx.opts.output_generated = true;
-        if (ctx.opts.output_filename == NULL) {
+        ctx->opts.output_filename = geo_filename;
+        ctx->opts.output_generated = true;
+        if (ctx->opts.output_filename == NULL) {
             LOG_ERROR("Failed to generate reprojected filename.");
-            goto cleanup;
+            return false;
         }
-        LOG_INFO("Saving reprojected: %s", ctx.opts.output_filename);
+        LOG_INFO("Saving reprojected: %s", ctx->opts.output_filename);
     }
 
     // Reprojection.
-    if (ctx.opts.do_reprojection) {
-        if (!ctx.has_navigation) {
+    if (ctx->opts.do_reprojection) {
+        if (!ctx->has_navigation) {
             LOG_ERROR("Navigation required for reprojection.");
-            goto cleanup;
+            return false;
         }
 
         // Areas outside the visible disk must read as NonData (alpha=0), not real data —
         // the same convention already used for interior NonData pixels in apply_enhancements().
         unsigned char nodata_pattern[4] = {0};
-        const unsigned char *nodata_pixel = ctx.opts.use_alpha ? nodata_pattern : NULL;
-#ifdef HPSV_CUDA
-        // La copia en device solo sirve si nadie tocó la imagen en host desde la
-        // composición; si la tocaron, el espejo quedó obsoleto y hay que subirla.
-        // HPSV_NO_DEVICE_HANDOFF=1 fuerza el H2D aunque el espejo sea válido: es
-        // el A/B que prueba que ambos caminos dan los mismos píxeles.
-        const unsigned char *d_src =
-            (ctx.final_image_touched || getenv("HPSV_NO_DEVICE_HANDOFF"))
-                ? NULL
-                : (const unsigned char *)ctx.d_final_image;
-        if (d_src) {
-            LOG_INFO("Reprojection reuses the device-resident composite (no H2D).");
+        const unsigned char *nodata_pixel = ctx->opts.use_alpha ? nodata_pattern : NULL;
+
+        // Update final bounding box from reprojected extent.
+        if (ctx->opts.has_clip) {
+            ctx->final_lon_min = ctx->opts.clip_coords[0];
+            ctx->final_lat_max = ctx->opts.clip_coords[1];
+            ctx->final_lon_max = ctx->opts.clip_coords[2];
+            ctx->final_lat_min = ctx->opts.clip_coords[3];
+        } else {
+            ctx->final_lon_min = ctx->nav_lon.fmin;
+            ctx->final_lon_max = ctx->nav_lon.fmax;
+            ctx->final_lat_min = ctx->nav_lat.fmin;
+            ctx->final_lat_max = ctx->nav_lat.fmax;
         }
-        ImageData reprojected = cfg->use_cuda
-            ? reproject_image_analytical_cuda(
-                  &ctx.final_image, &ctx.channels[ctx.ref_channel_idx], ctx.nav_lat.fmin,
-                  ctx.nav_lat.fmax, ctx.nav_lon.fmin, ctx.nav_lon.fmax,
-                  ctx.channels[ctx.ref_channel_idx].native_resolution_km,
-                  ctx.opts.has_clip ? ctx.opts.clip_coords : NULL, nodata_pixel, d_src)
-            : reproject_image_analytical(
-                  &ctx.final_image, &ctx.channels[ctx.ref_channel_idx], ctx.nav_lat.fmin,
-                  ctx.nav_lat.fmax, ctx.nav_lon.fmin, ctx.nav_lon.fmax,
-                  ctx.channels[ctx.ref_channel_idx].native_resolution_km,
-                  ctx.opts.has_clip ? ctx.opts.clip_coords : NULL, nodata_pixel);
-#else
-        ImageData reprojected = reproject_image_analytical(
-            &ctx.final_image, &ctx.channels[ctx.ref_channel_idx], ctx.nav_lat.fmin,
-            ctx.nav_lat.fmax, ctx.nav_lon.fmin, ctx.nav_lon.fmax,
-            ctx.channels[ctx.ref_channel_idx].native_resolution_km,
-            ctx.opts.has_clip ? ctx.opts.clip_coords : NULL, nodata_pixel);
-#endif
 
-        if (reprojected.data == NULL) {
-            LOG_ERROR("Failure during reprojection.");
-            goto cleanup;
+        // GeoTIFF at the native resolution, whatever its size: reprojected and
+        // written strip by strip (see write_output_streamed). Beyond
+        // REPROJ_MAX_DIM the in-memory path can only downscale.
+        if (output_is_geotiff(ctx) && ctx->opts.scale == 1 && !cfg->use_cuda) {
+            stream_plan = reproject_build_plan_full(
+                &ctx->final_image, &ctx->channels[ctx->ref_channel_idx], ctx->nav_lat.fmin,
+                ctx->nav_lat.fmax, ctx->nav_lon.fmin, ctx->nav_lon.fmax,
+                ctx->channels[ctx->ref_channel_idx].native_resolution_km,
+                ctx->opts.has_clip ? ctx->opts.clip_coords : NULL);
         }
+        if (reproject_stream_wanted(&stream_plan)) {
+            if (ctx->opts.output_filename == NULL) {
+                ctx->opts.output_filename = metadata_build_filename(meta, ".tif");
+                ctx->opts.output_generated = true;
+                if (ctx->opts.output_filename == NULL) {
+                    LOG_ERROR("Failed to generate output filename.");
+                    return false;
+                }
+            }
+            if (!write_output_streamed(ctx, &stream_plan, nodata_pixel, product)) {
+                LOG_ERROR("Failure during streamed reprojection.");
+                return false;
+            }
+            streamed = true;
+        } else {
+#ifdef HPSV_CUDA
+            // La copia en device solo sirve si nadie tocó la imagen en host desde la
+            // composición; si la tocaron, el espejo quedó obsoleto y hay que subirla.
+            // HPSV_NO_DEVICE_HANDOFF=1 fuerza el H2D aunque el espejo sea válido: es
+            // el A/B que prueba que ambos caminos dan los mismos píxeles.
+            const unsigned char *d_src =
+                (ctx->final_image_touched || getenv("HPSV_NO_DEVICE_HANDOFF"))
+                    ? NULL
+                    : (const unsigned char *)ctx->d_final_image;
+            if (d_src) {
+                LOG_INFO("Reprojection reuses the device-resident composite (no H2D).");
+            }
+            ImageData reprojected = cfg->use_cuda
+                ? reproject_image_analytical_cuda(
+                      &ctx->final_image, &ctx->channels[ctx->ref_channel_idx], ctx->nav_lat.fmin,
+                      ctx->nav_lat.fmax, ctx->nav_lon.fmin, ctx->nav_lon.fmax,
+                      ctx->channels[ctx->ref_channel_idx].native_resolution_km,
+                      ctx->opts.has_clip ? ctx->opts.clip_coords : NULL, nodata_pixel, d_src)
+                : reproject_image_analytical(
+                      &ctx->final_image, &ctx->channels[ctx->ref_channel_idx], ctx->nav_lat.fmin,
+                      ctx->nav_lat.fmax, ctx->nav_lon.fmin, ctx->nav_lon.fmax,
+                      ctx->channels[ctx->ref_channel_idx].native_resolution_km,
+                      ctx->opts.has_clip ? ctx->opts.clip_coords : NULL, nodata_pixel);
+#else
+            ImageData reprojected = reproject_image_analytical(
+                &ctx->final_image, &ctx->channels[ctx->ref_channel_idx], ctx->nav_lat.fmin,
+                ctx->nav_lat.fmax, ctx->nav_lon.fmin, ctx->nav_lon.fmax,
+                ctx->channels[ctx->ref_channel_idx].native_resolution_km,
+                ctx->opts.has_clip ? ctx->opts.clip_coords : NULL, nodata_pixel);
+#endif
 
-        image_destroy(&ctx.final_image);
-        ctx.final_image = reprojected;
+            if (reprojected.data == NULL) {
+                LOG_ERROR("Failure during reprojection.");
+                return false;
+            }
 
-        // Update final bounding box from reprojected extent.
-        if (ctx.opts.has_clip) {
-            ctx.final_lon_min = ctx.opts.clip_coords[0];
-            ctx.final_lat_max = ctx.opts.clip_coords[1];
-            ctx.final_lon_max = ctx.opts.clip_coords[2];
-            ctx.final_lat_min = ctx.opts.clip_coords[3];
-        } else {
-            ctx.final_lon_min = ctx.nav_lon.fmin;
-            ctx.final_lon_max = ctx.nav_lon.fmax;
-            ctx.final_lat_min = ctx.nav_lat.fmin;
-            ctx.final_lat_max = ctx.nav_lat.fmax;
+            image_destroy(&ctx->final_image);
+            ctx->final_image = reprojected;
         }
     } else {
         // No reprojection: apply clip in native fixed-grid coordinates if requested.
-        if (ctx.opts.has_clip && ctx.has_navigation) {
-            int ix, iy, iw, ih;
-            reprojection_find_bounding_box(&ctx.nav_lat, &ctx.nav_lon, ctx.opts.clip_coords[0],
-                                           ctx.opts.clip_coords[1], ctx.opts.clip_coords[2],
-                                           ctx.opts.clip_coords[3], &ix, &iy, &iw, &ih);
-
-            ImageData cropped = image_crop(&ctx.final_image, ix, iy, iw, ih);
-            image_destroy(&ctx.final_image);
-            ctx.final_image = cropped;
-
-            ctx.crop_x_offset = (unsigned)ix;
-            ctx.crop_y_offset = (unsigned)iy;
-        } else if (ctx.has_navigation) {
-            ctx.final_lon_min = ctx.nav_lon.fmin;
-            ctx.final_lon_max = ctx.nav_lon.fmax;
-            ctx.final_lat_min = ctx.nav_lat.fmin;
-            ctx.final_lat_max = ctx.nav_lat.fmax;
+        PixelWindow box = {0};
+        if (ctx->opts.has_clip && (clip_crop_box(ctx, &box) || ctx->has_navigation)) {
+            ImageData cropped =
+                image_crop(&ctx->final_image, box.x0, box.y0, box.width, box.height);
+            image_destroy(&ctx->final_image);
+            ctx->final_image = cropped;
+
+            ctx->crop_x_offset = box.x0;
+            ctx->crop_y_offset = box.y0;
+        } else if (ctx->has_navigation) {
+            ctx->final_lon_min = ctx->nav_lon.fmin;
+            ctx->final_lon_max = ctx->nav_lon.fmax;
+            ctx->final_lat_min = ctx->nav_lat.fmin;
+            ctx->final_lat_max = ctx->nav_lat.fmax;
         }
     }
 
     // Write geometry metadata for JSON sidecar.
-    if (ctx.has_navigation || ctx.opts.has_clip) {
-        if (ctx.opts.do_reprojection) {
-            metadata_set_geometry(meta, ctx.final_lon_min, ctx.final_lat_min, ctx.final_lon_max,
-                                  ctx.final_lat_max);
+    if (ctx->has_navigation || ctx->opts.has_clip) {
+        if (ctx->opts.do_reprojection) {
+            metadata_set_geometry(meta, ctx->final_lon_min, ctx->final_lat_min, ctx->final_lon_max,
+                                  ctx->final_lat_max);
             metadata_set_projection(meta, "EPSG:4326");
         } else {
             // Compute bounds in metres for geostationary projection metadata.
-            DataNC *ref = &ctx.channels[ctx.ref_channel_idx];
+            DataNC *ref = &ctx->channels[ctx->ref_channel_idx];
             double *gt = ref->geotransform;
             double h = (ref->proj_info.valid) ? ref->proj_info.sat_height : 35786023.0;
 
             if (gt[1] != 0.0) {
-                double x_min = (gt[0] + ctx.crop_x_offset * gt[1]) * h;
-                double y_top = (gt[3] + ctx.crop_y_offset * gt[5]) * h;
-                double x_max = x_min + (ctx.final_image.width * gt[1] * h);
-                double y_bot = y_top + (ctx.final_image.height * gt[5] * h);
+                double x_min = (gt[0] + ctx->crop_x_offset * gt[1]) * h;
+                double y_top = (gt[3] + ctx->crop_y_offset * gt[5]) * h;
+                double x_max = x_min + (ctx->final_image.width * gt[1] * h);
+                double y_bot = y_top + (ctx->final_image.height * gt[5] * h);
 
                 double y_min = (y_bot < y_top) ? y_bot : y_top;
                 double y_max = (y_bot > y_top) ? y_bot : y_top;
@@ -1499,7 +1727,7 @@ int run_rgb(const ProcessConfig *cfg, MetadataContext *meta) {
             }
 
             const char *sat_crs = "geostationary";
-            int sid = ctx.channels[ctx.ref_channel_idx].sat_id;
+            int sid = ctx->channels[ctx->ref_channel_idx].sat_id;
             if (sid == SAT_GOES16)
                 sat_crs = "goes16";
             else if (sid == SAT_GOES17)
@@ -1513,41 +1741,265 @@ int run_rgb(const ProcessConfig *cfg, MetadataContext *meta) {
     }
 
     // Final scaling — after reprojection (for save_both, already applied before reprojection).
-    if (!ctx.opts.save_both && !apply_scaling(&ctx)) {
+    if (!ctx->opts.save_both && !apply_scaling(ctx)) {
         LOG_ERROR("Failure in final scaling.");
-        goto cleanup;
+        return false;
     }
 
     // Generate output filename if not specified.
-    if (ctx.opts.output_filename == NULL) {
-        const char *ext = ctx.opts.force_geotiff ? ".tif" : ".png";
-        ctx.opts.output_filename = metadata_build_filename(meta, ext);
-        ctx.opts.output_generated = true;
+    if (ctx->opts.output_filename == NULL) {
+        const char *ext = ctx->opts.force_geotiff ? ".tif" : ".png";
+        ctx->opts.output_filename = metadata_build_filename(meta, ext);
+        ctx->opts.output_generated = true;
 
-        if (ctx.opts.output_filename == NULL) {
+        if (ctx->opts.output_filename == NULL) {
             LOG_ERROR("Failed to generate output filename.");
-            goto cleanup;
+            return false;
         }
     }
 
-    if (!write_output(&ctx, product)) {
+    if (!streamed && !write_output(ctx, product)) {
         LOG_ERROR("Failed to save image.");
+        return false;
+    }
+
+    metadata_add(meta, "output_file", ctx->opts.output_filename);
+    metadata_add(meta, "output_width", (int)(streamed ? stream_plan.width : ctx->final_image.width));
+    metadata_add(meta, "output_height", (int)(streamed ? stream_plan.height : ctx->final_image.height));
+
+    return true;
+}
+
+int run_rgb(const ProcessConfig *cfg, MetadataContext *meta) {
+    if (!cfg || !meta) {
+        LOG_ERROR("run_rgb: NULL parameters");
+        return 1;
+    }
+
+    LOG_INFO("Processing RGB: %s", cfg->input_file);
+
+    RgbContext ctx;
+    config_to_rgb_context(cfg, &ctx);
+    int status = 1;
+    char **custom_channels = NULL;
+    const char *product = NULL;
+
+    const RgbStrategy *strategy = rgb_begin(&ctx, cfg, meta, &product);
+    if (!strategy)
+        goto cleanup;
+
+    const char **req_channels = rgb_required_channels(&ctx, strategy, &custom_channels);
+    if (!req_channels)
+        goto cleanup;
+
+    if (!load_channels(&ctx, req_channels)) {
+        LOG_ERROR("%s", ctx.error_msg);
         goto cleanup;
     }
 
-    metadata_add(meta, "output_file", ctx.opts.output_filename);
-    metadata_add(meta, "output_width", (int)ctx.final_image.width);
-    metadata_add(meta, "output_height", (int)ctx.final_image.height);
+    // Extract satellite/band/timestamp/geometry metadata from reference channel.
+    metadata_from_nc(meta, &ctx.channels[ctx.ref_channel_idx]);
+
+    if (!process_geospatial(&ctx, strategy)) {
+        LOG_ERROR("%s", ctx.error_msg);
+        goto cleanup;
+    }
 
-    status = 0;
+    if (rgb_render(&ctx, cfg, meta, strategy, product))
+        status = 0;
 
 cleanup:
     rgb_context_destroy(&ctx);
-    if (custom_channels) {
-        for (int i = 0; custom_channels[i] != NULL; i++) {
-            free(custom_channels[i]);
+    free_channel_list(custom_channels);
+    return status;
+}
+
+static const char *const CHANNEL_NAMES[17] = {
+    NULL,  "C01", "C02", "C03", "C04", "C05", "C06", "C07", "C08",
+    "C09", "C10", "C11", "C12", "C13", "C14", "C15", "C16"};
+
+// La escena de un grupo de productos del batch: carga y navega una vez sus
+// canales y se los presta a cada uno para componer y escribir.
+static void batch_render_group(const ProcessConfig *items, int count, MetadataContext **metas,
+                               int *status, RgbContext *prod, const RgbStrategy **strategy,
+                               const char **product, const int *group, int g,
+                               bool (*need)[17]) {
+    const char *req_channels[17];
+    int nreq = 0, first = -1;
+    for (int cn = 1; cn <= 16; cn++) {
+        bool any = false;
+        for (int i = 0; i < count; i++)
+            any = any || (group[i] == g && need[i][cn]);
+        if (any)
+            req_channels[nreq++] = CHANNEL_NAMES[cn];
+    }
+    req_channels[nreq] = NULL;
+
+    // La lectura por ventana solo si cada producto del grupo la haría solo y
+    // todos piden el mismo recorte; si no, el disco completo y cada uno recorta
+    // después.
+    bool window = true, any_clip = false;
+    for (int i = 0; i < count; i++) {
+        if (group[i] != g)
+            continue;
+        if (first < 0)
+            first = i;
+        any_clip = any_clip || prod[i].opts.has_clip;
+        window = window && clip_window_allowed(&prod[i].opts) &&
+                 memcmp(prod[i].opts.clip_coords, prod[first].opts.clip_coords,
+                        sizeof(prod[i].opts.clip_coords)) == 0;
+    }
+
+    RgbContext scene;
+    config_to_rgb_context(&items[first], &scene);
+    scene.opts.mode = "batch";
+    scene.opts.use_cuda = false;
+    scene.opts.has_clip = window;
+    if (!window && any_clip)
+        LOG_INFO("Batch: full-disk read, the products of this grid do not share one "
+                 "windowable clip.");
+    const RgbStrategy scene_strategy = {"batch", {NULL}, NULL, "Batch", false, NULL};
+    bool loaded = nreq > 0 && load_channels(&scene, req_channels);
+    if (!loaded && nreq > 0)
+        LOG_ERROR("%s", scene.error_msg);
+    if (loaded && !process_geospatial(&scene, &scene_strategy)) {
+        LOG_ERROR("%s", scene.error_msg);
+        loaded = false;
+    }
+
+    // Cada composer sobre los canales de la escena, que solo lee.
+    for (int i = 0; i < count && loaded; i++) {
+        if (group[i] != g)
+            continue;
+        RgbContext *ctx = &prod[i];
+        LOG_INFO("Batch product %d/%d: %s", i + 1, count, strategy[i]->mode_name);
+        ctx->shared_scene = true;
+        ctx->channel_set = scene.channel_set;
+        memcpy(ctx->id_signature, scene.id_signature, sizeof(ctx->id_signature));
+        memcpy(ctx->channels, scene.channels, sizeof(ctx->channels));
+        ctx->ref_channel_idx = scene.ref_channel_idx;
+        ctx->nav_lat = scene.nav_lat;
+        ctx->nav_lon = scene.nav_lon;
+        ctx->has_navigation = scene.has_navigation;
+        ctx->load_window = scene.load_window;
+
+        ProcessConfig item = items[i];
+        item.use_cuda = false;
+        metadata_from_nc(metas[i], &ctx->channels[ctx->ref_channel_idx]);
+        if (strategy[i]->needs_navigation && !ctx->has_navigation) {
+            LOG_ERROR("El modo '%s' requiere datos de navegación, pero no se pudieron "
+                      "cargar.",
+                      strategy[i]->mode_name);
+        } else if (rgb_render(ctx, &item, metas[i], strategy[i], product[i])) {
+            status[i] = 0;
         }
-        free(custom_channels);
     }
-    return status;
+    rgb_context_destroy(&scene);
+}
+
+int run_rgb_batch(const ProcessConfig *items, int count, MetadataContext **metas, int *status) {
+    if (!items || count <= 0 || !metas || !status) {
+        LOG_ERROR("run_rgb_batch: NULL parameters");
+        return 1;
+    }
+    LOG_INFO("Processing RGB batch (%d products): %s", count, items[0].input_file);
+    if (items[0].use_cuda)
+        LOG_WARN("--cuda: batch runs on the CPU path.");
+
+    RgbContext *prod = calloc((size_t)count, sizeof(RgbContext));
+    const RgbStrategy **strategy = calloc((size_t)count, sizeof(*strategy));
+    const char **product = calloc((size_t)count, sizeof(*product));
+    bool(*need)[17] = calloc((size_t)count, sizeof(*need));
+    int *group = calloc((size_t)count, sizeof(int));
+    float *ref_km = calloc((size_t)count, sizeof(float));
+    if (!prod || !strategy || !product || !need || !group || !ref_km) {
+        LOG_ERROR("Memory error allocating the batch");
+        free(prod);
+        free((void *)strategy);
+        free((void *)product);
+        free(need);
+        free(group);
+        free(ref_km);
+        return count;
+    }
+
+    // 1. Cada producto con sus opciones, metadatos y canales.
+    //    La GPU no participa: sus rutas recalculan la navegación por su cuenta.
+    bool any_need[17] = {false};
+    for (int i = 0; i < count; i++) {
+        ProcessConfig item = items[i];
+        item.use_cuda = false;
+        config_to_rgb_context(&item, &prod[i]);
+        status[i] = 1;
+        strategy[i] = rgb_begin(&prod[i], &item, metas[i], &product[i]);
+        char **custom_channels = NULL;
+        const char **req =
+            strategy[i] ? rgb_required_channels(&prod[i], strategy[i], &custom_channels) : NULL;
+        for (int k = 0; req && req[k]; k++) {
+            int cn = atoi(req[k] + 1);
+            if (cn > 0 && cn <= 16)
+                need[i][cn] = any_need[cn] = true;
+        }
+        free_channel_list(custom_channels);
+        if (!req)
+            strategy[i] = NULL;
+    }
+
+    // 2. Cada producto sale en la malla de su propia referencia (su canal más
+    //    grueso, el más fino con --full-res), como en su corrida por separado:
+    //    un truecolor junto a modos IR sigue a 1 km. Se agrupan los productos
+    //    por esa resolución y cada grupo carga y navega una sola vez.
+    const char *all_channels[17];
+    int nall = 0;
+    for (int cn = 1; cn <= 16; cn++)
+        if (any_need[cn])
+            all_channels[nall++] = CHANNEL_NAMES[cn];
+    all_channels[nall] = NULL;
+    float res[17] = {0};
+    RgbContext probe;
+    config_to_rgb_context(&items[0], &probe);
+    if (nall > 0 && !(locate_channels(&probe, all_channels) && channel_resolutions(&probe, res)))
+        LOG_WARN("Batch: channel resolutions unknown, all products share one grid.");
+    rgb_context_destroy(&probe);
+
+    for (int i = 0; i < count; i++) {
+        for (int cn = 1; cn <= 16; cn++) {
+            if (!need[i][cn] || res[cn] <= 0.0f)
+                continue;
+            if (ref_km[i] == 0.0f || (items[i].use_full_res ? res[cn] < ref_km[i]
+                                                            : res[cn] > ref_km[i]))
+                ref_km[i] = res[cn];
+        }
+    }
+    int ngroups = 0;
+    for (int i = 0; i < count; i++) {
+        group[i] = -1;
+        if (!strategy[i])
+            continue;
+        for (int j = 0; j < i && group[i] < 0; j++)
+            if (strategy[j] && fabsf(ref_km[j] - ref_km[i]) < 0.01f)
+                group[i] = group[j];
+        if (group[i] < 0)
+            group[i] = ngroups++;
+    }
+    if (ngroups > 1)
+        LOG_INFO("Batch: %d grids, one load each.", ngroups);
+
+    // 3. Una carga y una navegación por grupo.
+    for (int g = 0; g < ngroups; g++)
+        batch_render_group(items, count, metas, status, prod, strategy, product, group, g, need);
+
+    int failed = 0;
+    for (int i = 0; i < count; i++) {
+        if (status[i] != 0)
+            failed++;
+        rgb_context_destroy(&prod[i]);
+    }
+    free(prod);
+    free((void *)strategy);
+    free((void *)product);
+    free(need);
+    free(group);
+    free(ref_km);
+    return failed;
 }
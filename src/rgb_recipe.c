@@ -0,0 +1,165 @@
+/* Band-algebra RGB recipes rendered straight to 8-bit in one fused pass.
+ * Copyright (c) 2025-2026 Alejandro Aguilar Sierra (asierra@unam.mx)
+ * Laboratorio Nacional de Observación de la Tierra, UNAM
+ *
+ * This file is part of HPSATVIEWS.
+ * Licensed under the GNU General Public License v3.0 (see LICENSE file).
+ *
+ * The ash, airmass, so2 and severestorm composers used to build three full
+ * float grids (differences of bands) and hand them to create_multiband_rgb();
+ * a full disk at 2 km is 3 x 118 MB written and read back for a few
+ * subtractions per pixel. Here each row is evaluated in strips that stay in
+ * cache and written as bytes directly. The arithmetic is that of
+ * evaluate_linear_combo(), dataf_apply_gamma() and create_multiband_rgb(), in
+ * the same order, so the bytes do not change.
+ */
+#include "rgb_recipe.h"
+#include "logger.h"
+
+#include <math.h>
+#include <omp.h>
+#include <stdint.h>
+#include <string.h>
+
+/* Pixels per strip: one channel of them in a float buffer per thread. */
+#define RECIPE_STRIP 512
+
+int rgb_recipe_compile(const RgbRecipe *recipe, LinearCombo combo[3]) {
+    for (int c = 0; c < 3; c++) {
+        if (parse_expr_string(recipe->ch[c].expr, &combo[c]) != 0) {
+            LOG_ERROR("Invalid recipe expression for component %d: %s", c, recipe->ch[c].expr);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// One channel over pixels [i0, i0+n): bias, then acc + x*coeff per term, with
+// NonData sticky, exactly as evaluate_linear_combo() accumulates its grids.
+static void eval_strip(const LinearCombo *combo, const DataNC *channels, size_t i0, size_t n,
+                       float *acc) {
+    const float nodata = NonData;
+    const float bias = (float)combo->bias;
+    for (size_t j = 0; j < n; j++) acc[j] = bias;
+    for (int t = 0; t < combo->num_terms; t++) {
+        const float *src = channels[combo->terms[t].band_id].fdata.data_in + i0;
+        const float coeff = (float)combo->terms[t].coeff;
+        for (size_t j = 0; j < n; j++) {
+            float x = src[j], a = acc[j];
+            float s = a + x * coeff;
+            acc[j] = (x == nodata || a == nodata) ? nodata : s;
+        }
+    }
+}
+
+typedef struct {
+    float vmin, range, inv_gamma;
+    bool gamma;
+} Stretch;
+
+// Stretch as create_multiband_rgb() does, with dataf_apply_gamma() in between
+// when gamma != 1; `out` is one channel of interleaved RGB. NonData becomes a
+// norm of 0, which gamma keeps at 0, so the three loops stay branch-free and
+// only the powf one is scalar.
+static void stretch_strip(float *acc, size_t n, const Stretch *s, uint8_t *out) {
+    for (size_t j = 0; j < n; j++) {
+        float v = acc[j];
+        float norm = (v - s->vmin) / s->range;
+        norm = norm < 0.0f ? 0.0f : norm;
+        norm = norm > 1.0f ? 1.0f : norm;
+        acc[j] = IS_NONDATA(v) ? 0.0f : norm;
+    }
+    if (s->gamma)
+        for (size_t j = 0; j < n; j++) acc[j] = powf(acc[j], s->inv_gamma);
+    for (size_t j = 0; j < n; j++) out[j * 3] = (uint8_t)(acc[j] * 255.0f);
+}
+
+ImageData rgb_recipe_render(const LinearCombo combo[3], const float range[3][2],
+                            const float gamma[3], const DataNC *channels) {
+    // Every band used must be loaded and on the same grid.
+    const DataF *bands[30];
+    int nbands = 0;
+    for (int c = 0; c < 3; c++) {
+        if (combo[c].num_terms == 0) {
+            LOG_ERROR("Recipe component %d has no bands", c);
+            return image_create(0, 0, 0);
+        }
+        for (int t = 0; t < combo[c].num_terms; t++) {
+            const DataF *b = &channels[combo[c].terms[t].band_id].fdata;
+            if (!b->data_in || (nbands > 0 && (b->width != bands[0]->width ||
+                                               b->height != bands[0]->height))) {
+                LOG_ERROR("Band C%02d is missing or not on the grid of the others",
+                          combo[c].terms[t].band_id);
+                return image_create(0, 0, 0);
+            }
+            bands[nbands++] = b;
+        }
+    }
+    const unsigned int w = bands[0]->width, h = bands[0]->height;
+    ImageData imout = image_create(w, h, 3);
+    if (imout.data == NULL) {
+        LOG_ERROR("Memory allocation failed for output image");
+        return imout;
+    }
+
+    Stretch st[3];
+    for (int c = 0; c < 3; c++) {
+        float r = range[c][1] - range[c][0];
+        st[c].vmin = range[c][0];
+        st[c].gamma = fabsf(gamma[c] - 1.0f) > 1e-6f;
+        st[c].inv_gamma = 1.0f / gamma[c];
+        if (st[c].gamma && (r <= 0.0f || gamma[c] <= 0.0f)) {
+            // dataf_apply_gamma() leaves such a channel as is and it is then
+            // stretched over [0, 1].
+            st[c].gamma = false;
+            st[c].vmin = 0.0f;
+            r = 1.0f;
+        } else if (!st[c].gamma && fabsf(r) < 1e-6f) {
+            r = 1.0f;
+        }
+        st[c].range = r;
+    }
+
+    // Outside the union of the bands' spans every term is NonData, so every
+    // channel is 0; a band without spans means whole rows.
+    bool spans = true;
+    for (int k = 0; k < nbands; k++) spans = spans && bands[k]->spans;
+
+    double start = omp_get_wtime();
+#pragma omp parallel
+    {
+        float acc[RECIPE_STRIP];
+#pragma omp for schedule(static)
+        for (unsigned int y = 0; y < h; y++) {
+            unsigned int x0 = 0, x1 = w;
+            if (spans) {
+                x0 = x1 = 0;
+                for (int k = 0; k < nbands; k++) {
+                    unsigned int s0 = bands[k]->spans->x[y][0], s1 = bands[k]->spans->x[y][1];
+                    if (s0 == s1) continue;
+                    if (x0 == x1) {
+                        x0 = s0;
+                        x1 = s1;
+                    } else {
+                        if (s0 < x0) x0 = s0;
+                        if (s1 > x1) x1 = s1;
+                    }
+                }
+            }
+            uint8_t *row = imout.data + (size_t)y * w * 3;
+            memset(row, 0, (size_t)x0 * 3);
+            memset(row + (size_t)x1 * 3, 0, (size_t)(w - x1) * 3);
+
+            for (unsigned int xs = x0; xs < x1; xs += RECIPE_STRIP) {
+                size_t n = x1 - xs < RECIPE_STRIP ? x1 - xs : RECIPE_STRIP;
+                size_t i0 = (size_t)y * w + xs;
+                for (int c = 0; c < 3; c++) {
+                    eval_strip(&combo[c], channels, i0, n, acc);
+                    stretch_strip(acc, n, &st[c], row + (size_t)xs * 3 + c);
+                }
+            }
+        }
+    }
+    LOG_TIMING(omp_get_wtime() - start, "Recipe RGB (fused)");
+    return imout;
+}
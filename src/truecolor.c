@@ -71,8 +71,14 @@ DataF create_truecolor_synthetic_green(const DataF *c_blue, const DataF *c_red,
 }
 
 
-void apply_solar_zenith_correction(DataF *data, const DataF *sza) {
-    if (!data || !sza || !data->data_in || !sza->data_in) return;
+void apply_solar_zenith_correction(DataF *data, const RayleighNav *nav) {
+    if (!data || !nav || !data->data_in) return;
+    if (!nav->coarse && !nav->sza.data_in) return;
+    if (rayleigh_nav_width(nav) != data->width || rayleigh_nav_height(nav) != data->height) {
+        LOG_ERROR("Solar zenith correction: navigation %ux%u vs data %ux%u",
+                  rayleigh_nav_width(nav), rayleigh_nav_height(nav), data->width, data->height);
+        return;
+    }
     
     const float MAX_SZA = 85.0f; // conservative cutoff to avoid terminator noise
     const float RAD_PER_DEG = M_PI / 180.0f;
@@ -83,27 +89,52 @@ void apply_solar_zenith_correction(DataF *data, const DataF *sza) {
     // Pairs with "Solar zenith correction (CUDA, device-resident)".
     double start = omp_get_wtime();
 
+    // Off the spans of either grid the pixel is NonData and goes to black
+    // without testing. That leaves 0, not NonData, outside: the spans go.
+    // A coarse lattice has no spans of its own; it covers the disk of the data.
+    const unsigned int w = data->width;
     #pragma omp parallel for reduction(min:local_min) reduction(max:local_max)
-    for (size_t i = 0; i < data->size; i++) {
-        float refl = data->data_in[i];
-        float sza_deg = sza->data_in[i];
-        
-        if (IS_NONDATA(refl) || IS_NONDATA(sza_deg) || sza_deg > MAX_SZA) {
-            data->data_in[i] = 0.0f; // clamp to black at night/terminator
-            continue;
-        }
-        
-        float cos_sza = cosf(sza_deg * RAD_PER_DEG);
-        // Avoid division by zero (MAX_SZA guard already prevents cos_sza ~ 0).
-        if (cos_sza > 0.087f) { // cos(85) approx 0.087
-            float corrected = refl / cos_sza;
-            data->data_in[i] = corrected;
-            if (corrected < local_min) local_min = corrected;
-            if (corrected > local_max) local_max = corrected;
+    for (unsigned int y = 0; y < data->height; y++) {
+        unsigned int x0, x1, s0, s1;
+        dataf_row_span(data, y, &x0, &x1);
+        if (nav->coarse) {
+            s0 = 0;
+            s1 = w;
         } else {
-            data->data_in[i] = 0.0f;
+            dataf_row_span(&nav->sza, y, &s0, &s1);
+        }
+        if (s0 > x0) x0 = s0;
+        if (s1 < x1) x1 = s1;
+        if (x1 < x0) x1 = x0;
+        float *row = data->data_in + (size_t)y * w;
+        memset(row, 0, x0 * sizeof(float));
+        memset(row + x1, 0, (w - x1) * sizeof(float));
+
+        for (unsigned int x = x0; x < x1; x++) {
+            size_t i = (size_t)y * w + x;
+            float refl = data->data_in[i];
+            float geom[3];
+            rayleigh_nav_at(nav, x, y, geom);
+            float sza_deg = geom[0];
+
+            if (IS_NONDATA(refl) || IS_NONDATA(sza_deg) || sza_deg > MAX_SZA) {
+                data->data_in[i] = 0.0f; // clamp to black at night/terminator
+                continue;
+            }
+
+            float cos_sza = cosf(sza_deg * RAD_PER_DEG);
+            // Avoid division by zero (MAX_SZA guard already prevents cos_sza ~ 0).
+            if (cos_sza > 0.087f) { // cos(85) approx 0.087
+                float corrected = refl / cos_sza;
+                data->data_in[i] = corrected;
+                if (corrected < local_min) local_min = corrected;
+                if (corrected > local_max) local_max = corrected;
+            } else {
+                data->data_in[i] = 0.0f;
+            }
         }
     }
+    dataf_drop_spans(data);
 
     LOG_TIMING(omp_get_wtime() - start, "Solar zenith correction");
 
@@ -134,7 +165,6 @@ ImageData create_multiband_rgb(const DataF* r_ch, const DataF* g_ch, const DataF
         return image_create(0, 0, 0);
     }
 
-    size_t size = r_ch->size;
     float r_range = r_max - r_min;
     float g_range = g_max - g_min;
     float b_range = b_max - b_min;
@@ -150,39 +180,67 @@ ImageData create_multiband_rgb(const DataF* r_ch, const DataF* g_ch, const DataF
     // compose alone — same total work, no transfer to attribute.
     double start = omp_get_wtime();
 
+    // Black wherever all three are NonData: off the union of their spans, if
+    // each of them has some.
+    bool spans = r_ch->spans && g_ch->spans && b_ch->spans;
+    const unsigned int w = r_ch->width;
+
     #pragma omp parallel for
-    for (size_t i = 0; i < size; i++) {
-        float r_val = r_ch->data_in[i];
-        float g_val = g_ch->data_in[i];
-        float b_val = b_ch->data_in[i];
-
-        uint8_t r_byte = 0, g_byte = 0, b_byte = 0;
-
-        if (!IS_NONDATA(r_val)) {
-            float norm = (r_val - r_min) / r_range;
-            if (norm < 0.0f) norm = 0.0f;
-            if (norm > 1.0f) norm = 1.0f;
-            r_byte = (uint8_t)(norm * 255.0f);
+    for (unsigned int y = 0; y < r_ch->height; y++) {
+        unsigned int x0 = 0, x1 = w;
+        if (spans) {
+            x0 = r_ch->spans->x[y][0];
+            x1 = r_ch->spans->x[y][1];
+            const DiskSpans *gb[2] = {g_ch->spans, b_ch->spans};
+            for (int k = 0; k < 2; k++) {
+                unsigned int s0 = gb[k]->x[y][0], s1 = gb[k]->x[y][1];
+                if (s0 == s1) continue;
+                if (x0 == x1) {
+                    x0 = s0;
+                    x1 = s1;
+                } else {
+                    if (s0 < x0) x0 = s0;
+                    if (s1 > x1) x1 = s1;
+                }
+            }
         }
-
-        if (!IS_NONDATA(g_val)) {
-            float norm = (g_val - g_min) / g_range;
-            if (norm < 0.0f) norm = 0.0f;
-            if (norm > 1.0f) norm = 1.0f;
-            g_byte = (uint8_t)(norm * 255.0f);
+        uint8_t *row = imout.data + (size_t)y * w * 3;
+        memset(row, 0, (size_t)x0 * 3);
+        memset(row + (size_t)x1 * 3, 0, (size_t)(w - x1) * 3);
+
+        for (size_t i = (size_t)y * w + x0; i < (size_t)y * w + x1; i++) {
+            float r_val = r_ch->data_in[i];
+            float g_val = g_ch->data_in[i];
+            float b_val = b_ch->data_in[i];
+
+            uint8_t r_byte = 0, g_byte = 0, b_byte = 0;
+
+            if (!IS_NONDATA(r_val)) {
+                float norm = (r_val - r_min) / r_range;
+                if (norm < 0.0f) norm = 0.0f;
+                if (norm > 1.0f) norm = 1.0f;
+                r_byte = (uint8_t)(norm * 255.0f);
+            }
+
+            if (!IS_NONDATA(g_val)) {
+                float norm = (g_val - g_min) / g_range;
+                if (norm < 0.0f) norm = 0.0f;
+                if (norm > 1.0f) norm = 1.0f;
+                g_byte = (uint8_t)(norm * 255.0f);
+            }
+
+            if (!IS_NONDATA(b_val)) {
+                float norm = (b_val - b_min) / b_range;
+                if (norm < 0.0f) norm = 0.0f;
+                if (norm > 1.0f) norm = 1.0f;
+                b_byte = (uint8_t)(norm * 255.0f);
+            }
+
+            size_t idx = i * 3;
+            imout.data[idx] = r_byte;
+            imout.data[idx + 1] = g_byte;
+            imout.data[idx + 2] = b_byte;
         }
-
-        if (!IS_NONDATA(b_val)) {
-            float norm = (b_val - b_min) / b_range;
-            if (norm < 0.0f) norm = 0.0f;
-            if (norm > 1.0f) norm = 1.0f;
-            b_byte = (uint8_t)(norm * 255.0f);
-        }
-
-        size_t idx = i * 3;
-        imout.data[idx] = r_byte;
-        imout.data[idx + 1] = g_byte;
-        imout.data[idx + 2] = b_byte;
     }
 
     LOG_TIMING(omp_get_wtime() - start, "Multiband RGB");
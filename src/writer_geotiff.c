@@ -10,11 +10,15 @@
 #include <gdal.h>
 #include <cpl_string.h>
 #include <ogr_srs_api.h>
+#include <fcntl.h>
+#include <libdeflate.h>
 #include <omp.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 #include <time.h>
+#include <unistd.h>
 
 // --- Funciones Auxiliares Privadas ---
 
@@ -117,6 +121,47 @@ static char* get_projection_wkt(const DataNC* meta) {
     return wkt;
 }
 
+/**
+ * Proyección, GeoTransform y metadatos internos del dataset.
+ * NOTA IMPORTANTE: Si la proyección es GEOS, convierte el GeoTransform
+ * de Radianes a Metros multiplicando por la altura del satélite.
+ */
+static void set_georeference(GDALDatasetH ds, const DataNC* meta, int offset_x, int offset_y) {
+    if (!meta) return;
+
+    // 1. Set projection (WKT).
+    char* wkt = get_projection_wkt(meta);
+    if (wkt) {
+        GDALSetProjection(ds, wkt);
+        CPLFree(wkt);
+    }
+
+    // 2. Configurar GeoTransform
+    double gt[6];
+    memcpy(gt, meta->geotransform, sizeof(double) * 6);
+
+    // --- UNIT CONVERSION (radians -> metres) ---
+    // The NetCDF geotransform is in radians; PROJ (+proj=geos) requires metres.
+    if (meta->proj_code == PROJ_GEOS && meta->proj_info.valid) {
+        double h = meta->proj_info.sat_height;
+        gt[0] *= h; // origin X
+        gt[1] *= h; // pixel width
+        gt[2] *= h; // rotation X
+        gt[3] *= h; // origin Y
+        gt[4] *= h; // rotation Y
+        gt[5] *= h; // pixel height
+    }
+
+    // --- AJUSTE DE RECORTE (CROP) ---
+    gt[0] = gt[0] + (offset_x * gt[1]);
+    gt[3] = gt[3] + (offset_y * gt[5]);
+
+    GDALSetGeoTransform(ds, gt);
+
+    // 3. Internal metadata (satellite, sector, band).
+    set_gdal_metadata(ds, meta);
+}
+
 /**
  * Crea un Dataset en memoria (MEM), configura GeoTransform y proyección.
  * NOTA IMPORTANTE: Si la proyección es GEOS, convierte el GeoTransform
@@ -138,24 +183,25 @@ static char* get_projection_wkt(const DataNC* meta) {
  * reserva y copia.
  */
 static GDALDatasetH open_mem_wrapping(GDALDriverH driver, const unsigned char* data,
-                                      int width, int height, int bands) {
+                                      int width, int height, int bands, GDALDataType type) {
     // Se usa GDALAddBand con DATAPOINTER en vez de la sintaxis de nombre de
     // archivo "MEM:::DATAPOINTER=...": GDAL bloquea esa última por defecto desde
     // hace varias versiones (haría que un nombre de archivo no confiable pudiera
     // apuntar a memoria arbitraria) y exigiría activar GDAL_MEM_ENABLE_OPEN.
     // AddBand no tiene ese problema porque el puntero no viene de una ruta.
     GDALDatasetH ds = GDALCreate(driver, "", width, height, 0 /* sin bandas */,
-                                 GDT_Byte, NULL);
+                                 type, NULL);
     if (!ds) return NULL;
 
+    const int elem = GDALGetDataTypeSizeBytes(type);
     char pixoff[32], lineoff[32];
-    snprintf(pixoff, sizeof(pixoff), "%d", bands);            // RGBRGB...: 1 píxel = bands bytes
-    snprintf(lineoff, sizeof(lineoff), "%d", bands * width);  // 1 línea = bands*width bytes
+    snprintf(pixoff, sizeof(pixoff), "%d", bands * elem);            // RGBRGB...: 1 píxel = bands muestras
+    snprintf(lineoff, sizeof(lineoff), "%d", bands * elem * width);  // 1 línea = bands*width muestras
 
     for (int i = 0; i < bands; i++) {
-        // La banda i arranca en el byte i y avanza de `bands` en `bands`.
+        // La banda i arranca en la muestra i y avanza de `bands` en `bands`.
         char ptr[64] = {0};
-        int n = CPLPrintPointer(ptr, (void*)(data + i), (int)sizeof(ptr) - 1);
+        int n = CPLPrintPointer(ptr, (void*)(data + i * elem), (int)sizeof(ptr) - 1);
         if (n <= 0 || n >= (int)sizeof(ptr)) { GDALClose(ds); return NULL; }
         ptr[n] = '\0';
 
@@ -163,7 +209,7 @@ static GDALDatasetH open_mem_wrapping(GDALDriverH driver, const unsigned char* d
         opts = CSLSetNameValue(opts, "DATAPOINTER", ptr);
         opts = CSLSetNameValue(opts, "PIXELOFFSET", pixoff);
         opts = CSLSetNameValue(opts, "LINEOFFSET", lineoff);
-        CPLErr e = GDALAddBand(ds, GDT_Byte, opts);
+        CPLErr e = GDALAddBand(ds, type, opts);
         CSLDestroy(opts);
         if (e != CE_None) { GDALClose(ds); return NULL; }
     }
@@ -171,8 +217,8 @@ static GDALDatasetH open_mem_wrapping(GDALDriverH driver, const unsigned char* d
 }
 
 /**
- * @param data         Si no es NULL (y type es GDT_Byte), intenta envolver ese
- *                     buffer entrelazado sin copiarlo.
+ * @param data         Si no es NULL (type GDT_Byte o GDT_Float32), intenta
+ *                     envolver ese buffer entrelazado sin copiarlo.
  * @param out_wrapped  Devuelve true si lo logró; en ese caso el dataset ya trae
  *                     los píxeles y el llamador NO debe escribir las bandas. Si
  *                     es false (o data era NULL) el dataset viene vacío y hay que
@@ -198,8 +244,8 @@ static GDALDatasetH create_mem_dataset(int width,
 
     GDALDatasetH ds = NULL;
     // HPSV_NO_MEM_ZEROCOPY=1 fuerza el camino que copia (para A/B de rendimiento).
-    if (data && type == GDT_Byte && !getenv("HPSV_NO_MEM_ZEROCOPY")) {
-        ds = open_mem_wrapping(driver, data, width, height, bands);
+    if (data && (type == GDT_Byte || type == GDT_Float32) && !getenv("HPSV_NO_MEM_ZEROCOPY")) {
+        ds = open_mem_wrapping(driver, data, width, height, bands, type);
         if (ds) {
             if (out_wrapped) *out_wrapped = true;
         } else {
@@ -213,40 +259,7 @@ static GDALDatasetH create_mem_dataset(int width,
         return NULL;
     }
 
-    if (meta) {
-        // 1. Set projection (WKT).
-        char* wkt = get_projection_wkt(meta);
-        if (wkt) {
-            GDALSetProjection(ds, wkt);
-            CPLFree(wkt);
-        }
-
-        // 2. Configurar GeoTransform
-        double gt[6];
-        memcpy(gt, meta->geotransform, sizeof(double) * 6);
-
-        // --- UNIT CONVERSION (radians -> metres) ---
-        // The NetCDF geotransform is in radians; PROJ (+proj=geos) requires metres.
-        if (meta->proj_code == PROJ_GEOS && meta->proj_info.valid) {
-            double h = meta->proj_info.sat_height;
-            gt[0] *= h; // origin X
-            gt[1] *= h; // pixel width
-            gt[2] *= h; // rotation X
-            gt[3] *= h; // origin Y
-            gt[4] *= h; // rotation Y
-            gt[5] *= h; // pixel height
-        }
-
-        // --- AJUSTE DE RECORTE (CROP) ---
-        gt[0] = gt[0] + (offset_x * gt[1]);
-        gt[3] = gt[3] + (offset_y * gt[5]);
-
-        GDALSetGeoTransform(ds, gt);
-
-        // 3. Internal metadata (satellite, sector, band).
-        set_gdal_metadata(ds, meta);
-    }
-
+    set_georeference(ds, meta, offset_x, offset_y);
     return ds;
 }
 
@@ -268,11 +281,19 @@ static int finalize_cog(GDALDatasetH mem_ds, const char* filename, bool cog) {
         return -1;
     }
 
+    // Predictor horizontal para enteros, de punto flotante (3) para Float32.
+    GDALRasterBandH band1 = GDALGetRasterBand(mem_ds, 1);
+    GDALDataType type = GDALGetRasterDataType(band1);
+    // Si cog_overviews() ya dejó la pirámide en el dataset, el driver la copia
+    // tal cual; si no, la calcula él desde la resolución completa.
+    const char* overviews = !cog ? "NONE"
+                            : GDALGetOverviewCount(band1) > 0 ? "FORCE_USE_EXISTING"
+                                                              : "IGNORE_EXISTING";
     char **opts = NULL;
     opts = CSLSetNameValue(opts, "COMPRESS", "ZSTD");
-    opts = CSLSetNameValue(opts, "PREDICTOR", "2");
+    opts = CSLSetNameValue(opts, "PREDICTOR", type == GDT_Float32 ? "3" : "2");
     opts = CSLSetNameValue(opts, "LEVEL", "6");
-    opts = CSLSetNameValue(opts, "OVERVIEWS", cog ? "IGNORE_EXISTING" : "NONE");
+    opts = CSLSetNameValue(opts, "OVERVIEWS", overviews);
     opts = CSLSetNameValue(opts, "NUM_THREADS", "ALL_CPUS");
 
     double t0 = omp_get_wtime();
@@ -294,6 +315,372 @@ static int finalize_cog(GDALDatasetH mem_ds, const char* filename, bool cog) {
     return 0;
 }
 
+/// Tabla de color e índice NoData de una banda indexada.
+static void set_palette(GDALRasterBandH band, const ColorArray* palette, const ColormapMeta* cm) {
+    if (palette) {
+        GDALColorTableH ct = GDALCreateColorTable(GPI_RGB);
+        for (unsigned i = 0; i < palette->length; i++) {
+            GDALColorEntry e = {palette->colors[i].r, palette->colors[i].g, palette->colors[i].b, 255};
+            GDALSetColorEntry(ct, i, &e);
+        }
+        GDALSetRasterColorTable(band, ct);
+        GDALDestroyColorTable(ct);
+        GDALSetRasterColorInterpretation(band, GCI_PaletteIndex);
+    }
+
+    if (cm && cm->has_nodata) {
+        GDALSetRasterNoDataValue(band, (double)cm->nodata_index);
+    }
+}
+
+// --- Escritor nativo de TIFF tileado ---
+
+/* El camino por defecto (sin --cog) para imágenes uint8 no pasa por el dataset
+ * MEM ni por GDALCreateCopy, que copia los píxeles a su caché de bloques, los
+ * re-tilea y los comprime en su propio pipeline. GDAL solo crea el archivo:
+ * cabecera, IFD y todas las etiquetas (geotransform, WKT, metadatos, paleta,
+ * alfa), con SPARSE_OK para que no escriba ningún tile. Después los tiles de
+ * 512x512 se arman directo desde el buffer entrelazado, se les aplica el
+ * predictor horizontal (2) y se comprimen con libdeflate en todos los núcleos;
+ * se añaden al final del archivo en orden y sus offsets y tamaños se escriben en
+ * los arreglos TileOffsets/TileByteCounts que GDAL dejó en cero.
+ * HPSV_NO_NATIVE_TIFF=1 vuelve al camino MEM + COG. */
+
+#define NATIVE_TILE 512
+#define NATIVE_LEVEL 6 // el mismo nivel que ZSTD en finalize_cog
+
+#define TIFFTAG_COMPRESSION    259
+#define TIFFTAG_PLANARCONFIG   284
+#define TIFFTAG_PREDICTOR      317
+#define TIFFTAG_TILEWIDTH      322
+#define TIFFTAG_TILELENGTH     323
+#define TIFFTAG_TILEOFFSETS    324
+#define TIFFTAG_TILEBYTECOUNTS 325
+
+static bool native_tiff_wanted(bool cog) {
+    return !cog && !getenv("HPSV_NO_NATIVE_TIFF");
+}
+
+/**
+ * Crea el esqueleto GTiff (sin tiles) y le pone la georreferencia. El llamador
+ * agrega producto, alfa y paleta antes de native_tiff_write().
+ */
+static GDALDatasetH native_tiff_create(const char* filename, int width, int height, int bands,
+                                       const DataNC* meta, int offset_x, int offset_y,
+                                       bool palette) {
+    GDALAllRegister();
+    GDALDriverH driver = GDALGetDriverByName("GTiff");
+    if (!driver) return NULL;
+
+    // deflate no crece más que unos bytes por tile sobre los datos crudos: si
+    // éstos caben con holgura en 4 GB, el TIFF clásico alcanza.
+    double raw = (double)width * height * bands;
+    char **opts = NULL;
+    opts = CSLSetNameValue(opts, "TILED", "YES");
+    opts = CSLSetNameValue(opts, "BLOCKXSIZE", "512");
+    opts = CSLSetNameValue(opts, "BLOCKYSIZE", "512");
+    opts = CSLSetNameValue(opts, "COMPRESS", "DEFLATE");
+    opts = CSLSetNameValue(opts, "PREDICTOR", "2");
+    opts = CSLSetNameValue(opts, "INTERLEAVE", "PIXEL");
+    opts = CSLSetNameValue(opts, "SPARSE_OK", "TRUE");
+    opts = CSLSetNameValue(opts, "BIGTIFF", raw > 3.9e9 ? "YES" : "NO");
+    if (palette) opts = CSLSetNameValue(opts, "PHOTOMETRIC", "PALETTE");
+    else if (bands >= 3) opts = CSLSetNameValue(opts, "PHOTOMETRIC", "RGB");
+    if (bands == 2 || bands == 4) opts = CSLSetNameValue(opts, "ALPHA", "YES");
+    GDALDatasetH ds = GDALCreate(driver, filename, width, height, bands, GDT_Byte, opts);
+    CSLDestroy(opts);
+    if (!ds) return NULL;
+    set_georeference(ds, meta, offset_x, offset_y);
+    return ds;
+}
+
+static uint64_t tiff_get(const uint8_t* p, int n, bool be) {
+    uint64_t v = 0;
+    for (int i = 0; i < n; i++) v |= (uint64_t)p[be ? n - 1 - i : i] << (8 * i);
+    return v;
+}
+
+static void tiff_put(uint8_t* p, uint64_t v, int n, bool be) {
+    for (int i = 0; i < n; i++) p[be ? n - 1 - i : i] = (uint8_t)(v >> (8 * i));
+}
+
+/// Dónde están en el archivo los valores de una etiqueta del IFD.
+typedef struct {
+    uint64_t pos;
+    uint64_t count;
+    int size; ///< bytes por valor: 2 (SHORT), 4 (LONG) u 8 (LONG8)
+} TiffArray;
+
+/**
+ * Lee el primer IFD del archivo que dejó GDAL, comprueba que el formato de los
+ * tiles es el que native_tiff_write() produce y ubica los arreglos de offsets y
+ * tamaños. Devuelve 0 si todo calza.
+ */
+static int native_tiff_layout(int fd, size_t ntiles, bool* be, bool* big,
+                              TiffArray* offsets, TiffArray* counts) {
+    uint8_t head[16];
+    if (pread(fd, head, sizeof(head), 0) != (ssize_t)sizeof(head)) return -1;
+    if (head[0] == 'I' && head[1] == 'I') *be = false;
+    else if (head[0] == 'M' && head[1] == 'M') *be = true;
+    else return -1;
+    uint64_t magic = tiff_get(head + 2, 2, *be);
+    if (magic != 42 && magic != 43) return -1;
+    *big = magic == 43;
+    const int cnt_size = *big ? 8 : 2, entry = *big ? 20 : 12, field = *big ? 8 : 4;
+    uint64_t ifd = *big ? tiff_get(head + 8, 8, *be) : tiff_get(head + 4, 4, *be);
+
+    uint8_t nbuf[8];
+    if (pread(fd, nbuf, cnt_size, (off_t)ifd) != cnt_size) return -1;
+    uint64_t n = tiff_get(nbuf, cnt_size, *be);
+    if (n == 0 || n > 4096) return -1;
+    uint8_t* dir = malloc(n * entry);
+    if (!dir || pread(fd, dir, n * entry, (off_t)(ifd + cnt_size)) != (ssize_t)(n * entry)) {
+        free(dir);
+        return -1;
+    }
+
+    int ok = 0;
+    offsets->size = counts->size = 0;
+    for (uint64_t i = 0; i < n; i++) {
+        const uint8_t* e = dir + i * entry;
+        unsigned tag = (unsigned)tiff_get(e, 2, *be);
+        unsigned type = (unsigned)tiff_get(e + 2, 2, *be);
+        uint64_t count = tiff_get(e + 4, *big ? 8 : 4, *be);
+        const uint8_t* value = e + 4 + (*big ? 8 : 4);
+        int size = type == 3 ? 2 : type == 4 ? 4 : type == 16 ? 8 : 0;
+        // Etiquetas escalares: el valor va al inicio del campo.
+        uint64_t scalar = size ? tiff_get(value, size, *be) : 0;
+        switch (tag) {
+        case TIFFTAG_COMPRESSION:  ok |= scalar == 8 ? 0 : -1; break;
+        case TIFFTAG_PREDICTOR:    ok |= scalar == 2 ? 0 : -1; break;
+        case TIFFTAG_PLANARCONFIG: ok |= scalar == 1 ? 0 : -1; break;
+        case TIFFTAG_TILEWIDTH:
+        case TIFFTAG_TILELENGTH:   ok |= scalar == NATIVE_TILE ? 0 : -1; break;
+        case TIFFTAG_TILEOFFSETS:
+        case TIFFTAG_TILEBYTECOUNTS: {
+            TiffArray* a = tag == TIFFTAG_TILEOFFSETS ? offsets : counts;
+            a->size = size;
+            a->count = count;
+            a->pos = size && count * size <= (uint64_t)field
+                         ? ifd + cnt_size + i * entry + 4 + (*big ? 8 : 4)
+                         : tiff_get(value, field, *be);
+            break;
+        }
+        }
+    }
+    free(dir);
+    if (ok != 0 || !offsets->size || !counts->size || offsets->count != ntiles ||
+        counts->count != ntiles)
+        return -1;
+    return 0;
+}
+
+static int write_tiff_array(int fd, const TiffArray* a, const uint64_t* v, bool be) {
+    uint8_t* buf = malloc(a->count * a->size);
+    if (!buf) return -1;
+    const uint64_t max = a->size == 8 ? UINT64_MAX : (UINT64_C(1) << (8 * a->size)) - 1;
+    int status = 0;
+    for (uint64_t i = 0; i < a->count; i++) {
+        if (v[i] > max) status = -1;
+        tiff_put(buf + i * a->size, v[i], a->size, be);
+    }
+    size_t len = a->count * a->size;
+    if (status == 0 && pwrite(fd, buf, len, (off_t)a->pos) != (ssize_t)len) status = -1;
+    free(buf);
+    return status;
+}
+
+/**
+ * Cierra el esqueleto `ds` (GDAL escribe el IFD) y escribe los tiles de `data`
+ * (entrelazado, `bands` bytes por píxel). Devuelve 0 si terminó; si no, borra
+ * el archivo para que el llamador escriba por el camino de GDAL.
+ */
+static int native_tiff_write(GDALDatasetH ds, const char* filename, const unsigned char* data,
+                             int width, int height, int bands) {
+    double t0 = omp_get_wtime();
+    GDALClose(ds);
+
+    const size_t tiles_x = ((size_t)width + NATIVE_TILE - 1) / NATIVE_TILE;
+    const size_t tiles_y = ((size_t)height + NATIVE_TILE - 1) / NATIVE_TILE;
+    const size_t ntiles = tiles_x * tiles_y;
+    const size_t row_len = (size_t)NATIVE_TILE * bands;
+    const size_t tile_bytes = row_len * NATIVE_TILE;
+
+    bool be = false, big = false;
+    TiffArray offs, cnts;
+    uint64_t* offsets = malloc(ntiles * sizeof(uint64_t));
+    uint64_t* counts = malloc(ntiles * sizeof(uint64_t));
+    int fd = open(filename, O_RDWR);
+    off_t end = fd >= 0 ? lseek(fd, 0, SEEK_END) : -1;
+    int failed = !offsets || !counts || end < 0 ||
+                 native_tiff_layout(fd, ntiles, &be, &big, &offs, &cnts) != 0;
+    uint64_t pos = (uint64_t)end + ((uint64_t)end & 1); // offsets en límite de palabra
+
+    #pragma omp parallel if (!failed)
+    {
+        struct libdeflate_compressor* c = libdeflate_alloc_compressor(NATIVE_LEVEL);
+        size_t cap = c ? libdeflate_zlib_compress_bound(c, tile_bytes) : 0;
+        uint8_t* tile = malloc(tile_bytes);
+        uint8_t* out = malloc(cap);
+        bool ready = c && tile && out;
+        if (!ready) {
+            #pragma omp atomic write
+            failed = 1;
+        }
+
+        #pragma omp for ordered schedule(dynamic, 1)
+        for (size_t t = 0; t < ntiles; t++) {
+            int stop;
+            #pragma omp atomic read
+            stop = failed;
+            size_t n = 0;
+            if (ready && !stop) {
+                const size_t x0 = (t % tiles_x) * NATIVE_TILE, y0 = (t / tiles_x) * NATIVE_TILE;
+                const size_t w = (size_t)width - x0 < NATIVE_TILE ? (size_t)width - x0 : NATIVE_TILE;
+                for (size_t y = 0; y < NATIVE_TILE; y++) {
+                    uint8_t* row = tile + y * row_len;
+                    size_t valid = 0;
+                    if (y0 + y < (size_t)height) {
+                        valid = w * bands;
+                        memcpy(row, data + ((y0 + y) * width + x0) * bands, valid);
+                    }
+                    memset(row + valid, 0, row_len - valid); // relleno de los tiles del borde
+                    // Predictor 2: cada muestra menos la misma del píxel anterior.
+                    for (size_t i = row_len - 1; i >= (size_t)bands; i--)
+                        row[i] = (uint8_t)(row[i] - row[i - bands]);
+                }
+                n = libdeflate_zlib_compress(c, tile, tile_bytes, out, cap);
+            }
+
+            #pragma omp ordered
+            {
+                int prior;
+                #pragma omp atomic read
+                prior = failed;
+                if (n > 0 && !prior && pwrite(fd, out, n, (off_t)pos) == (ssize_t)n) {
+                    offsets[t] = pos;
+                    counts[t] = n;
+                    pos += n + (n & 1);
+                } else {
+                    #pragma omp atomic write
+                    failed = 1;
+                }
+            }
+        }
+
+        free(tile);
+        free(out);
+        if (c) libdeflate_free_compressor(c);
+    }
+
+    if (!failed && !big && pos > UINT32_MAX) failed = 1;
+    if (!failed)
+        failed = write_tiff_array(fd, &offs, offsets, be) != 0 ||
+                 write_tiff_array(fd, &cnts, counts, be) != 0;
+    if (fd >= 0 && close(fd) != 0) failed = 1;
+    free(offsets);
+    free(counts);
+    if (failed) {
+        LOG_WARN("Native TIFF writer failed for %s; writing it through GDAL.", filename);
+        unlink(filename);
+        return -1;
+    }
+
+    LOG_TIMING(omp_get_wtime() - t0, "GeoTIFF written (native, %zu tiles): %s", ntiles, filename);
+    LOG_INFO("GeoTIFF saved: %s (%dx%d, %d band%s)", filename, width, height, bands,
+             bands == 1 ? "" : "s");
+    return 0;
+}
+
+/**
+ * Escribe una imagen uint8 de 1 a 4 bandas con el escritor nativo. La última
+ * banda es alfa con 2 o 4; `palette`/`cm` describen una imagen indexada.
+ * Devuelve 0 si lo logró; si no, el llamador sigue por el camino de GDAL.
+ */
+static int write_native(const char* filename, const ImageData* img, const DataNC* meta,
+                        int offset_x, int offset_y, const ColorArray* palette,
+                        const ColormapMeta* cm, const char* product) {
+    const int bands = (int)img->bpp;
+    GDALDatasetH ds = native_tiff_create(filename, (int)img->width, (int)img->height, bands,
+                                         meta, offset_x, offset_y, palette != NULL);
+    if (!ds) return -1;
+    if (product && product[0])
+        GDALSetMetadataItem(ds, "product", product, "");
+    if (bands == 2 || bands == 4)
+        GDALSetRasterColorInterpretation(GDALGetRasterBand(ds, bands), GCI_AlphaBand);
+    if (palette || cm) {
+        set_palette(GDALGetRasterBand(ds, 1), palette, cm);
+        set_colormap_metadata(ds, cm);
+    }
+    return native_tiff_write(ds, filename, img->data, (int)img->width, (int)img->height, bands);
+}
+
+// --- Overviews del COG ---
+
+/**
+ * Pirámide de overviews para --cog, en cascada: cada nivel es el promedio 2×2
+ * (image_downsample_boxfilter_cover) del anterior, no de la resolución
+ * completa, así que todos los niveles juntos cuestan un tercio de una pasada
+ * sobre la imagen, y cada nivel se reparte entre los hilos. Los niveles son los
+ * que generaría el driver COG (factores 2, 4, 8... hasta que ambos lados caben
+ * en un bloque de 512) y se cuelgan del dataset MEM como overviews ya llenos;
+ * finalize_cog() los copia en vez de recalcularlos.
+ *
+ * Solo imágenes uint8 continuas (gris, RGB, con alfa): las indexadas no se
+ * promedian y Float32 lleva NonData, así que ésas siguen con GDAL. También con
+ * HPSV_NO_BOX_OVERVIEWS=1. Devuelve 0 si la pirámide quedó en el dataset.
+ */
+static int cog_overviews(GDALDatasetH ds, const ImageData* img) {
+    if (getenv("HPSV_NO_BOX_OVERVIEWS")) return -1;
+    int factors[32], nlev = 0;
+    for (unsigned w = img->width, h = img->height, f = 2; (w > 512 || h > 512) && nlev < 32;
+         f *= 2) {
+        factors[nlev++] = (int)f;
+        w = (img->width + f - 1) / f;
+        h = (img->height + f - 1) / f;
+    }
+    if (nlev == 0) return -1;
+
+    double t0 = omp_get_wtime();
+    // "NONE" solo crea las bandas de overview, sin calcular nada.
+    if (GDALBuildOverviews(ds, "NONE", nlev, factors, 0, NULL, NULL, NULL) != CE_None) {
+        LOG_WARN("Could not attach COG overviews; GDAL will compute them.");
+        return -1;
+    }
+
+    const int bands = (int)img->bpp;
+    ImageData prev = *img;
+    int status = 0;
+    for (int l = 0; l < nlev && status == 0; l++) {
+        ImageData level = image_downsample_boxfilter_cover(&prev, 2);
+        if (prev.data != img->data) image_destroy(&prev);
+        if (!level.data) {
+            status = -1;
+            break;
+        }
+        for (int b = 0; b < bands && status == 0; b++) {
+            GDALRasterBandH ov = GDALGetOverview(GDALGetRasterBand(ds, b + 1), l);
+            if (!ov || GDALGetRasterBandXSize(ov) != (int)level.width ||
+                GDALGetRasterBandYSize(ov) != (int)level.height ||
+                GDALRasterIO(ov, GF_Write, 0, 0, level.width, level.height, level.data + b,
+                             level.width, level.height, GDT_Byte, bands,
+                             bands * level.width) != CE_None)
+                status = -1;
+        }
+        prev = level;
+    }
+    if (prev.data != img->data) image_destroy(&prev);
+
+    if (status != 0) {
+        // Sin pirámide completa se descarta: el driver COG la rehace.
+        GDALBuildOverviews(ds, "NONE", 0, NULL, 0, NULL, NULL, NULL);
+        LOG_WARN("Could not build COG overviews; GDAL will compute them.");
+        return -1;
+    }
+    LOG_TIMING(omp_get_wtime() - t0, "COG overviews (%d levels, box filter cascade)", nlev);
+    return 0;
+}
+
 // --- Public Function Implementations ---
 
 int write_geotiff_rgb(const char* filename, const ImageData* img, const DataNC* meta,
@@ -302,6 +689,9 @@ int write_geotiff_rgb(const char* filename, const ImageData* img, const DataNC*
         LOG_ERROR("Invalid image for write_geotiff_rgb (bpp=3 or bpp=4 required).");
         return -1;
     }
+    if (native_tiff_wanted(cog) &&
+        write_native(filename, img, meta, offset_x, offset_y, NULL, NULL, product) == 0)
+        return 0;
 
     // Create in-memory dataset: 3 or 4 bands depending on alpha presence.
     int num_bands = img->bpp;
@@ -345,6 +735,7 @@ int write_geotiff_rgb(const char* filename, const ImageData* img, const DataNC*
         GDALClose(ds);
         return -1;
     }
+    if (cog) cog_overviews(ds, img);
     return finalize_cog(ds, filename, cog);
 }
 
@@ -354,6 +745,9 @@ int write_geotiff_gray(const char* filename, const ImageData* img, const DataNC*
         LOG_ERROR("Invalid image for write_geotiff_gray (bpp=1 or bpp=2 required).");
         return -1;
     }
+    if (native_tiff_wanted(cog) &&
+        write_native(filename, img, meta, offset_x, offset_y, NULL, NULL, product) == 0)
+        return 0;
 
     // Create in-memory dataset: 1 or 2 bands depending on alpha presence.
     int num_bands = img->bpp;
@@ -409,6 +803,7 @@ int write_geotiff_gray(const char* filename, const ImageData* img, const DataNC*
         GDALClose(ds);
         return -1;
     }
+    if (cog) cog_overviews(ds, img);
     return finalize_cog(ds, filename, cog);
 }
 
@@ -419,6 +814,9 @@ int write_geotiff_indexed(const char* filename, const ImageData* img, const Colo
         LOG_ERROR("Invalid image for write_geotiff_indexed (bpp=1 required).");
         return -1;
     }
+    if (native_tiff_wanted(cog) &&
+        write_native(filename, img, meta, offset_x, offset_y, palette, cm, product) == 0)
+        return 0;
 
     // Sin zero-copy a propósito: es una sola banda (la copia es contigua, no hay
     // de-interleave que ahorrar) y este camino además cuelga una tabla de color
@@ -431,21 +829,7 @@ int write_geotiff_indexed(const char* filename, const ImageData* img, const Colo
         GDALSetMetadataItem(ds, "product", product, "");
 
     GDALRasterBandH band = GDALGetRasterBand(ds, 1);
-
-    if (palette) {
-        GDALColorTableH ct = GDALCreateColorTable(GPI_RGB);
-        for (unsigned i = 0; i < palette->length; i++) {
-            GDALColorEntry e = {palette->colors[i].r, palette->colors[i].g, palette->colors[i].b, 255};
-            GDALSetColorEntry(ct, i, &e);
-        }
-        GDALSetRasterColorTable(band, ct);
-        GDALDestroyColorTable(ct);
-        GDALSetRasterColorInterpretation(band, GCI_PaletteIndex);
-    }
-
-    if (cm && cm->has_nodata) {
-        GDALSetRasterNoDataValue(band, (double)cm->nodata_index);
-    }
+    set_palette(band, palette, cm);
 
     CPLErr err = GDALRasterIO(band, GF_Write, 0, 0, img->width, img->height,
                               (void*)img->data,
@@ -459,3 +843,181 @@ int write_geotiff_indexed(const char* filename, const ImageData* img, const Colo
     set_colormap_metadata(ds, cm);
     return finalize_cog(ds, filename, cog);
 }
+
+int write_geotiff_float(const char* filename, const DataF* data, const DataNC* meta,
+                        int offset_x, int offset_y, const char* product, bool cog) {
+    if (!data || !data->data_in || data->width == 0 || data->height == 0) {
+        LOG_ERROR("Invalid grid for write_geotiff_float.");
+        return -1;
+    }
+
+    // Los valores físicos tal cual: el dataset MEM envuelve data_in (una banda
+    // Float32 contigua) y NonData queda declarado como valor nodata.
+    double t_mem0 = omp_get_wtime();
+    bool wrapped = false;
+    GDALDatasetH ds = create_mem_dataset((int)data->width, (int)data->height, 1, GDT_Float32,
+                                         meta, offset_x, offset_y,
+                                         (const unsigned char*)data->data_in, &wrapped);
+    if (!ds) return -1;
+
+    if (product && product[0])
+        GDALSetMetadataItem(ds, "product", product, "");
+
+    GDALRasterBandH band = GDALGetRasterBand(ds, 1);
+    CPLErr err = CE_None;
+    if (!wrapped)
+        err = GDALRasterIO(band, GF_Write, 0, 0, (int)data->width, (int)data->height,
+                           (void*)data->data_in, (int)data->width, (int)data->height,
+                           GDT_Float32, 0, 0);
+    GDALSetRasterNoDataValue(band, (double)NonData);
+    LOG_TIMING(omp_get_wtime() - t_mem0, "GeoTIFF MEM dataset (Float32, %ux%u, %s)",
+               data->width, data->height, wrapped ? "zero-copy" : "copia");
+
+    if (err != CE_None) {
+        GDALClose(ds);
+        return -1;
+    }
+    return finalize_cog(ds, filename, cog);
+}
+
+// --- Escritura por franjas ---
+
+/* Un GeoTIFF de salida demasiado grande para la memoria no pasa por el dataset
+ * MEM: se crea directamente en disco con el driver GTiff, tileado igual que el
+ * COG (512x512, ZSTD, predictor 2, compresión multi-hilo), y recibe las franjas
+ * en orden. Cada franja de 512 filas completa una fila de bloques, que GDAL
+ * comprime y baja a disco al desalojarla de su caché, así que la memoria queda
+ * acotada por la franja y el caché de bloques. Con `cog` el archivo tileado es
+ * un intermedio y el COG con overviews se copia de él al cerrar. */
+struct GeoTiffStream {
+    GDALDatasetH ds;
+    char* filename;   ///< destino final
+    char* tmp;        ///< GTiff intermedio cuando cog, si no NULL
+    const ColorArray* expand; ///< paleta a expandir en cada franja (salida RGB/RGBA)
+    int width, height, bands;
+    bool cog;
+    double t_write;   ///< tiempo acumulado en geotiff_stream_write
+};
+
+GeoTiffStream* geotiff_stream_open(const char* filename, int width, int height, int bands,
+                                   const DataNC* meta, const ColorArray* palette,
+                                   const ColormapMeta* cm, const char* product, bool cog) {
+    if (!filename || width <= 0 || height <= 0 || bands < 1 || bands > 4) {
+        LOG_ERROR("Invalid parameters for geotiff_stream_open.");
+        return NULL;
+    }
+    GDALAllRegister();
+    GDALDriverH driver = GDALGetDriverByName("GTiff");
+    if (!driver) {
+        LOG_ERROR("GTiff driver not available in GDAL.");
+        return NULL;
+    }
+
+    GeoTiffStream* s = calloc(1, sizeof(*s));
+    if (!s) return NULL;
+    s->filename = strdup(filename);
+    s->width = width;
+    s->height = height;
+    s->bands = bands;
+    s->cog = cog;
+    // Pseudocolor con alfa: las franjas llegan indexadas y se escriben en RGBA.
+    if (bands >= 3 && palette) s->expand = palette;
+    if (cog) {
+        size_t n = strlen(filename) + 32;
+        s->tmp = malloc(n);
+        if (s->tmp) snprintf(s->tmp, n, "%s.%ld.tmp.tif", filename, (long)getpid());
+    }
+    if (!s->filename || (cog && !s->tmp)) {
+        free(s->filename);
+        free(s->tmp);
+        free(s);
+        return NULL;
+    }
+
+    char **opts = NULL;
+    opts = CSLSetNameValue(opts, "TILED", "YES");
+    opts = CSLSetNameValue(opts, "BLOCKXSIZE", "512");
+    opts = CSLSetNameValue(opts, "BLOCKYSIZE", "512");
+    opts = CSLSetNameValue(opts, "COMPRESS", "ZSTD");
+    opts = CSLSetNameValue(opts, "PREDICTOR", "2");
+    opts = CSLSetNameValue(opts, "ZSTD_LEVEL", "6");
+    opts = CSLSetNameValue(opts, "INTERLEAVE", "PIXEL");
+    opts = CSLSetNameValue(opts, "BIGTIFF", "IF_SAFER");
+    opts = CSLSetNameValue(opts, "NUM_THREADS", "ALL_CPUS");
+    const char* path = cog ? s->tmp : s->filename;
+    s->ds = GDALCreate(driver, path, width, height, bands, GDT_Byte, opts);
+    CSLDestroy(opts);
+    if (!s->ds) {
+        LOG_ERROR("Could not create GeoTIFF file: %s", path);
+        free(s->filename);
+        free(s->tmp);
+        free(s);
+        return NULL;
+    }
+
+    set_georeference(s->ds, meta, 0, 0);
+    if (product && product[0])
+        GDALSetMetadataItem(s->ds, "product", product, "");
+    if (bands == 1) {
+        set_palette(GDALGetRasterBand(s->ds, 1), palette, cm);
+        set_colormap_metadata(s->ds, cm);
+    } else if (bands == 2 || bands == 4) {
+        GDALSetRasterColorInterpretation(GDALGetRasterBand(s->ds, bands), GCI_AlphaBand);
+    }
+    LOG_DEBUG("GeoTIFF stream opened: %s (%dx%d, %d band%s)", path, width, height, bands,
+              bands == 1 ? "" : "s");
+    return s;
+}
+
+int geotiff_stream_write(GeoTiffStream* s, const ImageData* strip, int y0) {
+    if (!s || !strip || !strip->data || (int)strip->width != s->width ||
+        y0 < 0 || y0 + (int)strip->height > s->height) {
+        LOG_ERROR("Strip does not fit the GeoTIFF stream.");
+        return -1;
+    }
+    double t0 = omp_get_wtime();
+    ImageData expanded = {0};
+    const ImageData* img = strip;
+    if (s->expand) {
+        expanded = image_expand_palette(strip, s->expand);
+        img = &expanded;
+    }
+    if (!img->data || (int)img->bpp != s->bands) {
+        LOG_ERROR("Strip does not fit the GeoTIFF stream (bpp %u, %d bands).", img->bpp, s->bands);
+        image_destroy(&expanded);
+        return -1;
+    }
+    // Entrelazado como viene (RGBRGB...): GDAL lo reparte en los bloques PIXEL.
+    CPLErr err = GDALDatasetRasterIO(s->ds, GF_Write, 0, y0, s->width, (int)img->height,
+                                     img->data, s->width, (int)img->height, GDT_Byte,
+                                     s->bands, NULL, s->bands, s->bands * s->width, 1);
+    image_destroy(&expanded);
+    s->t_write += omp_get_wtime() - t0;
+    return err == CE_None ? 0 : -1;
+}
+
+int geotiff_stream_strip(void* stream, const ImageData* strip, unsigned int y0) {
+    return geotiff_stream_write((GeoTiffStream*)stream, strip, (int)y0);
+}
+
+int geotiff_stream_close(GeoTiffStream* s) {
+    if (!s) return -1;
+    int status = 0;
+    if (s->cog) {
+        // finalize_cog lee el intermedio tileado bloque por bloque y lo cierra.
+        GDALFlushCache(s->ds);
+        status = finalize_cog(s->ds, s->filename, true);
+        unlink(s->tmp);
+    } else {
+        double t0 = omp_get_wtime();
+        GDALClose(s->ds);
+        LOG_TIMING(s->t_write + omp_get_wtime() - t0, "GeoTIFF written (streamed): %s",
+                   s->filename);
+        LOG_INFO("GeoTIFF saved: %s (%dx%d, %d band%s)", s->filename, s->width, s->height,
+                 s->bands, s->bands == 1 ? "" : "s");
+    }
+    free(s->filename);
+    free(s->tmp);
+    free(s);
+    return status;
+}
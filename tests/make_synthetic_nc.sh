@@ -0,0 +1,104 @@
+#!/bin/bash
+# Escribe un disco completo sintético de GOES-16 (malla fija de ABI) con ncgen,
+# para los tests que necesitan lo que sample_data/ no trae (solo CMIP CONUS): un
+# borde de espacio, o productos L2 de bytes y de punto flotante.
+#
+# Uso: make_synthetic_nc.sh <directorio> <banda|ACTP|LST> <n>
+#   Escribe en <directorio> una malla de n x n píxeles que cubre el disco
+#   completo (los ángulos de escaneo reales, más gruesos), con chunks de n/3,
+#   deflate y shuffle, como los productos reales:
+#     <banda>  OR_ABI-L2-CMIPF-M6C<banda>_G16_...nc, CMI en short
+#     ACTP     OR_ABI-L2-ACTPF-M6_G16_...nc, Phase en byte (fases 0-5)
+#     LST      OR_ABI-L2-LSTF-M6_G16_...nc, LST en float (K)
+#
+# Un píxel tiene dato si alguna parte de él ve la Tierra (su esquina más cercana
+# al nadir; más generoso que el centro, como las máscaras de los productos) y
+# _FillValue si no. Los datos son una textura que cambia en cada píxel, así que
+# perder uno solo cambia la imagen; en CMI lleva además un término propio de la
+# banda (±4 K), para que las diferencias entre bandas (ash, airmass) no sean
+# constantes.
+#
+# Requiere: ncgen (netcdf-bin), awk.
+set -euo pipefail
+
+DIR="$1"
+KIND="$2"
+N="$3"
+TIMES=s20242201301171_e20242201310479_c20242201310554
+BAND=0
+case "$KIND" in
+    ACTP) OUT="$DIR/OR_ABI-L2-ACTPF-M6_G16_$TIMES.nc"; VAR=Phase; TYPE=byte; FILL=-1b ;;
+    LST)  OUT="$DIR/OR_ABI-L2-LSTF-M6_G16_$TIMES.nc"; VAR=LST; TYPE=float; FILL=-999.f ;;
+    *)
+        BAND=$((10#$KIND))
+        OUT="$DIR/OR_ABI-L2-CMIPF-M6C$(printf "%02d" $BAND)_G16_$TIMES.nc"
+        VAR=CMI; TYPE=short; FILL=-1s ;;
+esac
+CDL="${OUT%.nc}.cdl"
+
+# CMI: reflectancia (C01-C06) o temperatura de brillo (C07-C16), de 100 a ~4000
+# cuentas empacadas. Los otros no se empacan.
+SCALE=""; OFFSET=""
+if [ "$TYPE" = short ]; then
+    if [ "$BAND" -le 6 ]; then SCALE=0.00025; OFFSET=0.0; else SCALE=0.05; OFFSET=180.0; fi
+fi
+
+awk -v n="$N" -v band="$BAND" -v var="$VAR" -v type="$TYPE" -v fill="$FILL" \
+    -v scale="$SCALE" -v offset="$OFFSET" '
+BEGIN {
+    H = 42164160.0; req = 6378137.0; rpol = 6356752.31414
+    half = 0.151872                      # semiancho del disco completo, rad
+    sf = 2.0 * half / n; ao = -half + sf / 2.0
+    chunk = int((n + 2) / 3)
+    printf "netcdf synthetic {\ndimensions:\n\ty = %d ;\n\tx = %d ;\n\tband = 1 ;\n", n, n
+    printf "variables:\n\t%s %s(y, x) ;\n\t\t%s:_FillValue = %s ;\n", type, var, var, fill
+    if (scale != "")
+        printf "\t\t%s:scale_factor = %.8g ;\n\t\t%s:add_offset = %.8g ;\n", var, scale, var, offset
+    printf "\t\t%s:_Storage = \"chunked\" ;\n\t\t%s:_ChunkSizes = %d, %d ;\n", var, var, chunk, chunk
+    printf "\t\t%s:_DeflateLevel = 1 ;\n\t\t%s:_Shuffle = \"true\" ;\n", var, var
+    printf "\tshort x(x) ;\n\t\tx:scale_factor = %.17g ;\n\t\tx:add_offset = %.17g ;\n", sf, ao
+    printf "\tshort y(y) ;\n\t\ty:scale_factor = %.17g ;\n\t\ty:add_offset = %.17g ;\n", -sf, -ao
+    printf "\tdouble t ;\n\tint band_id(band) ;\n\tint goes_imager_projection ;\n"
+    printf "\t\tgoes_imager_projection:perspective_point_height = 35786023. ;\n"
+    printf "\t\tgoes_imager_projection:semi_major_axis = 6378137. ;\n"
+    printf "\t\tgoes_imager_projection:semi_minor_axis = 6356752.31414 ;\n"
+    printf "\t\tgoes_imager_projection:inverse_flattening = 298.2572221 ;\n"
+    printf "\t\tgoes_imager_projection:longitude_of_projection_origin = -75. ;\n"
+    printf "\n// global attributes:\n\t\t:spatial_resolution = \"%gkm at nadir\" ;\n", 2.0 * 5424 / n
+    printf "data:\n\n t = 776307677.1 ;\n\n band_id = %d ;\n\n goes_imager_projection = 0 ;\n\n", band
+    fv = fill; sub(/[bsf]$/, "", fv)
+
+    printf " x = "
+    for (i = 0; i < n; i++) printf "%d%s", i, (i < n - 1 ? ", " : " ;\n\n")
+    printf " y = "
+    for (j = 0; j < n; j++) printf "%d%s", j, (j < n - 1 ? ", " : " ;\n\n")
+
+    # Esquina de cada columna/fila más cercana al nadir (0 si el píxel lo cruza).
+    for (i = 0; i < n; i++) {
+        x = ao + i * sf; ax = (x < 0 ? -x : x) - sf / 2.0; if (ax < 0) ax = 0
+        snx[i] = sin(ax); csx[i] = cos(ax)
+    }
+    c = H * H - req * req; ratio = (req * req) / (rpol * rpol)
+    printf " %s =\n", var
+    for (j = 0; j < n; j++) {
+        y = -ao - j * sf; ay = (y < 0 ? -y : y) - sf / 2.0; if (ay < 0) ay = 0
+        sny = sin(ay); csy = cos(ay); k = csy * csy + ratio * sny * sny
+        line = ""
+        for (i = 0; i < n; i++) {
+            a = snx[i] * snx[i] + csx[i] * csx[i] * k
+            b = -2.0 * H * csx[i] * csy
+            t = i * 7 + j * 13
+            if (b * b - 4.0 * a * c < 0) v = fv
+            else if (type == "byte") v = t % 6
+            else if (type == "float") v = sprintf("%.1f", 220 + (t % 1000) * 0.1)
+            else v = 180 + t % 3800 + (i * 3 * band + j * (band + 5)) % 160 - 80
+            line = line (i ? ", " : "  ") v
+        }
+        printf "%s%s\n", line, (j < n - 1 ? "," : " ;")
+    }
+    printf "}\n"
+}' > "$CDL"
+
+ncgen -k nc4 -o "$OUT" "$CDL"
+rm -f "$CDL"
+echo "$OUT"
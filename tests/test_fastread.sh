@@ -18,4 +18,112 @@ cmp fastread_fast.png fastread_slow.png
 HPSV_DISABLE_FAST_READ=1 ../bin/hpsv rgb "$C01" --mode truecolor -o fastread_tc_slow.png
 cmp fastread_tc_fast.png fastread_tc_slow.png
 
+# Índice de chunks desde el caché (HPSV_CHUNK_CACHE_DIR): la primera corrida
+# lo guarda, la segunda lo usa sin abrir el archivo con HDF5. Ambas deben dar
+# exactamente lo mismo que el fallback.
+CACHE_DIR=$(mktemp -d)
+HPSV_CHUNK_CACHE_DIR="$CACHE_DIR" ../bin/hpsv gray "$C13" -i -o fastread_cache1.png
+ls "$CACHE_DIR"/*.cix > /dev/null
+HPSV_CHUNK_CACHE_DIR="$CACHE_DIR" ../bin/hpsv gray "$C13" -i -o fastread_cache2.png
+cmp fastread_cache1.png fastread_slow.png
+cmp fastread_cache2.png fastread_slow.png
+rm -rf "$CACHE_DIR"
+
+# Clip en la malla nativa: solo se lee la ventana alrededor del recorte. El
+# resultado (PNG y GeoTIFF, que lleva el geotransform) debe ser el mismo que
+# leyendo el disco completo (HPSV_NO_CLIP_WINDOW=1).
+CLIP=-107.23,22.72,-93.84,14.94
+../bin/hpsv rgb "$C01" --mode truecolor -c $CLIP -o fastread_win_tc.png
+HPSV_NO_CLIP_WINDOW=1 ../bin/hpsv rgb "$C01" --mode truecolor -c $CLIP -o fastread_full_tc.png
+cmp fastread_win_tc.png fastread_full_tc.png
+../bin/hpsv gray "$C13" -i -c $CLIP --minmax "193.15,313.15" -o fastread_win_gray.tif
+HPSV_NO_CLIP_WINDOW=1 ../bin/hpsv gray "$C13" -i -c $CLIP --minmax "193.15,313.15" -o fastread_full_gray.tif
+cmp fastread_win_gray.tif fastread_full_gray.tif
+# batch con el mismo recorte en todos sus productos también lee por ventana.
+log=$(../bin/hpsv batch "$C01" truecolor night -c $CLIP -v -o "fastread_batch_{PROD}.png" 2>&1)
+echo "$log" | grep -q "Clip window"
+cmp fastread_batch_truecolor.png fastread_win_tc.png
+# La ventana y el recorte final salen de la proyección analítica; con
+# HPSV_NO_ANALYTIC_CLIP=1 se buscan en la navegación. $CLIP se sale del sector
+# CONUS por el sur y toma ya la ruta de búsqueda; este recorte cae completo dentro.
+CLIP2=-100,40,-80,25
+../bin/hpsv rgb "$C01" --mode truecolor -c $CLIP2 -o fastread_ana_tc.png
+HPSV_NO_ANALYTIC_CLIP=1 ../bin/hpsv rgb "$C01" --mode truecolor -c $CLIP2 -o fastread_nav_tc.png
+cmp fastread_ana_tc.png fastread_nav_tc.png
+../bin/hpsv gray "$C13" -i -c $CLIP2 --minmax "193.15,313.15" -o fastread_ana_gray.tif
+HPSV_NO_ANALYTIC_CLIP=1 ../bin/hpsv gray "$C13" -i -c $CLIP2 --minmax "193.15,313.15" -o fastread_nav_gray.tif
+cmp fastread_ana_gray.tif fastread_nav_gray.tif
+
+# Canales finos reducidos mientras se descomprimen (C02 a 0.5 km llega ya a la
+# resolución de C01/C03): igual que cargarlo completo y remuestrear después.
+../bin/hpsv rgb "$C01" --mode truecolor -o fastread_dec_tc.tif
+HPSV_NO_DECIMATED_LOAD=1 ../bin/hpsv rgb "$C01" --mode truecolor -o fastread_nodec_tc.tif
+cmp fastread_dec_tc.tif fastread_nodec_tc.tif
+
+# Tramos del disco (DiskSpans): los kernels solo recorren el disco terrestre y
+# llenan el resto de la fila con NonData, con tramos sacados de la geometría. El
+# CONUS de sample_data/ no tiene borde de espacio, así que se usa un disco
+# completo sintético (make_synthetic_nc.sh) con dato en todo píxel que ve la
+# Tierra: un tramo corto borra píxeles y la salida deja de ser igual a la de
+# HPSV_NO_DISK_SPANS=1. Se cubren la carga completa, C02 reducido mientras se
+# descomprime o después (downsample_boxfilter), la navegación y los ángulos
+# (Rayleigh), el álgebra de bandas, una receta y un recorte que cruza el limbo.
+FD=$(mktemp -d)
+for B in 1 3 11 13 14 15; do ./make_synthetic_nc.sh "$FD" $B 480 > /dev/null; done
+./make_synthetic_nc.sh "$FD" 2 960 > /dev/null
+FD01=$(ls "$FD"/*M6C01_*.nc)
+FD13=$(ls "$FD"/*M6C13_*.nc)
+spans_cmp() {
+    local out="$1"; shift
+    local log
+    log=$("$@" -v -o "fastread_spans_$out" 2>&1)
+    echo "$log" | grep -q "Disk spans from the geometry"
+    HPSV_NO_DISK_SPANS=1 "$@" -o "fastread_nospans_$out"
+    cmp "fastread_spans_$out" "fastread_nospans_$out"
+}
+spans_cmp gray.png ../bin/hpsv gray "$FD13" -i --minmax "180,380"
+spans_cmp expr.png ../bin/hpsv gray "$FD13" --expr "C13-C14" --minmax "-50,50"
+spans_cmp tc.png ../bin/hpsv rgb "$FD01" --mode truecolor --rayleigh
+spans_cmp tc_nodec.png env HPSV_NO_DECIMATED_LOAD=1 ../bin/hpsv rgb "$FD01" --mode truecolor --rayleigh
+spans_cmp ash.png ../bin/hpsv rgb "$FD13" --mode ash
+spans_cmp limb.tif ../bin/hpsv gray "$FD13" -i -c -160,40,-130,10 --minmax "180,380"
+
+# Recortes que leen el disco completo (histograma, CLAHE, --full-res): el
+# recuadro sale de la geometría, sin navegar la malla, y debe ser el mismo que
+# el de la búsqueda en la navegación (HPSV_NO_ANALYTIC_CLIP=1).
+clip_cmp() {
+    local out="$1"; shift
+    local log
+    log=$("$@" -v -o "fastread_geo_$out" 2>&1)
+    echo "$log" | grep -q "Clip box from the fixed-grid geometry"
+    ! echo "$log" | grep -q "Navigation ("
+    HPSV_NO_ANALYTIC_CLIP=1 "$@" -o "fastread_grid_$out"
+    cmp "fastread_geo_$out" "fastread_grid_$out"
+}
+clip_cmp gray_h.png ../bin/hpsv gray "$FD13" -c -100,40,-80,25 -h
+clip_cmp gray_clahe.png ../bin/hpsv gray "$FD13" -c -60,-10,-40,-30 --clahe
+clip_cmp tc_h.png ../bin/hpsv rgb "$FD01" --mode truecolor -c -120,60,-90,45 -h
+clip_cmp night_fr.png ../bin/hpsv rgb "$FD13" --mode night -c -80.3,5.1,-79.7,4.6 --full-res
+rm -rf "$FD"
+
+# Productos L2 de bytes (fase, máscaras) y de punto flotante pasan también por el
+# lector rápido. No vienen en sample_data/: se escriben sintéticos (Phase en byte,
+# LST en float32; 250 px en chunks de 84, así que los del borde quedan parciales).
+# El lector rápido debe tomarlos (-v lo reporta) y dar lo mismo que nc_get_var.
+L2DIR=$(mktemp -d)
+for KIND in ACTP LST; do
+    L2=$(./make_synthetic_nc.sh "$L2DIR" $KIND 250)
+    log=$(../bin/hpsv gray "$L2" -v -o fastread_l2_fast.tif 2>&1)
+    echo "$log" | grep -q "NetCDF chunked fetch"
+    HPSV_DISABLE_FAST_READ=1 ../bin/hpsv gray "$L2" -o fastread_l2_slow.tif
+    cmp fastread_l2_fast.tif fastread_l2_slow.tif
+    # Y una ventana (recorte) que empieza y termina a media chunk; el float la lee
+    # por ventana solo con el rango dado.
+    MM=(); [ $KIND = LST ] && MM=(--minmax "220,320")
+    ../bin/hpsv gray "$L2" "${MM[@]}" -c -100,40,-80,25 -o fastread_l2_win_fast.tif
+    HPSV_DISABLE_FAST_READ=1 ../bin/hpsv gray "$L2" "${MM[@]}" -c -100,40,-80,25 -o fastread_l2_win_slow.tif
+    cmp fastread_l2_win_fast.tif fastread_l2_win_slow.tif
+done
+rm -rf "$L2DIR"
+
 echo "OK: lector rápido (libdeflate) byte-idéntico al fallback nc_get_var."
@@ -44,3 +44,96 @@ if [ "$n_cog" -le 1 ]; then
     echo "FAIL: --cog GeoTIFF should embed overviews (pages=$n_cog)" >&2; exit 1
 fi
 echo "OK: default sin overviews (1 pág), --cog con overviews ($n_cog págs)"
+
+# Pirámide propia del --cog (promedio 2x2 en cascada) contra la que calcula el
+# driver COG (HPSV_NO_BOX_OVERVIEWS=1): mismos niveles y misma resolución base.
+HPSV_NO_BOX_OVERVIEWS=1 ../bin/hpsv gray -t --cog "$C13" -o geo_cog_gdal.tif
+n_cog_gdal=$(identify -format "%n\n" geo_cog_gdal.tif 2>/dev/null | head -1)
+if [ "$n_cog" -ne "$n_cog_gdal" ]; then
+    echo "FAIL: overview levels differ (box=$n_cog, GDAL=$n_cog_gdal)" >&2; exit 1
+fi
+./compare_image.sh geo_cog.tif geo_cog_gdal.tif 0
+# Primer overview (factor 2) contra el promedio 2x2 de la base hecho por GDAL
+# (-ovr NONE: sin que gdal_translate tome el overview ya escrito). El fuzz de
+# compare_image.sh absorbe el redondeo de ±1.
+gdal_translate -q -ovr 0 geo_cog.tif geo_cog_ovr1.tif
+gdal_translate -q -ovr NONE -r average -outsize 50% 50% geo_cog.tif geo_cog_ovr1_ref.tif
+./compare_image.sh geo_cog_ovr1.tif geo_cog_ovr1_ref.tif 0
+echo "OK: overviews en cascada con los mismos $n_cog_gdal niveles que GDAL"
+
+# Escritor nativo (tiles armados y comprimidos con libdeflate, GDAL solo para
+# las etiquetas) contra el camino MEM + COG de GDAL (HPSV_NO_NATIVE_TIFF=1):
+# mismos píxeles en gris, RGB e indexado, y la metadata sigue en el TIFF.
+C01=../sample_data/OR_ABI-L2-CMIPC-M6C01_G16_s20242201301171_e20242201303543_c20242201304004.nc
+HPSV_NO_NATIVE_TIFF=1 ../bin/hpsv gray -t "$C13" -o geo_gdal.tif
+./compare_image.sh geo_default.tif geo_gdal.tif 0
+../bin/hpsv rgb -t --mode truecolor "$C01" -o geo_native_tc.tif
+HPSV_NO_NATIVE_TIFF=1 ../bin/hpsv rgb -t --mode truecolor "$C01" -o geo_gdal_tc.tif
+./compare_image.sh geo_native_tc.tif geo_gdal_tc.tif 0
+HPSV_NO_NATIVE_TIFF=1 ../bin/hpsv pseudocolor -v -s -4 -t -p ../assets/phase.cpt "$C13" -o geo_gdal_pseudo.tif
+./compare_image.sh geo_pseudo_out.tif geo_gdal_pseudo.tif 0
+META=$(strings geo_default.tif)
+check_meta "product" "CMIP"
+check_meta "satellite" "G16"
+check_meta "band" "C13"
+META=$(strings geo_native_tc.tif)
+check_meta "satellite" "G16"
+echo "OK: escritor TIFF nativo idéntico al de GDAL"
+
+# Reproyección por franjas (HPSV_STREAM_REPROJ=1): el GeoTIFF geográfico se
+# escribe franja por franja en un archivo tileado, sin la imagen completa en
+# memoria. Mismos píxeles y metadata que el camino en memoria.
+../bin/hpsv gray -t -G "$C13" -o geo_mem.tif
+HPSV_STREAM_REPROJ=1 ../bin/hpsv gray -t -G "$C13" -o geo_stream.tif
+./compare_image.sh geo_stream.tif geo_mem.tif 0
+HPSV_STREAM_REPROJ=1 ../bin/hpsv pseudocolor -t -G -p ../assets/phase.cpt "$C13" -o geo_stream_pseudo.tif
+../bin/hpsv pseudocolor -t -G -p ../assets/phase.cpt "$C13" -o geo_mem_pseudo.tif
+./compare_image.sh geo_stream_pseudo.tif geo_mem_pseudo.tif 0
+META=$(strings geo_stream_pseudo.tif)
+check_meta "satellite" "G16"
+check_meta "colormap_size" "6"
+echo "OK: GeoTIFF geográfico por franjas idéntico al escrito en memoria"
+
+# --float: valores físicos en GeoTIFF Float32 (nativo y geográfico). Una banda
+# de punto flotante, con la metadata de siempre; la malla geográfica es la misma
+# que la del producto renderizado.
+../bin/hpsv gray --float "$C13" -o geo_float.tif
+../bin/hpsv gray --float -G "$C13" -o geo_float_geo.tif
+for f in geo_float.tif geo_float_geo.tif; do
+    if ! identify -verbose "${f}[0]" 2>/dev/null | grep -q "floating-point"; then
+        echo "FAIL: $f no es Float32" >&2; exit 1
+    fi
+done
+dim_float=$(identify -format "%wx%h\n" geo_float_geo.tif 2>/dev/null | head -1)
+dim_mem=$(identify -format "%wx%h\n" geo_mem.tif 2>/dev/null | head -1)
+if [ "$dim_float" != "$dim_mem" ]; then
+    echo "FAIL: malla Float32 $dim_float distinta de la renderizada $dim_mem" >&2; exit 1
+fi
+META=$(strings geo_float_geo.tif)
+check_meta "band" "C13"
+
+# Los valores son los físicos del NetCDF: un píxel de la malla nativa contra
+# CMI * scale + offset leído con GDAL, y el rango de la banda es de
+# temperaturas de brillo (K), no de bytes.
+cmi="NETCDF:\"$C13\":CMI"
+raw=$(gdallocationinfo -valonly "$cmi" 1250 750)
+read -r off scl < <(gdalinfo "$cmi" | sed -n 's/.*Offset: *\([^,]*\), *Scale: *\(.*\)/\1 \2/p' | head -1)
+val=$(gdallocationinfo -valonly geo_float.tif 1250 750)
+if ! awk -v r="$raw" -v o="$off" -v s="$scl" -v v="$val" \
+        'BEGIN { d = r * s + o - v; exit !(d < 1e-3 && d > -1e-3) }'; then
+    echo "FAIL: píxel (1250,750) = $val, NetCDF da $raw * $scl + $off" >&2; exit 1
+fi
+read -r vmin vmax < <(gdalinfo -mm geo_float.tif | sed -n 's/.*Computed Min\/Max=\([^,]*\),\(.*\)/\1 \2/p')
+if ! awk -v a="$vmin" -v b="$vmax" 'BEGIN { exit !(a > 150 && b > 255 && b < 350) }'; then
+    echo "FAIL: rango Float32 [$vmin, $vmax] no es de temperaturas de brillo" >&2; exit 1
+fi
+
+# NonData: declarado como nodata y escrito tal cual fuera del sector en la
+# malla geográfica (sin nodata declarado, el máximo es NonData).
+nodata=$(gdalinfo geo_float_geo.tif | sed -n 's/.*NoData Value=//p' | head -1)
+gdal_translate -q -a_nodata none geo_float_geo.tif geo_float_geo_raw.tif
+read -r gmax < <(gdalinfo -mm geo_float_geo_raw.tif | sed -n 's/.*Computed Min\/Max=[^,]*,//p')
+if ! awk -v n="$nodata" -v m="$gmax" 'BEGIN { exit !(n > 9.99e31 && n < 1.01e32 && m > 9.99e31 && m < 1.01e32) }'; then
+    echo "FAIL: nodata declarado '$nodata', máximo sin nodata '$gmax' (esperado NonData 1e32)" >&2; exit 1
+fi
+echo "OK: GeoTIFF Float32 de valores físicos"
@@ -23,3 +23,13 @@ set -e
 # ../bin/hpsv pseudocolor -v -p ../assets/phase.cpt ../sample_data/OR_ABI-L2-ACTPC-M6_G16_...nc
 
 
+
+# Encoder PNG paralelo (franjas filtradas y comprimidas en todos los núcleos)
+# contra libpng en un hilo (HPSV_NO_PARALLEL_PNG=1): los bytes del flujo zlib
+# difieren, los píxeles no. Cubre paleta con tRNS y gris con alfa.
+../bin/hpsv pseudocolor -s -4 -p ../assets/phase.cpt ../sample_data/OR_ABI-L2-CMIPC-M6C13_G16_s20242201301171_e20242201303555_c20242201304066.nc -o pseudo_par.png
+HPSV_NO_PARALLEL_PNG=1 ../bin/hpsv pseudocolor -s -4 -p ../assets/phase.cpt ../sample_data/OR_ABI-L2-CMIPC-M6C13_G16_s20242201301171_e20242201303555_c20242201304066.nc -o pseudo_libpng.png
+./compare_image.sh pseudo_par.png pseudo_libpng.png 0
+../bin/hpsv gray -a ../sample_data/OR_ABI-L2-CMIPC-M6C01_G16_s20242201301171_e20242201303543_c20242201304004.nc -o gray_alpha_par.png
+HPSV_NO_PARALLEL_PNG=1 ../bin/hpsv gray -a ../sample_data/OR_ABI-L2-CMIPC-M6C01_G16_s20242201301171_e20242201303543_c20242201304004.nc -o gray_alpha_libpng.png
+./compare_image.sh gray_alpha_par.png gray_alpha_libpng.png 0
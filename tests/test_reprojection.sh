@@ -26,3 +26,48 @@ check_corner_pixel gray_geo_alpha_out.png "graya(0,0)"
 ../bin/hpsv pseudocolor -v -s -4 -G -p ../assets/phase.cpt ../sample_data/OR_ABI-L2-CMIPC-M6C13_G16_s20242201301171_e20242201303555_c20242201304066.nc -o pseudo_geo_phase_out.png
 ./compare_image.sh pseudo_geo_phase_out.png expected_output/ref_pseudo_geo_phase.png
 check_corner_pixel pseudo_geo_phase_out.png "srgb(255,0,0)"
+
+# Caché de navegación (HPSV_NAV_CACHE_DIR): la primera corrida guarda las mallas
+# lat/lon, la segunda las mapea del archivo. Ambas deben dar lo mismo que sin
+# caché.
+NAV_DIR=$(mktemp -d)
+../bin/hpsv gray -s -4 -G ../sample_data/OR_ABI-L2-CMIPC-M6C01_G16_s20242201301171_e20242201303543_c20242201304004.nc -o navcache_none.png
+HPSV_NAV_CACHE_DIR="$NAV_DIR" ../bin/hpsv gray -s -4 -G ../sample_data/OR_ABI-L2-CMIPC-M6C01_G16_s20242201301171_e20242201303543_c20242201304004.nc -o navcache_1.png
+ls "$NAV_DIR"/*.nav > /dev/null
+HPSV_NAV_CACHE_DIR="$NAV_DIR" ../bin/hpsv gray -s -4 -G ../sample_data/OR_ABI-L2-CMIPC-M6C01_G16_s20242201301171_e20242201303543_c20242201304004.nc -o navcache_2.png
+cmp navcache_1.png navcache_none.png
+cmp navcache_2.png navcache_none.png
+rm -rf "$NAV_DIR"
+echo "OK: caché de navegación idéntica al cálculo directo"
+
+# Mapas de reproyección (HPSV_REPROJ_MAP_DIR): la primera corrida resuelve y
+# guarda el mapa, la segunda solo recoge. Gris (vecino más cercano) y truecolor
+# (bilineal) deben salir idénticos a la reproyección analítica.
+C01=../sample_data/OR_ABI-L2-CMIPC-M6C01_G16_s20242201301171_e20242201303543_c20242201304004.nc
+MAP_DIR=$(mktemp -d)
+for run in 1 2; do
+    HPSV_REPROJ_MAP_DIR="$MAP_DIR" ../bin/hpsv gray -s -4 -G "$C01" -o reprojmap_gray_$run.png
+    HPSV_REPROJ_MAP_DIR="$MAP_DIR" ../bin/hpsv rgb -G --mode truecolor "$C01" -o reprojmap_tc_$run.png
+done
+ls "$MAP_DIR"/*.rpm > /dev/null
+../bin/hpsv rgb -G --mode truecolor "$C01" -o reprojmap_tc_none.png
+cmp reprojmap_gray_1.png navcache_none.png
+cmp reprojmap_gray_2.png navcache_none.png
+cmp reprojmap_tc_1.png reprojmap_tc_none.png
+cmp reprojmap_tc_2.png reprojmap_tc_none.png
+rm -rf "$MAP_DIR"
+echo "OK: mapas de reproyección idénticos a la reproyección analítica"
+
+# Reproyección aproximada (HPSV_REPROJ_APPROX=0.125): la solución exacta solo en
+# una retícula de control adaptativa e interpolación entre sus nodos. No es
+# idéntica byte a byte, pero debe quedar dentro de la tolerancia de compare_image.
+HPSV_REPROJ_APPROX=0.125 ../bin/hpsv gray -s -4 -G "$C01" -o reprojapprox_gray.png
+HPSV_REPROJ_APPROX=0.125 ../bin/hpsv rgb -G --mode truecolor "$C01" -o reprojapprox_tc.png
+./compare_image.sh reprojapprox_gray.png navcache_none.png
+./compare_image.sh reprojapprox_tc.png reprojmap_tc_none.png
+echo "OK: reproyección aproximada dentro de tolerancia"
+
+# Recorrido por mosaicos en orden de Morton: mismos píxeles que fila por fila.
+HPSV_NO_TILED_REPROJ=1 ../bin/hpsv rgb -G --mode truecolor "$C01" -o reprojrows_tc.png
+cmp reprojrows_tc.png reprojmap_tc_none.png
+echo "OK: recorrido por mosaicos idéntico al recorrido por filas"
@@ -21,19 +21,64 @@ check_nonblank() {
 # Rayleigh LUTs
 ../bin/hpsv rgb -m truecolor --rayleigh -g 2 -s -4 -v ../sample_data/OR_ABI-L2-CMIPC-M6C01_G16_s20242201301171_e20242201303543_c20242201304004.nc -o "truecolor_ray_luts.png"
 check_nonblank truecolor_ray_luts.png
+# Una pasada por banda debe dar los mismos píxeles que la pasada compartida.
+HPSV_NO_SHARED_RAYLEIGH=1 ../bin/hpsv rgb -m truecolor --rayleigh -g 2 -s -4 -v ../sample_data/OR_ABI-L2-CMIPC-M6C01_G16_s20242201301171_e20242201303543_c20242201304004.nc -o "truecolor_ray_luts_perband.png"
+./compare_image.sh truecolor_ray_luts_perband.png truecolor_ray_luts.png 0
+# La geometría en tres pasadas (con mallas SAA/VAA) da los mismos ángulos que la fusionada.
+HPSV_NO_FUSED_GEOMETRY=1 ../bin/hpsv rgb -m truecolor --rayleigh -g 2 -s -4 -v ../sample_data/OR_ABI-L2-CMIPC-M6C01_G16_s20242201301171_e20242201303543_c20242201304004.nc -o "truecolor_ray_threepass.png"
+./compare_image.sh truecolor_ray_threepass.png truecolor_ray_luts.png 0
+# La geometría en retícula gruesa interpola ángulos suaves: casi los mismos píxeles.
+HPSV_COARSE_GEOMETRY=8 ../bin/hpsv rgb -m truecolor --rayleigh -g 2 -s -4 -v ../sample_data/OR_ABI-L2-CMIPC-M6C01_G16_s20242201301171_e20242201303543_c20242201304004.nc -o "truecolor_ray_coarse.png"
+./compare_image.sh truecolor_ray_coarse.png truecolor_ray_luts.png
+# La navegación con atan2 de libm, píxel por píxel, da las mismas mallas que la vectorizada
+# salvo un ulp de float donde hpsv_atan2 (a 2 ulp de glibc) cae junto a un redondeo: a lo
+# más unos píxeles sueltos, de ahí la tolerancia de 0.01%.
+HPSV_NO_SIMD_NAV=1 ../bin/hpsv rgb -m truecolor --rayleigh -g 2 -s -4 -v ../sample_data/OR_ABI-L2-CMIPC-M6C01_G16_s20242201301171_e20242201303543_c20242201304004.nc -o "truecolor_ray_libmnav.png"
+./compare_image.sh truecolor_ray_libmnav.png truecolor_ray_luts.png 0.01
 
 # Rayleigh Analytic
 ../bin/hpsv rgb -m truecolor --ray-analytic -g 2 -s -4 -v ../sample_data/OR_ABI-L2-CMIPC-M6C01_G16_s20242201301171_e20242201303543_c20242201304004.nc -o "truecolor_ray_analytic.png"
 check_nonblank truecolor_ray_analytic.png
 
 # Otros modos: solo sanity-check (corren y producen una imagen con contenido
-# real), sin referencia exacta. airmass/severestorm/so2 no se cubren aquí
-# porque requieren canales (C05/C07-C10/C12) que no están en sample_data/.
+# real), sin referencia exacta. airmass/severestorm/so2 requieren canales
+# (C05/C07-C10/C12) que no están en sample_data/; las recetas se comparan más
+# abajo sobre un disco completo sintético.
 ../bin/hpsv rgb -m night -s -4 -v ../sample_data/OR_ABI-L2-CMIPC-M6C13_G16_s20242201301171_e20242201303555_c20242201304066.nc -o "night_out.png"
 check_nonblank night_out.png
 
 ../bin/hpsv rgb -m ash -s -4 -v ../sample_data/OR_ABI-L2-CMIPC-M6C13_G16_s20242201301171_e20242201303555_c20242201304066.nc -o "ash_out.png"
 check_nonblank ash_out.png
+# La receta de ash escrita como expresión custom debe dar los mismos bytes.
+../bin/hpsv rgb -m custom --expr "C15-C13; C14-C11; C13" --minmax "-6.7,2.6; -6.0,6.3; 243.6,302.4" -s -4 -v ../sample_data/OR_ABI-L2-CMIPC-M6C13_G16_s20242201301171_e20242201303555_c20242201304066.nc -o "ash_custom.png"
+./compare_image.sh ash_custom.png ash_out.png 0
+
+# Recetas (ash, airmass, so2, severestorm) contra referencias generadas por el
+# binario anterior a las tablas RgbRecipe (compose_* con dataf_op_dataf y
+# create_multiband_rgb), sobre un disco completo sintético con todas sus bandas
+# (make_synthetic_nc.sh: 240 px las de 2 km, C05 a 480, C02 a 960). Deben salir
+# idénticas.
+SYN=$(mktemp -d)
+for B in 7 8 9 10 11 12 13 14 15; do ./make_synthetic_nc.sh "$SYN" $B 240 > /dev/null; done
+./make_synthetic_nc.sh "$SYN" 5 480 > /dev/null
+./make_synthetic_nc.sh "$SYN" 2 960 > /dev/null
+for MODE in ash airmass so2 severestorm; do
+    ../bin/hpsv rgb -m $MODE "$(ls "$SYN"/*M6C13_*.nc)" -o "${MODE}_fulldisk.png"
+    ./compare_image.sh "${MODE}_fulldisk.png" "expected_output/ref_${MODE}_fulldisk.png" 0
+done
+rm -rf "$SYN"
 
 ../bin/hpsv rgb -m daynite -s -4 -v ../sample_data/OR_ABI-L2-CMIPC-M6C01_G16_s20242201301171_e20242201303543_c20242201304004.nc -o "daynite_out.png"
 check_nonblank daynite_out.png
+
+# batch: una sola carga para varios productos; cada uno debe salir igual que su
+# corrida por separado (todos van a 2 km, como las corridas de arriba). daynite
+# corrige C03 en una copia: ash y night lo leen después de la misma escena.
+../bin/hpsv batch ../sample_data/OR_ABI-L2-CMIPC-M6C01_G16_s20242201301171_e20242201303543_c20242201304004.nc daynite ash night -s -4 -v -o "batch_{PROD}.png"
+./compare_image.sh batch_daynite.png daynite_out.png 0
+./compare_image.sh batch_ash.png ash_out.png 0
+./compare_image.sh batch_night.png night_out.png 0
+# Con modos IR, truecolor sigue en su malla de 1 km (otra carga), no en la de 2 km.
+../bin/hpsv batch ../sample_data/OR_ABI-L2-CMIPC-M6C01_G16_s20242201301171_e20242201303543_c20242201304004.nc truecolor night -g 2 -s -4 -v -o "batch_tc_{PROD}.png"
+./compare_image.sh batch_tc_truecolor.png truecolor_reference.png 0
+check_nonblank batch_tc_night.png